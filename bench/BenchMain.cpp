@@ -0,0 +1,867 @@
+// Microbenchmarks for engine code that runs without a window or GL context.
+// Build the AIHauntedHouseBench target and run it from the repository root; the options
+// are in USAGE below (--help prints them).
+
+#include "Camera.h"
+#include "Config.h"
+#include "FlowField.h"
+#include "Ghost.h"
+#include "GhostSystem.h"
+#include "HierarchicalPathfinder.h"
+#include "JobSystem.h"
+#include "KeyStates.h"
+#include "Maze.h"
+#include "MazeGenerator.h"
+#include "MazePVS.h"
+#include "Pathfinder.h"
+#include "SpatialGrid.h"
+#include "TextureNames.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char* const USAGE =
+        "Usage: AIHauntedHouseBench [options]\n"
+        "  --repetitions <n>     Timed repetitions per benchmark (default 5); stats are over these\n"
+        "  --json <file>         Write every result as JSON\n"
+        "  --baseline <file>     Compare medians against a JSON file from an earlier run and exit\n"
+        "                        with status 1 if any benchmark got slower than the threshold\n"
+        "  --threshold <percent> Allowed slowdown against the baseline (default 10)\n"
+        "  --help                Print this and exit\n";
+
+    struct BenchResult {
+        std::string name;
+        int iterations;              // Calls per repetition
+        std::vector<double> samples; // Mean ms per call in each repetition
+        double minMs, medianMs, meanMs, stddevMs;
+    };
+
+    int repetitions = 5;
+    std::vector<BenchResult> results;
+    std::string resultGroup; // Prefix that keeps repeated benchmark names apart in the results
+
+    // Name without the blank lines and indentation used to group the console output
+    std::string resultName(const char* name) {
+        while (*name == '\n' || *name == ' ') ++name;
+        return resultGroup.empty() ? std::string(name) : resultGroup + " / " + name;
+    }
+
+    // Run fn once to warm up, then `repetitions` rounds of `iterations` calls. Prints the
+    // median time per call and the spread between rounds, and keeps the result for JSON.
+    template <typename Fn>
+    const BenchResult& runBenchmark(const char* name, int iterations, Fn&& fn) {
+        fn();
+        BenchResult result{ resultName(name), iterations, {}, 0.0, 0.0, 0.0, 0.0 };
+        for (int round = 0; round < repetitions; ++round) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                fn();
+            }
+            const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            result.samples.push_back(totalMs / iterations);
+        }
+
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t count = sorted.size();
+        result.minMs = sorted.front();
+        result.medianMs = count % 2 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+        double sum = 0.0;
+        for (double sample : sorted) sum += sample;
+        result.meanMs = sum / count;
+        double squares = 0.0;
+        for (double sample : sorted) squares += (sample - result.meanMs) * (sample - result.meanMs);
+        result.stddevMs = count > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+
+        std::printf("%-48s %12.4f ms/iter  +-%5.1f%%  (%d x %d)\n", name, result.medianMs,
+                    result.meanMs > 0.0 ? 100.0 * result.stddevMs / result.meanMs : 0.0, repetitions, iterations);
+        results.push_back(result);
+        return results.back();
+    }
+
+    std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    bool writeJson(const std::string& path, unsigned hardwareThreads) {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "{\n  \"hardware_threads\": " << hardwareThreads << ",\n"
+            << "  \"ghost_system_vectorized\": " << (GhostSystem::isVectorized() ? "true" : "false") << ",\n"
+            << "  \"repetitions\": " << repetitions << ",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& result = results[i];
+            out << "    { \"name\": \"" << jsonEscape(result.name) << "\", \"iterations\": " << result.iterations
+                << ", \"median_ms\": " << result.medianMs << ", \"mean_ms\": " << result.meanMs
+                << ", \"min_ms\": " << result.minMs << ", \"stddev_ms\": " << result.stddevMs << ", \"samples_ms\": [";
+            for (size_t k = 0; k < result.samples.size(); ++k) {
+                out << (k ? ", " : "") << result.samples[k];
+            }
+            out << "] }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    struct BaselineEntry {
+        std::string name;
+        double medianMs, minMs;
+    };
+
+    // Name, median and minimum of every benchmark in a file written by writeJson. Only reads
+    // that layout, not JSON in general.
+    bool readBaseline(const std::string& path, std::vector<BaselineEntry>& entries) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+
+        const std::string nameKey = "\"name\": \"", medianKey = "\"median_ms\": ", minKey = "\"min_ms\": ";
+        for (size_t at = text.find(nameKey); at != std::string::npos; at = text.find(nameKey, at)) {
+            std::string name;
+            size_t i = at + nameKey.size();
+            for (; i < text.size() && text[i] != '"'; ++i) {
+                if (text[i] == '\\' && i + 1 < text.size()) ++i;
+                name += text[i];
+            }
+            const size_t median = text.find(medianKey, i);
+            const size_t minimum = text.find(minKey, i);
+            if (median == std::string::npos || minimum == std::string::npos) break;
+            entries.push_back(BaselineEntry{ name, std::strtod(text.c_str() + median + medianKey.size(), nullptr),
+                                             std::strtod(text.c_str() + minimum + minKey.size(), nullptr) });
+            at = std::max(median, minimum);
+        }
+        return true;
+    }
+
+    // Print how every benchmark moved against the baseline; returns the number of regressions.
+    // A regression needs both the median and the fastest repetition to be slower by more than
+    // the threshold, so one noisy repetition does not fail a run.
+    int compareWithBaseline(const std::string& path, double thresholdPercent) {
+        std::vector<BaselineEntry> baseline;
+        if (!readBaseline(path, baseline)) {
+            std::printf("\nCould not read baseline %s\n", path.c_str());
+            return 1;
+        }
+        std::printf("\nAgainst baseline %s (threshold %.1f%%)\n", path.c_str(), thresholdPercent);
+        int regressions = 0, compared = 0;
+        for (const BenchResult& result : results) {
+            const auto match = std::find_if(baseline.begin(), baseline.end(),
+                                            [&](const BaselineEntry& entry) { return entry.name == result.name; });
+            if (match == baseline.end() || match->medianMs <= 0.0 || match->minMs <= 0.0) continue;
+            ++compared;
+            const double change = 100.0 * (result.medianMs / match->medianMs - 1.0);
+            const double minChange = 100.0 * (result.minMs / match->minMs - 1.0);
+            const bool slower = change > thresholdPercent && minChange > thresholdPercent;
+            regressions += slower ? 1 : 0;
+            if (slower || (change < -thresholdPercent && minChange < -thresholdPercent)) {
+                std::printf("  %-56s %10.4f -> %10.4f ms  %+7.1f%%  %s\n", result.name.c_str(), match->medianMs,
+                            result.medianMs, change, slower ? "REGRESSION" : "faster");
+            }
+        }
+        std::printf("  %d compared, %d regressed, %zu not in the baseline\n", compared, regressions,
+                    results.size() - static_cast<size_t>(compared));
+        return regressions;
+    }
+
+    // The previous Maze storage: one char per cell, row-major, bounds-checked per query
+    class ByteGridMaze {
+    public:
+        explicit ByteGridMaze(const Maze& maze) : width(maze.getWidth()), height(maze.getHeight()),
+                                                  layout(static_cast<size_t>(width) * height) {
+            for (int r = 0; r < height; ++r) {
+                for (int c = 0; c < width; ++c) {
+                    layout[static_cast<size_t>(r) * width + c] = maze.getCell(r, c);
+                }
+            }
+        }
+
+        bool isWall(int row, int col) const {
+            if (row >= 0 && row < height && col >= 0 && col < width) {
+                return layout[static_cast<size_t>(row) * width + col] == 'W';
+            }
+            return false;
+        }
+
+        size_t getMemoryBytes() const { return layout.size(); }
+
+    private:
+        int width, height;
+        std::vector<char> layout;
+    };
+
+    std::uint32_t nextRandom(std::uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Random walls (about a third of the cells) with a solid border, and open start, exit and
+    // key cells so the maze can be saved and loaded like a real level
+    Maze makeRandomMaze(int width, int height, std::uint32_t seed) {
+        Maze maze(width, height, false);
+        for (int r = 0; r < height; ++r) {
+            for (int c = 0; c < width; ++c) {
+                const bool border = r == 0 || c == 0 || r == height - 1 || c == width - 1;
+                maze.setWall(r, c, border || nextRandom(seed) % 3 == 0);
+            }
+        }
+        if (width >= 3 && height >= 3) {
+            maze.setStartPosition(1, 1);
+            maze.setEndPosition(height - 2, width - 2);
+            maze.setKeyPosition(height / 2, width / 2);
+            maze.setWall(1, 1, false);
+            maze.setWall(height - 2, width - 2, false);
+            maze.setWall(height / 2, width / 2, false);
+        }
+        return maze;
+    }
+
+    // Random and row-major isWall queries against both layouts of one maze
+    void benchmarkGridQueries(const char* label, const Maze& maze) {
+        const ByteGridMaze byteGrid(maze);
+        std::printf("\n%s: %dx%d, bit tiles %zu KB, byte grid %zu KB\n", label, maze.getWidth(), maze.getHeight(),
+                    maze.getMemoryBytes() / 1024, byteGrid.getMemoryBytes() / 1024);
+
+        // Neighbourhood lookups around random cells, the pattern of movement and line-of-sight code
+        const int queryCount = 1 << 20;
+        std::vector<std::pair<int, int>> cells(queryCount);
+        std::uint32_t seed = 12345;
+        for (auto& cell : cells) {
+            cell.first = static_cast<int>(nextRandom(seed) % maze.getHeight());
+            cell.second = static_cast<int>(nextRandom(seed) % maze.getWidth());
+        }
+
+        volatile int sink = 0;
+        auto randomQueries = [&](const auto& grid) {
+            int walls = 0;
+            for (const auto& [r, c] : cells) {
+                walls += grid.isWall(r, c) + grid.isWall(r - 1, c) + grid.isWall(r + 1, c) +
+                         grid.isWall(r, c - 1) + grid.isWall(r, c + 1);
+            }
+            sink = sink + walls;
+        };
+        auto scanQueries = [&](const auto& grid) {
+            int walls = 0;
+            for (int r = 0; r < maze.getHeight(); ++r) {
+                for (int c = 0; c < maze.getWidth(); ++c) {
+                    walls += grid.isWall(r, c);
+                }
+            }
+            sink = sink + walls;
+        };
+
+        const long long cellCount = static_cast<long long>(maze.getWidth()) * maze.getHeight();
+        const int scanIterations = static_cast<int>(std::max(1LL, 50'000'000LL / cellCount));
+        resultGroup = label;
+        runBenchmark("  Maze::isWall 5M random neighbourhood", 10, [&]() { randomQueries(maze); });
+        runBenchmark("  byte grid isWall 5M random neighbourhood", 10, [&]() { randomQueries(byteGrid); });
+        runBenchmark("  Maze::getCell 1M random", 10, [&]() {
+            int walls = 0;
+            for (const auto& [r, c] : cells) {
+                walls += maze.getCell(r, c) == 'W';
+            }
+            sink = sink + walls;
+        });
+        runBenchmark("  Maze::isWall full scan", scanIterations, [&]() { scanQueries(maze); });
+        runBenchmark("  byte grid isWall full scan", scanIterations, [&]() { scanQueries(byteGrid); });
+        resultGroup.clear();
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string jsonPath, baselinePath;
+    double thresholdPercent = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repetitions" && i + 1 < argc) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            thresholdPercent = std::atof(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            std::fputs(USAGE, stdout);
+            return 0;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n%s", arg.c_str(), USAGE);
+            return 2;
+        }
+    }
+
+    const unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("Hardware threads: %u, %d repetitions per benchmark\n\n", hardwareThreads, repetitions);
+
+    // --- MazePVS precompute ---
+    Maze maze;
+    runBenchmark("MazePVS::build default maze, 1 thread", 50, [&]() {
+        MazePVS pvs;
+        pvs.build(maze, 16.0f, 1);
+    });
+    runBenchmark("MazePVS::build default maze, all threads", 50, [&]() {
+        MazePVS pvs;
+        pvs.build(maze, 16.0f, hardwareThreads);
+    });
+    const Maze randomPvsMaze = makeRandomMaze(64, 64, 99);
+    runBenchmark("MazePVS::build 64x64 random maze, all threads", 3, [&]() {
+        MazePVS pvs;
+        pvs.build(randomPvsMaze, 16.0f, hardwareThreads);
+    });
+    // The PVS must never hide a cell that some point of the source cell can see
+    for (const Maze* pvsMaze : { static_cast<const Maze*>(&maze), &randomPvsMaze }) {
+        MazePVS pvs;
+        pvs.build(*pvsMaze, 16.0f, hardwareThreads);
+        std::uint32_t seed = 4242;
+        int clear = 0, misses = 0;
+        for (int i = 0; i < 200000; ++i) {
+            const float fromX = static_cast<float>(nextRandom(seed) % (pvsMaze->getWidth() * 100)) / 100.0f;
+            const float fromZ = static_cast<float>(nextRandom(seed) % (pvsMaze->getHeight() * 100)) / 100.0f;
+            const float toX = fromX + static_cast<float>(static_cast<int>(nextRandom(seed) % 3200) - 1600) / 100.0f;
+            const float toZ = fromZ + static_cast<float>(static_cast<int>(nextRandom(seed) % 3200) - 1600) / 100.0f;
+            const int fromRow = static_cast<int>(fromZ), fromCol = static_cast<int>(fromX);
+            if (!pvs.hasCell(fromRow, fromCol) || toX < 0.0f || toZ < 0.0f ||
+                toX >= pvsMaze->getWidth() || toZ >= pvsMaze->getHeight()) continue;
+            if (!pvsMaze->hasLineOfSight(fromX, fromZ, toX, toZ)) continue;
+            ++clear;
+            misses += pvs.isVisible(fromRow, fromCol, static_cast<int>(toZ), static_cast<int>(toX)) ? 0 : 1;
+        }
+        std::printf("  MazePVS vs Maze::hasLineOfSight, %s: %d clear sight lines, %d hidden by the PVS\n",
+                    pvsMaze == &maze ? "default maze" : "64x64 random maze", clear, misses);
+    }
+
+    // --- Maze grid queries: bit-packed tiles vs. one byte per cell ---
+    benchmarkGridQueries("Default maze", maze);
+    benchmarkGridQueries("Random 1024x1024", makeRandomMaze(1024, 1024, 7));
+    benchmarkGridQueries("Random 8192x8192", makeRandomMaze(8192, 8192, 7));
+
+    // --- Procedural generation throughput and determinism ---
+    std::printf("\n");
+    std::vector<unsigned> generatorThreads = { 1u };
+    if (hardwareThreads > 1) generatorThreads.push_back(hardwareThreads);
+    for (int size : { 1024, 4096, 8192 }) {
+        for (unsigned threads : generatorThreads) {
+            MazeGenerator generator;
+            generator.setBraid(0.2f);
+            generator.setRooms(2, 5);
+            const int iterations = size <= 1024 ? 20 : 3;
+            std::uint64_t seed = 1234;
+            char name[96];
+            std::snprintf(name, sizeof(name), "MazeGenerator %dx%d, %u thread(s)", size, size, threads);
+            const BenchResult& result = runBenchmark(name, iterations, [&]() {
+                generator.generate(size, size, seed++, threads);
+            });
+            std::printf("  %.1f Mcells/s\n", static_cast<double>(size) * size / (result.medianMs / 1000.0) / 1e6);
+        }
+    }
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.2f);
+        const Maze single = generator.generate(2049, 1537, 77, 1);
+        const unsigned threadCount = std::max(4u, hardwareThreads); // Oversubscribe so regions interleave
+        const Maze threaded = generator.generate(2049, 1537, 77, threadCount);
+        bool identical = true;
+        for (int r = 0; r < single.getHeight() && identical; ++r) {
+            for (int c = 0; c < single.getWidth(); ++c) {
+                if (single.isWall(r, c) != threaded.isWall(r, c)) {
+                    identical = false;
+                    break;
+                }
+            }
+        }
+        std::printf("MazeGenerator same seed, 1 vs %u threads: %s\n", threadCount, identical ? "identical" : "DIFFERENT");
+    }
+
+    // --- Flow field toward the player: rebuild per cell change, O(1) per follower step ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.2f);
+        generator.setRooms(2, 5);
+        const Maze chaseMaze = generator.generate(4097, 4097, 5);
+        std::vector<std::pair<int, int>> playerPath;
+        for (int c = 1; c < 4096 && playerPath.size() < 512; ++c) {
+            if (!chaseMaze.isWall(2049, c)) playerPath.emplace_back(2049, c);
+        }
+        FlowField field;
+        size_t step = 0;
+        runBenchmark("\nFlowField::update, player changed cell", static_cast<int>(playerPath.size()) - 1, [&]() {
+            const auto& cell = playerPath[step++ % playerPath.size()];
+            field.update(chaseMaze, cell.first, cell.second);
+        });
+        std::printf("  radius %d, %d cells reached on the last build\n", field.getRadius(), field.getReachedCells());
+        runBenchmark("FlowField::update, same cell (no rebuild)", 100000, [&]() {
+            field.update(chaseMaze, field.getRootRow(), field.getRootCol());
+        });
+
+        // 64k followers scattered around the player, each taking one step
+        std::vector<std::pair<int, int>> followers;
+        std::uint32_t seed = 4242;
+        while (followers.size() < 65536) {
+            const int r = field.getRootRow() + static_cast<int>(nextRandom(seed) % 129) - 64;
+            const int c = field.getRootCol() + static_cast<int>(nextRandom(seed) % 129) - 64;
+            if (field.getDistance(r, c) > 0) followers.emplace_back(r, c);
+        }
+        volatile int sink = 0;
+        runBenchmark("FlowField::getStep, 64k followers", 100, [&]() {
+            int sum = 0;
+            for (const auto& [r, c] : followers) {
+                int nextRow, nextCol;
+                if (field.getStep(r, c, nextRow, nextCol)) sum += nextRow + nextCol;
+            }
+            sink = sink + sum;
+        });
+    }
+
+    // --- Pathfinder: synchronous JPS queries and the time-sliced request queue ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.3f);
+        generator.setRooms(2, 5);
+        const Maze routeMaze = generator.generate(1025, 1025, 11);
+        std::vector<PathCell> queries;
+        std::uint32_t seed = 777;
+        while (queries.size() < 512) {
+            // Odd coordinates are always open cells in generated mazes
+            queries.push_back(PathCell{ 2 * static_cast<int>(nextRandom(seed) % 512) + 1,
+                                        2 * static_cast<int>(nextRandom(seed) % 512) + 1 });
+        }
+        const int pairCount = static_cast<int>(queries.size()) / 2;
+
+        Pathfinder pathfinder(routeMaze, 1 << 20);
+        std::vector<PathCell> path;
+        size_t totalLength = 0;
+        size_t found = 0;
+        int pair = 0;
+        runBenchmark("\nPathfinder::findPath 1025x1025 random pairs", pairCount, [&]() {
+            const PathCell& from = queries[2 * (pair % pairCount)];
+            const PathCell& to = queries[2 * (pair % pairCount) + 1];
+            ++pair;
+            if (pathfinder.findPath(from.row, from.col, to.row, to.col, path)) {
+                totalLength += path.size();
+                ++found;
+            }
+        });
+        std::printf("  %zu/%d found, mean length %.0f cells, %.0f jump points expanded per search\n", found, pair,
+                    found ? static_cast<double>(totalLength) / found : 0.0,
+                    static_cast<double>(pathfinder.getExpandedNodes()) / static_cast<double>(pathfinder.getSearchCount()));
+
+        // 64 nearby requests per "frame", 0.5 ms budget each frame
+        Pathfinder sliced(routeMaze);
+        std::vector<Pathfinder::Ticket> tickets;
+        int frames = 0, framesOverBudget = 0;
+        double worstFrameMs = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int batch = 0; batch < 4; ++batch) {
+            for (int i = 0; i < 64; ++i) {
+                // Every eighth request repeats an earlier one to exercise the cache
+                const int query = (i % 8 == 7) ? batch * 64 + i - 7 : batch * 64 + i;
+                const PathCell& from = queries[query % queries.size()];
+                tickets.push_back(sliced.requestPath(from.row, from.col,
+                                                     std::min(from.row + 64, 1023), std::min(from.col + 64, 1023)));
+            }
+            while (sliced.getPendingCount() > 0) {
+                const auto frameStart = std::chrono::steady_clock::now();
+                sliced.update(0.5);
+                const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+                worstFrameMs = std::max(worstFrameMs, frameMs);
+                framesOverBudget += frameMs > 0.6 ? 1 : 0;
+                ++frames;
+            }
+        }
+        const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("Pathfinder time-sliced at 0.5 ms/frame: %zu requests over %d frames (%.2f ms total)\n"
+                    "  worst frame %.3f ms, %d frames over 0.6 ms, %llu cache hits\n",
+                    tickets.size(), frames, totalMs, worstFrameMs, framesOverBudget,
+                    static_cast<unsigned long long>(sliced.getCacheHits()));
+    }
+
+    // --- Ghost swarm: 10k ghosts as Ghost objects against the batched GhostSystem ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.3f);
+        generator.setRooms(2, 5);
+        const Maze swarmMaze = generator.generate(513, 513, 5);
+        const float playerX = 256.5f, playerZ = 256.5f; // Odd cells are always open
+        FlowField field;
+        field.update(swarmMaze, static_cast<int>(playerZ), static_cast<int>(playerX));
+        const int ghostCount = 10000;
+        const float frameSeconds = 1.0f / 60.0f;
+
+        // Ghost logs on appearance and expiry; keep that out of the output, not the timing
+        std::cout.setstate(std::ios::failbit);
+        Pathfinder pathfinder(swarmMaze);
+        std::vector<std::unique_ptr<Ghost>> ghosts;
+        for (int i = 0; i < ghostCount; ++i) {
+            ghosts.emplace_back(new Ghost(swarmMaze, pathfinder));
+            ghosts.back()->appearRandomly();
+        }
+        runBenchmark("\nGhost::update x10000 (one object each)", 60, [&]() {
+            for (auto& ghost : ghosts) ghost->update(frameSeconds, playerX, playerZ, field);
+        });
+        std::cout.clear();
+
+        GhostSystem swarm(swarmMaze, 5);
+        swarm.resize(ghostCount);
+        swarm.appearRandomly(ghostCount);
+        char name[96];
+        std::snprintf(name, sizeof(name), "GhostSystem::update x10000 (%s)", GhostSystem::isVectorized() ? "SSE2" : "scalar");
+        runBenchmark(name, 60, [&]() {
+            swarm.update(frameSeconds, playerX, playerZ, field);
+        });
+
+        // Facing angles come from a polynomial atan2; compare against the library one
+        float worstDegrees = 0.0f;
+        for (int i = 0; i < swarm.getCount(); ++i) {
+            const float exact = std::atan2(playerX - swarm.getX(i), playerZ - swarm.getZ(i)) * 180.0f / 3.14159265f;
+            worstDegrees = std::max(worstDegrees, std::fabs(exact - swarm.getAngle(i)));
+        }
+        std::printf("  %d/%d visible, worst facing error %.4f degrees\n", swarm.getVisibleCount(), swarm.getCount(),
+                    worstDegrees);
+
+        // Scaling with worker count: a 100k swarm, and 32 independent flow field builds
+        std::printf("\nJobSystem scaling (%u hardware threads)\n", std::thread::hardware_concurrency());
+        GhostSystem bigSwarm(swarmMaze, 6);
+        bigSwarm.resize(100000);
+        std::vector<FlowField> fields(32);
+        for (unsigned workers : { 0u, 1u, 3u, 7u }) {
+            JobSystem jobs(workers);
+            // Workers == 0 means "auto" to the constructor; the first row wants none at all
+            if (workers == 0 && jobs.getThreadCount() > 1) continue;
+            bigSwarm.appearRandomly(bigSwarm.getCount());
+            std::snprintf(name, sizeof(name), "  GhostSystem::update x100000, %u threads", jobs.getThreadCount());
+            runBenchmark(name, 30, [&]() {
+                bigSwarm.update(frameSeconds, playerX, playerZ, field, jobs);
+            });
+            int round = 0;
+            std::snprintf(name, sizeof(name), "  32 FlowField builds, %u threads", jobs.getThreadCount());
+            runBenchmark(name, 5, [&]() {
+                ++round;
+                jobs.parallelFor(0, static_cast<int>(fields.size()), 1, [&](int begin, int end) {
+                    for (int i = begin; i < end; ++i) {
+                        fields[i].update(swarmMaze, 2 * ((i * 37 + round) % 256) + 1, 2 * ((i * 11 + round) % 256) + 1);
+                    }
+                });
+            });
+        }
+    }
+
+    // --- Line of sight: 4096 rays of up to 16 cells, one at a time against the batched walk ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.3f);
+        generator.setRooms(2, 5);
+        Maze hall(1025, 1025, false); // Open floor with scattered pillars: long, mostly clear rays
+        std::uint32_t seed = 31;
+        for (int r = 0; r < 1025; ++r) {
+            for (int c = 0; c < 1025; ++c) {
+                if (nextRandom(seed) % 64 == 0) hall.setWall(r, c, true);
+            }
+        }
+        const Maze corridors = generator.generate(1025, 1025, 8);
+
+        const int rayCount = 4096;
+        std::vector<float> fromX(rayCount), fromZ(rayCount), toX(rayCount), toZ(rayCount);
+        for (int i = 0; i < rayCount; ++i) {
+            // Odd cells are open in the generated maze
+            fromX[i] = 2.0f * static_cast<float>(nextRandom(seed) % 500 + 8) + 1.5f;
+            fromZ[i] = 2.0f * static_cast<float>(nextRandom(seed) % 500 + 8) + 1.5f;
+            toX[i] = fromX[i] + static_cast<float>(static_cast<int>(nextRandom(seed) % 3200) - 1600) / 100.0f;
+            toZ[i] = fromZ[i] + static_cast<float>(static_cast<int>(nextRandom(seed) % 3200) - 1600) / 100.0f;
+        }
+        std::vector<std::uint64_t> single((rayCount + 63) / 64), batched((rayCount + 63) / 64);
+        for (const Maze* sightMaze : { static_cast<const Maze*>(&hall), &corridors }) {
+            const char* label = sightMaze == &hall ? "hall" : "corridors";
+            char name[96];
+            std::snprintf(name, sizeof(name), "\nMaze::hasLineOfSight x4096, %s", label);
+            runBenchmark(name, 50, [&]() {
+                std::fill(single.begin(), single.end(), std::uint64_t(0));
+                for (int i = 0; i < rayCount; ++i) {
+                    if (sightMaze->hasLineOfSight(fromX[i], fromZ[i], toX[i], toZ[i])) {
+                        single[i >> 6] |= std::uint64_t(1) << (i & 63);
+                    }
+                }
+            });
+            std::snprintf(name, sizeof(name), "Maze::lineOfSight x4096, %s (batched)", label);
+            runBenchmark(name, 50, [&]() {
+                sightMaze->lineOfSight(fromX.data(), fromZ.data(), toX.data(), toZ.data(), rayCount, batched.data());
+            });
+            int clear = 0, mismatches = 0;
+            for (int i = 0; i < rayCount; ++i) {
+                const bool a = (single[i >> 6] >> (i & 63)) & 1u, b = (batched[i >> 6] >> (i & 63)) & 1u;
+                clear += b ? 1 : 0;
+                mismatches += a != b ? 1 : 0;
+            }
+            std::printf("  %d/%d rays clear, %d mismatches between the two\n", clear, rayCount, mismatches);
+        }
+    }
+
+    // --- Spatial grid: proximity queries over 10k moving entities against a linear scan ---
+    {
+        const int entityCount = 10000, querySize = 1024;
+        SpatialGrid grid;
+        grid.reset(1025, 1025);
+        std::vector<float> entityX(entityCount), entityZ(entityCount);
+        std::vector<int> ids(entityCount);
+        std::uint32_t seed = 99;
+        for (int i = 0; i < entityCount; ++i) {
+            entityX[i] = static_cast<float>(nextRandom(seed) % 102500) / 100.0f;
+            entityZ[i] = static_cast<float>(nextRandom(seed) % 102500) / 100.0f;
+            ids[i] = grid.insert(entityX[i], entityZ[i], 0);
+        }
+
+        int frame = 0;
+        runBenchmark("\nSpatialGrid::move x10000 (one frame)", 100, [&]() {
+            const float drift = (frame++ & 1) ? 0.05f : -0.05f;
+            for (int i = 0; i < entityCount; ++i) {
+                entityX[i] += drift;
+                entityZ[i] += drift;
+                grid.move(ids[i], entityX[i], entityZ[i]);
+            }
+        });
+
+        std::vector<PathCell> centres;
+        while (centres.size() < static_cast<size_t>(querySize)) {
+            centres.push_back(PathCell{ static_cast<int>(nextRandom(seed) % 1025), static_cast<int>(nextRandom(seed) % 1025) });
+        }
+        size_t gridHits = 0, scanHits = 0;
+        runBenchmark("SpatialGrid::forEachInRadius r=2 x1024", 20, [&]() {
+            for (const PathCell& centre : centres) {
+                grid.forEachInRadius(centre.col + 0.5f, centre.row + 0.5f, 2.0f, [&](int) { ++gridHits; });
+            }
+        });
+        runBenchmark("Linear scan r=2 x1024", 20, [&]() {
+            for (const PathCell& centre : centres) {
+                const float x = centre.col + 0.5f, z = centre.row + 0.5f;
+                for (int i = 0; i < entityCount; ++i) {
+                    const float dx = entityX[i] - x, dz = entityZ[i] - z;
+                    scanHits += dx * dx + dz * dz <= 4.0f ? 1 : 0;
+                }
+            }
+        });
+        std::printf("  %zu hits from the grid, %zu from the scan\n", gridHits, scanHits);
+    }
+
+    // --- Camera: per-step movement, mouse look and the view matrix applyViewMatrix uploads ---
+    {
+        Camera camera;
+        camera.setPosition(512.5f, PLAYER_EYE_HEIGHT, 512.5f);
+        const int stepCount = 1 << 20;
+        runBenchmark("\nCamera::moveForward + strafeRight x1M", 10, [&]() {
+            for (int i = 0; i < stepCount; ++i) {
+                camera.moveForward((i & 1) ? PLAYER_MOVE_SPEED : -PLAYER_MOVE_SPEED);
+                camera.strafeRight((i & 2) ? PLAYER_MOVE_SPEED : -PLAYER_MOVE_SPEED);
+            }
+        });
+        runBenchmark("Camera::processMouseMovement x1M", 10, [&]() {
+            for (int i = 0; i < stepCount; ++i) {
+                camera.processMouseMovement((i & 15) - 7, (i & 7) - 3, PLAYER_ROTATE_SPEED);
+            }
+        });
+        float view[16];
+        volatile float sink = 0.0f;
+        runBenchmark("Camera::getViewMatrix x1M", 10, [&]() {
+            for (int i = 0; i < stepCount; ++i) {
+                camera.getViewMatrix(view);
+                sink = sink + view[12];
+            }
+        });
+    }
+
+    // --- By-name lookups: TextureManager's name table and InputHandler's held keys ---
+    {
+        // Names of the texture manifest plus the scene array, registered as TextureManager does
+        const char* const textureNames[] = { "wall", "floor", "ceiling", "brick", "stone", "door", "blood", "mirror",
+                                             "table", "chair", "mannequin_skin", "mannequin_cloth", "mannequin_eye", "scene" };
+        TextureNames textures;
+        std::vector<std::string> lookups;
+        for (const char* name : textureNames) {
+            textures.add(name, static_cast<TextureHandle>(lookups.size()) + 1);
+            lookups.push_back(name);
+        }
+        lookups.push_back("missing"); // bindTexture's warning path
+
+        const int lookupCount = 1 << 20;
+        volatile TextureHandle handleSink = 0;
+        runBenchmark("\nTextureNames::find x1M", 10, [&]() {
+            TextureHandle sum = 0;
+            for (int i = 0; i < lookupCount; ++i) {
+                sum += textures.find(lookups[i % lookups.size()]);
+            }
+            handleSink = handleSink + sum;
+        });
+        runBenchmark("TextureNames::find x1M from a string literal", 10, [&]() {
+            TextureHandle sum = 0;
+            for (int i = 0; i < lookupCount; ++i) {
+                sum += textures.find("mannequin_cloth"); // Builds a std::string per call, like bindTexture("...")
+            }
+            handleSink = handleSink + sum;
+        });
+
+        // The eight queries InputHandler::processHeldKeys makes every step, with W and D held
+        KeyStates keys;
+        keys.setKey('W', true);
+        keys.setKey('d', true);
+        keys.setKey('s', false);
+        keys.setSpecialKey(101, true); // GLUT_KEY_UP
+        volatile int keySink = 0;
+        runBenchmark("KeyStates held-key checks x1M steps", 10, [&]() {
+            int held = 0;
+            for (int i = 0; i < lookupCount; ++i) {
+                held += keys.isKeyPressed('w') + keys.isKeyPressed('s') + keys.isKeyPressed('a') + keys.isKeyPressed('d');
+                for (int special = 100; special <= 103; ++special) { // GLUT_KEY_LEFT .. GLUT_KEY_DOWN
+                    held += keys.isSpecialKeyPressed(special);
+                }
+            }
+            keySink = keySink + held;
+        });
+    }
+
+    // --- Player collisions: the per-step checks of Game::update and Game::checkCollisions ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.3f);
+        generator.setRooms(2, 5);
+        const Maze level = generator.generate(1025, 1025, 3);
+        SpatialGrid triggers;
+        triggers.reset(level.getWidth(), level.getHeight());
+        std::uint32_t seed = 2024;
+        for (int i = 0; i < 4096; ++i) {
+            // Odd cells are open; triggers (tag 0) and props (tag 1) sit in cell centres
+            triggers.insert(2.0f * static_cast<float>(nextRandom(seed) % 512) + 1.5f,
+                            2.0f * static_cast<float>(nextRandom(seed) % 512) + 1.5f, i & 1);
+        }
+
+        Camera player;
+        player.setPosition(513.5f, PLAYER_EYE_HEIGHT, 513.5f);
+        int touched = 0, blocked = 0, step = 0;
+        runBenchmark("\nPlayer collision step x100000", 10, [&]() {
+            for (int i = 0; i < 100000; ++i, ++step) {
+                const float oldX = player.getX(), oldZ = player.getZ();
+                player.processMouseMovement((step >> 6) % 3 - 1, 0, PLAYER_ROTATE_SPEED * 20.0f);
+                player.moveForward(PLAYER_MOVE_SPEED);
+                triggers.forEachInRadius(player.getX(), player.getZ(), TRIGGER_RADIUS, [&](int) { ++touched; });
+                bool stop = level.isWall(static_cast<int>(player.getZ()), static_cast<int>(player.getX()));
+                triggers.forEachInRadius(player.getX(), player.getZ(), PROP_COLLISION_RADIUS, [&](int id) {
+                    stop = stop || triggers.getTag(id) == 1;
+                });
+                if (stop) {
+                    player.setPosition(oldX, player.getY(), oldZ);
+                    player.processMouseMovement(97, 0, PLAYER_ROTATE_SPEED);
+                    ++blocked;
+                }
+            }
+        });
+        std::printf("  %d trigger contacts, %d steps blocked by walls or props\n", touched, blocked);
+    }
+
+    // --- Hierarchical pathfinder: long routes on a large level against flat JPS ---
+    {
+        MazeGenerator generator;
+        generator.setBraid(0.2f);
+        generator.setRooms(2, 5);
+        Maze bigMaze = generator.generate(4097, 4097, 23);
+        HierarchicalPathfinder hierarchy(bigMaze);
+        hierarchy.build();
+        std::printf("\nHierarchicalPathfinder 4097x4097: built in %.2f ms, %d nodes in %d clusters\n",
+                    hierarchy.getBuildMilliseconds(), hierarchy.getNodeCount(), hierarchy.getClusterCount());
+
+        std::vector<PathCell> queries;
+        std::uint32_t seed = 4242;
+        while (queries.size() < 64) {
+            queries.push_back(PathCell{ 2 * static_cast<int>(nextRandom(seed) % 2048) + 1,
+                                        2 * static_cast<int>(nextRandom(seed) % 2048) + 1 });
+        }
+        const int pairCount = static_cast<int>(queries.size()) / 2;
+        std::vector<PathCell> waypoints, path;
+        int pair = 0;
+        size_t found = 0;
+        runBenchmark("HierarchicalPathfinder::findPath 4097x4097", pairCount, [&]() {
+            const PathCell& from = queries[2 * (pair % pairCount)];
+            const PathCell& to = queries[2 * (pair % pairCount) + 1];
+            ++pair;
+            found += hierarchy.findPath(from.row, from.col, to.row, to.col, waypoints) ? 1 : 0;
+        });
+        std::printf("  %zu/%d found, %.0f abstract nodes expanded per search\n", found, pair,
+                    static_cast<double>(hierarchy.getExpandedNodes()) / pair);
+
+        // Flat JPS on a few of the same pairs, and how much longer the refined hierarchical routes are
+        Pathfinder flat(bigMaze, 1 << 22);
+        size_t flatLength = 0, refinedLength = 0;
+        int flatPair = 0;
+        runBenchmark("Pathfinder::findPath 4097x4097 (same pairs)", 3, [&]() {
+            const PathCell& from = queries[2 * (flatPair % pairCount)];
+            const PathCell& to = queries[2 * (flatPair % pairCount) + 1];
+            ++flatPair;
+            if (flat.findPath(from.row, from.col, to.row, to.col, path)) {
+                flatLength += path.size();
+                if (hierarchy.findFullPath(from.row, from.col, to.row, to.col, path)) refinedLength += path.size();
+            }
+        });
+        std::printf("  hierarchical routes %zu cells vs %zu shortest (%.2f%% longer)\n", refinedLength, flatLength,
+                    flatLength ? 100.0 * (static_cast<double>(refinedLength) / flatLength - 1.0) : 0.0);
+
+        // A single wall edit only rebuilds the clusters around it
+        int edit = 0;
+        runBenchmark("HierarchicalPathfinder::rebuildDirty (1 wall)", 20, [&]() {
+            const int row = 2 * (1000 + edit) + 1, col = 2 * 1000 + 2;
+            ++edit;
+            bigMaze.setWall(row, col, !bigMaze.isWall(row, col));
+            hierarchy.markDirty(row, col);
+            hierarchy.rebuildDirty();
+        });
+    }
+
+    // --- Binary maze files: mapping cost should not grow with the level size ---
+    const std::string mazePath = "bench_maze.ahmaze";
+    for (int size : { 1024, 8192 }) {
+        if (!makeRandomMaze(size, size, 7).saveToFile(mazePath)) {
+            std::printf("Could not write %s\n", mazePath.c_str());
+            break;
+        }
+        char name[96];
+        std::snprintf(name, sizeof(name), "\nMaze::loadFromFile %dx%d", size, size);
+        runBenchmark(name, 20, [&]() {
+            Maze mapped(1, 1);
+            mapped.loadFromFile(mazePath);
+        });
+    }
+    {
+        Maze mapped(1, 1);
+        if (mapped.loadFromFile(mazePath)) {
+            benchmarkGridQueries("Mapped 8192x8192", mapped);
+        }
+    }
+    std::remove(mazePath.c_str());
+
+    if (!jsonPath.empty()) {
+        if (writeJson(jsonPath, hardwareThreads)) {
+            std::printf("\nWrote %zu results to %s\n", results.size(), jsonPath.c_str());
+        } else {
+            std::printf("\nCould not write %s\n", jsonPath.c_str());
+        }
+    }
+    if (!baselinePath.empty() && compareWithBaseline(baselinePath, thresholdPercent) > 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#version 120
+#extension GL_ARB_uniform_buffer_object : require
+#extension GL_EXT_texture_array : enable
+// One attenuated point light plus global ambient and GL_EXP2-style fog, all evaluated
+// per pixel in world space from the SceneBlock shared with the other scene shaders.
+
+layout(std140) uniform SceneBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+    vec4 globalAmbient;
+    vec4 attenuation;   // constant, linear, quadratic
+    vec4 fogColor;      // rgb, a = EXP2 density
+    float lightIntensity;
+    int lightingEnabled;
+    int fogEnabled;
+};
+
+uniform sampler2DArray sceneTextures;
+
+varying vec3 vWorldPos;
+varying vec3 vNormal;
+varying vec3 vTexCoord;
+
+void main() {
+    vec4 albedo = texture2DArray(sceneTextures, vTexCoord);
+    vec3 color = albedo.rgb;
+
+    if (lightingEnabled != 0) {
+        vec3 toLight = lightPosition.xyz - vWorldPos;
+        float dist = length(toLight);
+        float falloff = 1.0 / (attenuation.x + attenuation.y * dist + attenuation.z * dist * dist);
+        float diffuse = max(dot(normalize(vNormal), toLight / dist), 0.0);
+        vec3 light = globalAmbient.rgb +
+                     (lightAmbient.rgb + lightDiffuse.rgb * diffuse) * lightIntensity * falloff;
+        color *= light;
+    }
+
+    if (fogEnabled != 0) {
+        float fogAmount = fogColor.a * length(cameraPosition.xyz - vWorldPos);
+        float visibility = clamp(exp(-fogAmount * fogAmount), 0.0, 1.0);
+        color = mix(fogColor.rgb, color, visibility);
+    }
+
+    gl_FragColor = vec4(color, albedo.a);
+}
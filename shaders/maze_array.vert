@@ -0,0 +1,31 @@
+#version 120
+#extension GL_ARB_uniform_buffer_object : require
+// Static maze geometry sampled from the scene texture array.
+// Vertices are already in world space; the third texture coordinate carries the array layer.
+
+layout(std140) uniform SceneBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+    vec4 globalAmbient;
+    vec4 attenuation;   // constant, linear, quadratic
+    vec4 fogColor;      // rgb, a = EXP2 density
+    float lightIntensity;
+    int lightingEnabled;
+    int fogEnabled;
+};
+
+varying vec3 vWorldPos;
+varying vec3 vNormal;
+varying vec3 vTexCoord;
+
+void main() {
+    vWorldPos = gl_Vertex.xyz;
+    vNormal = gl_Normal;
+    vTexCoord = gl_MultiTexCoord0.stp;
+    gl_Position = projection * view * vec4(gl_Vertex.xyz, 1.0);
+}
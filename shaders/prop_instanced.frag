@@ -0,0 +1,55 @@
+#version 120
+#extension GL_ARB_uniform_buffer_object : require
+// Same light and fog model as maze_array.frag, plus a per-instance tint and Blinn-Phong specular.
+
+layout(std140) uniform SceneBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+    vec4 globalAmbient;
+    vec4 attenuation;   // constant, linear, quadratic
+    vec4 fogColor;      // rgb, a = EXP2 density
+    float lightIntensity;
+    int lightingEnabled;
+    int fogEnabled;
+};
+
+uniform sampler2D propTexture;
+
+varying vec3 vWorldPos;
+varying vec3 vNormal;
+varying vec2 vTexCoord;
+varying vec4 vTint;
+varying vec2 vSpecular; // x = strength, y = shininess
+
+void main() {
+    vec4 albedo = texture2D(propTexture, vTexCoord) * vTint;
+    vec3 color = albedo.rgb;
+    vec3 toCamera = cameraPosition.xyz - vWorldPos;
+
+    if (lightingEnabled != 0) {
+        vec3 toLight = lightPosition.xyz - vWorldPos;
+        float dist = length(toLight);
+        vec3 lightDir = toLight / dist;
+        vec3 normal = normalize(vNormal);
+        float falloff = 1.0 / (attenuation.x + attenuation.y * dist + attenuation.z * dist * dist);
+        float diffuse = max(dot(normal, lightDir), 0.0);
+        vec3 halfVector = normalize(lightDir + normalize(toCamera));
+        float specular = diffuse > 0.0 ? pow(max(dot(normal, halfVector), 0.0), vSpecular.y) * vSpecular.x : 0.0;
+        vec3 light = globalAmbient.rgb +
+                     (lightAmbient.rgb + lightDiffuse.rgb * diffuse) * lightIntensity * falloff;
+        color = color * light + lightSpecular.rgb * specular * lightIntensity * falloff;
+    }
+
+    if (fogEnabled != 0) {
+        float fogAmount = fogColor.a * length(toCamera);
+        float visibility = clamp(exp(-fogAmount * fogAmount), 0.0, 1.0);
+        color = mix(fogColor.rgb, color, visibility);
+    }
+
+    gl_FragColor = vec4(color, albedo.a);
+}
@@ -0,0 +1,43 @@
+#version 120
+#extension GL_ARB_uniform_buffer_object : require
+// Furniture props: one baked mesh per prop type, drawn instanced.
+// Each instance places, turns, scales and tints the mesh.
+
+layout(std140) uniform SceneBlock {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+    vec4 globalAmbient;
+    vec4 attenuation;   // constant, linear, quadratic
+    vec4 fogColor;      // rgb, a = EXP2 density
+    float lightIntensity;
+    int lightingEnabled;
+    int fogEnabled;
+};
+
+attribute vec4 instancePlacement; // xyz = position on the floor, w = yaw in radians
+attribute vec4 instanceMaterial;  // x = scale, y = specular strength, z = shininess
+attribute vec4 instanceTint;
+
+varying vec3 vWorldPos;
+varying vec3 vNormal;
+varying vec2 vTexCoord;
+varying vec4 vTint;
+varying vec2 vSpecular;
+
+void main() {
+    // Same rotation as glRotatef(yaw, 0, 1, 0)
+    float s = sin(instancePlacement.w);
+    float c = cos(instancePlacement.w);
+    vec3 local = gl_Vertex.xyz * instanceMaterial.x;
+    vWorldPos = vec3(c * local.x + s * local.z, local.y, -s * local.x + c * local.z) + instancePlacement.xyz;
+    vNormal = vec3(c * gl_Normal.x + s * gl_Normal.z, gl_Normal.y, -s * gl_Normal.x + c * gl_Normal.z);
+    vTexCoord = gl_MultiTexCoord0.st;
+    vTint = instanceTint;
+    vSpecular = instanceMaterial.yz;
+    gl_Position = projection * view * vec4(vWorldPos, 1.0);
+}
@@ -0,0 +1,53 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Relaxed: the totals are only read for reports, never to order other memory
+    std::atomic<std::uint64_t> allocationCount{ 0 };
+    std::atomic<std::uint64_t> allocationBytes{ 0 };
+
+    void* countedAllocate(std::size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size != 0 ? size : 1);
+    }
+}
+
+std::uint64_t AllocationCounter::getAllocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AllocationCounter::getBytes() {
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+// --- Global replacements ---
+
+void* operator new(std::size_t size) {
+    void* memory = countedAllocate(size);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    void* memory = countedAllocate(size);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
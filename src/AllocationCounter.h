@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new, so long headless runs can
+// show whether anything allocates per tick. The replacement operators live in
+// AllocationCounter.cpp and apply to the whole program once that file is linked in.
+// Over-aligned allocations (alignas above the default) are not counted.
+class AllocationCounter {
+public:
+    // Allocations and requested bytes since the program started
+    static std::uint64_t getAllocations();
+    static std::uint64_t getBytes();
+};
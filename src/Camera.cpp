@@ -1,44 +1,85 @@
-void Camera::moveForward(float distance) {
-    // Calculate movement direction based on yaw (angleY)
-    float dx = sin(angleY) * distance;
-    float dz = -cos(angleY) * distance; // Negative because Z decreases going forward in OpenGL
-    x += dx;
-    z += dz;
-    // Optionally, check for collision or out-of-bounds in a game environment
-}
-
-void Camera::strafeRight(float distance) {
-    // Calculate strafe direction (perpendicular to look direction)
-    float dx = cos(angleY) * distance;
-    float dz = sin(angleY) * distance;
-    x += dx;
-    z += dz;
-}
-
-void Camera::rotateY(float angle) {
-    angleY += angle;
-    angleY = fmod(angleY, 2.0f * M_PI); // Normalize to keep within 0 to 2π range
-}
-
-void Camera::rotateX(float angle) {
-    angleX += angle;
-    clampPitch();
-}
-
-void Camera::applyViewMatrix() const {
-    // Set up the view matrix using gluLookAt or manual matrix calculation
-    // Target point calculation:
-    float lookX = x + sin(angleY) * cos(angleX);
-    float lookY = y + sin(angleX);
-    float lookZ = z - cos(angleY) * cos(angleX);
-
-    // Up vector calculation (simplified, assumes no roll)
-    float upX = 0.0f;
-    float upY = 1.0f;
-    float upZ = 0.0f;
-
-    // Apply the lookAt transformation
-    gluLookAt(x, y, z,       // Camera position (eye)
-              lookX, lookY, lookZ, // Target point (center)
-              upX, upY, upZ);      // Up vector
-}
+#include "Camera.h"
+#include "MathUtil.h"
+#include <GL/glew.h>
+#include <GL/freeglut.h> // For gluLookAt
+
+namespace {
+    // Just short of straight up or down, so the look direction never lines up with the up vector
+    const float MAX_PITCH = 1.55f;
+}
+
+Camera::Camera() : x(0.0f), y(PLAYER_EYE_HEIGHT), z(0.0f), angleX(0.0f), angleY(0.0f) {}
+
+void Camera::setPosition(float newX, float newY, float newZ) {
+    x = newX;
+    y = newY;
+    z = newZ;
+}
+
+void Camera::setOrientation(float newAngleX, float newAngleY) {
+    angleX = newAngleX;
+    angleY = newAngleY;
+    clampPitch();
+}
+
+void Camera::moveForward(float distance) {
+    // Calculate movement direction based on yaw (angleY)
+    float dx = sin(angleY) * distance;
+    float dz = -cos(angleY) * distance; // Negative because Z decreases going forward in OpenGL
+    x += dx;
+    z += dz;
+    // Optionally, check for collision or out-of-bounds in a game environment
+}
+
+void Camera::strafeRight(float distance) {
+    // Calculate strafe direction (perpendicular to look direction)
+    float dx = cos(angleY) * distance;
+    float dz = sin(angleY) * distance;
+    x += dx;
+    z += dz;
+}
+
+void Camera::rotateY(float angle) {
+    angleY += angle;
+    angleY = fmod(angleY, 2.0f * M_PI); // Normalize to keep within 0 to 2π range
+}
+
+void Camera::rotateX(float angle) {
+    angleX += angle;
+    clampPitch();
+}
+
+void Camera::applyViewMatrix() const {
+    // Set up the view matrix using gluLookAt or manual matrix calculation
+    // Target point calculation:
+    float lookX = x + sin(angleY) * cos(angleX);
+    float lookY = y + sin(angleX);
+    float lookZ = z - cos(angleY) * cos(angleX);
+
+    // Up vector calculation (simplified, assumes no roll)
+    float upX = 0.0f;
+    float upY = 1.0f;
+    float upZ = 0.0f;
+
+    // Apply the lookAt transformation
+    gluLookAt(x, y, z,       // Camera position (eye)
+              lookX, lookY, lookZ, // Target point (center)
+              upX, upY, upZ);      // Up vector
+}
+
+void Camera::getViewMatrix(float out[16]) const {
+    MathUtil::lookAt(out, x, y, z,
+                     x + sin(angleY) * cos(angleX), y + sin(angleX), z - cos(angleY) * cos(angleX),
+                     0.0f, 1.0f, 0.0f);
+}
+
+void Camera::processMouseMovement(int deltaX, int deltaY, float sensitivity) {
+    // Mouse right turns right; mouse up looks up (window y grows downward)
+    rotateY(static_cast<float>(deltaX) * sensitivity);
+    rotateX(-static_cast<float>(deltaY) * sensitivity);
+}
+
+void Camera::clampPitch() {
+    if (angleX > MAX_PITCH) angleX = MAX_PITCH;
+    if (angleX < -MAX_PITCH) angleX = -MAX_PITCH;
+}
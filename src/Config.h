@@ -1,47 +1,110 @@
-#pragma once
-
-// Window settings
-const int WINDOW_WIDTH = 1024;
-const int WINDOW_HEIGHT = 768;
-
-// Maze and world settings
-const int MAZE_SIZE = 15;
-const float ROOM_SIZE = 10.0f; // Room size in the game world
-const float WALL_HEIGHT = 3.0f;
-const float DOOR_WIDTH = 1.5f;
-const float DOOR_HEIGHT = 2.5f;
-
-// Player settings
-const float PLAYER_EYE_HEIGHT = 1.7f;   // Eye height for the player
-const float PLAYER_MOVE_SPEED = 0.1f;   // Movement speed
-const float PLAYER_ROTATE_SPEED = 0.005f; // Rotation speed
-
-// Ghost settings
-const float GHOST_SPEED = 0.02f;
-const int GHOST_APPEAR_INTERVAL_MIN = 5000;  // Minimum ghost appearance interval in ms
-const int GHOST_APPEAR_INTERVAL_MAX = 15000; // Maximum ghost appearance interval in ms
-const int GHOST_VISIBLE_DURATION = 3000;    // Duration the ghost is visible in ms
-
-// Lighting settings
-const int FLICKER_INTERVAL = 200; // Flicker interval in milliseconds for horror lighting effect
-
-// Sound file paths
-const char* SOUND_FOOTSTEP = "sounds/footstep.wav";
-const char* SOUND_DOOR_CREAK = "sounds/door_creak.wav";
-const char* SOUND_GHOST_APPEAR = "sounds/ghost_appear.wav";
-const char* SOUND_AMBIENT = "sounds/ambient_horror.wav";
-const char* SOUND_PICKUP_KEY = "sounds/pickup_key.wav";
-const char* SOUND_WIN = "sounds/win_sound.wav";
-
-// Texture file paths
-const char* TEX_WALL = "textures/wall_texture.png";
-const char* TEX_FLOOR = "textures/floor_texture.png";
-const char* TEX_CEILING = "textures/ceiling_texture.png";
-const char* TEX_DOOR = "textures/door_texture.png"; 
-const char* TEX_BLOOD = "textures/blood_texture.png";
-const char* TEX_MIRROR = "textures/mirror_texture.png";
-const char* TEX_TABLE = "textures/wood_texture.jpg";
-const char* TEX_CHAIR = "textures/fabric_texture.jpg";
-const char* TEX_MANNEQUIN_SKIN = "textures/mannequin_skin.jpg";
-const char* TEX_MANNEQUIN_CLOTH = "textures/mannequin_cloth.jpg";
-const char* TEX_MANNEQUIN_EYE = "textures/mannequin_eyes.jpg";
+#pragma once
+
+// Window settings
+const int WINDOW_WIDTH = 1024;
+const int WINDOW_HEIGHT = 768;
+
+// Maze and world settings
+const int MAZE_MAX_DIMENSION = 16384; // Largest supported maze width/height in cells
+const int MAZE_GENERATE_WIDTH = 63;      // Size of mazes made with --generate <seed>
+const int MAZE_GENERATE_HEIGHT = 63;
+const float MAZE_GENERATE_BRAID = 0.2f;  // Chance a dead end is opened into a loop
+const int MAZE_GENERATE_ROOMS = 2;       // Rooms carved per 32x32-cell region
+const int MAZE_GENERATE_MAX_ROOM = 5;    // Largest room side in cells
+const float ROOM_SIZE = 10.0f; // Room size in the game world
+const float WALL_HEIGHT = 3.0f;
+const float DOOR_WIDTH = 1.5f;
+const float DOOR_HEIGHT = 2.5f;
+const int BLOODSTAIN_ONE_IN = 24;       // About one open cell in this many gets a bloodstain on a wall
+
+// Player settings
+const float PLAYER_EYE_HEIGHT = 1.7f;   // Eye height for the player
+const float PLAYER_MOVE_SPEED = 0.1f;   // Movement speed
+const float PLAYER_ROTATE_SPEED = 0.005f; // Rotation speed
+
+// Simulation timing
+const int SIMULATION_STEP_HZ = 60;          // Fixed simulation steps per second
+const int MAX_CATCH_UP_STEPS = 5;           // Steps run per frame at most; older backlog is dropped
+const double MAX_FRAME_SECONDS = 0.25;      // Longer frames (debugger, window drag) count as this
+const double HEADLESS_REPORT_SECONDS = 10.0; // Wall time between progress lines in --headless runs
+const int RECORDING_CHECKPOINT_TICKS = 60;  // Steps between state checksums in --record files
+
+// Ghost settings
+const float GHOST_SPEED = 0.02f;
+const int GHOST_APPEAR_INTERVAL_MIN = 5000;  // Minimum ghost appearance interval in ms
+const int GHOST_APPEAR_INTERVAL_MAX = 15000; // Maximum ghost appearance interval in ms
+const int GHOST_VISIBLE_DURATION = 3000;    // Duration the ghost is visible in ms
+const int FLOW_FIELD_RADIUS = 96;           // Path distance (cells) ghosts can track the player from
+const float GHOST_SIGHT_RANGE = 12.0f;       // Swarm ghosts farther than this never see the player
+const int GHOST_BATCH_SIZE = 1024;          // Swarm ghosts per job; keep a multiple of 4 (SIMD lanes)
+
+// Proximity settings
+const int SPATIAL_GRID_BUCKET_SHIFT = 2;    // Spatial grid buckets are 4x4 maze cells
+const float TRIGGER_RADIUS = 0.5f;          // Walking this close picks up the key or enters the exit
+const float INTERACT_RADIUS = 1.5f;         // Reach of the interact key
+const float PROP_COLLISION_RADIUS = 0.3f;   // The player cannot walk closer than this to a prop's centre
+
+// Job system settings
+const int JOB_WORKER_THREADS = 0;           // Threads besides the main one; 0 = hardware threads - 1
+
+// Pathfinding settings
+const double PATHFINDER_BUDGET_MS = 0.5;    // Search time per frame; unfinished searches resume next frame
+const int PATHFINDER_BUDGET_NODES = 2048;   // Jump points per step instead while recording or replaying, so runs repeat exactly
+const int PATHFINDER_MAX_NODES = 65536;     // Jump points per search before it gives up
+const int PATH_CACHE_SIZE = 32;             // Recent routes kept until the maze changes
+const int HPA_CLUSTER_SIZE = 64;            // Cluster side in cells; matches Maze::TILE_SIZE, so generated
+                                            // mazes put cluster borders on their region walls
+const int HPA_MIN_DISTANCE = 64;            // Requests at least this far apart (Manhattan) use the hierarchy
+
+// Lighting settings
+const int FLICKER_INTERVAL = 200; // Flicker interval in milliseconds for horror lighting effect
+const float FLICKER_MIN_INTENSITY = 0.75f; // Ordinary flickers stay between this and full intensity
+const float FLICKER_DIM_CHANCE = 0.08f;    // Chance a flicker drops the light to FLICKER_DIM_INTENSITY
+const float FLICKER_DIM_INTENSITY = 0.2f;
+const float FOG_DENSITY = 0.15f;  // GL_EXP2 fog density; also bounds the culling distance
+
+// Potentially-visible-set settings
+const int PVS_MAX_MEMORY_MB = 256; // Skip the PVS precompute for mazes that would need more
+
+// Texture streaming settings
+const double TEXTURE_UPLOAD_BUDGET_MS = 4.0; // GL-thread time per frame for uploading decoded textures
+const char* const TEXTURE_CACHE_EXTENSION = ".ahtex"; // Baked cache written next to each source image
+
+// Profiling settings
+const char* const PROFILE_CSV_PATH = "frame_profile.csv"; // Written by the 'o' key
+const char* const TRACE_JSON_PATH = "trace.json";          // Written by the 't' key (tracing builds only)
+const int TRACE_RING_EVENTS = 1 << 16;                      // Newest trace events kept per thread (power of two)
+
+// Camera projection settings
+const float CAMERA_FOV = 45.0f;   // Vertical field of view in degrees
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 100.0f;
+
+// Sound file paths
+const char* const SOUND_FOOTSTEP = "sounds/footstep.wav";
+const char* const SOUND_DOOR_CREAK = "sounds/door_creak.wav";
+const char* const SOUND_GHOST_APPEAR = "sounds/ghost_appear.wav";
+const char* const SOUND_AMBIENT = "sounds/ambient_horror.wav";
+const char* const SOUND_PICKUP_KEY = "sounds/pickup_key.wav";
+const char* const SOUND_WIN = "sounds/win_sound.wav";
+
+// Texture file paths
+const char* const TEX_WALL = "textures/wall_texture.png";
+const char* const TEX_FLOOR = "textures/floor_texture.png";
+const char* const TEX_CEILING = "textures/ceiling_texture.png";
+const char* const TEX_BRICK = "textures/Horror_Brick_10-512x512.png";
+const char* const TEX_STONE = "textures/Horror_Stone_01-512x512.png";
+const char* const TEX_DOOR = "textures/door_texture.png"; 
+const char* const TEX_BLOOD = "textures/blood_texture.png";
+const char* const TEX_MIRROR = "textures/mirror_texture.png";
+const char* const TEX_TABLE = "textures/wood_texture.jpg";
+const char* const TEX_CHAIR = "textures/fabric_texture.jpg";
+const char* const TEX_MANNEQUIN_SKIN = "textures/mannequin_skin.jpg";
+const char* const TEX_MANNEQUIN_CLOTH = "textures/mannequin_cloth.jpg";
+const char* const TEX_MANNEQUIN_EYE = "textures/mannequin_eyes.jpg";
+
+// Shader file paths
+const char* const SHADER_MAZE_ARRAY_VERT = "shaders/maze_array.vert";
+const char* const SHADER_MAZE_ARRAY_FRAG = "shaders/maze_array.frag";
+const char* const SHADER_PROP_INSTANCED_VERT = "shaders/prop_instanced.vert";
+const char* const SHADER_PROP_INSTANCED_FRAG = "shaders/prop_instanced.frag";
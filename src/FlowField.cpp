@@ -0,0 +1,94 @@
+#include "FlowField.h"
+#include "Maze.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Neighbour offsets; a node's direction indexes these to step toward the root
+    const int STEP_ROW[4] = { -1, 1, 0, 0 };
+    const int STEP_COL[4] = { 0, 0, -1, 1 };
+    const int OPPOSITE[4] = { 1, 0, 3, 2 };
+    const std::uint8_t ROOT = 4;
+}
+
+FlowField::FlowField(int radius)
+    : radius(std::max(1, std::min(radius, static_cast<int>(std::numeric_limits<std::uint16_t>::max())))),
+      side(2 * this->radius + 1), originRow(0), originCol(0), rootRow(-1), rootCol(-1),
+      mazeVersion(0), valid(false), generation(0), reachedCells(0), buildCount(0),
+      nodes(static_cast<size_t>(side) * side, Node{ 0, 0, 0, 0 }) {
+    queue.reserve(static_cast<size_t>(side) * side);
+}
+
+bool FlowField::update(const Maze& maze, int newRootRow, int newRootCol) {
+    if (valid && newRootRow == rootRow && newRootCol == rootCol && maze.getVersion() == mazeVersion) {
+        return false;
+    }
+    rootRow = newRootRow;
+    rootCol = newRootCol;
+    mazeVersion = maze.getVersion();
+    build(maze);
+    valid = true;
+    return true;
+}
+
+void FlowField::build(const Maze& maze) {
+    if (++generation == 0) {
+        // Stamp wrapped: clear once so no stale node can match the new generation
+        for (Node& node : nodes) node.stamp = 0;
+        generation = 1;
+    }
+    ++buildCount;
+    originRow = rootRow - radius;
+    originCol = rootCol - radius;
+    reachedCells = 0;
+    queue.clear();
+
+    if (static_cast<unsigned>(rootRow) >= static_cast<unsigned>(maze.getHeight()) ||
+        static_cast<unsigned>(rootCol) >= static_cast<unsigned>(maze.getWidth())) {
+        return;
+    }
+
+    const int rootSlot = slotOf(rootRow, rootCol);
+    nodes[rootSlot] = Node{ generation, 0, ROOT, 0 };
+    queue.push_back(rootSlot);
+
+    // Plain FIFO BFS over the window; slots are converted back to cells on pop
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int slot = queue[head];
+        const Node& current = nodes[slot];
+        if (current.distance >= radius) continue;
+        const int row = originRow + slot / side, col = originCol + slot % side;
+        const std::uint16_t nextDistance = static_cast<std::uint16_t>(current.distance + 1);
+        for (int d = 0; d < 4; ++d) {
+            const int nextRow = row + STEP_ROW[d], nextCol = col + STEP_COL[d];
+            if (static_cast<unsigned>(nextRow) >= static_cast<unsigned>(maze.getHeight()) ||
+                static_cast<unsigned>(nextCol) >= static_cast<unsigned>(maze.getWidth()) ||
+                maze.isWall(nextRow, nextCol)) {
+                continue;
+            }
+            // Within radius steps of the root, so always inside the window
+            const int nextSlot = slot + STEP_ROW[d] * side + STEP_COL[d];
+            Node& next = nodes[nextSlot];
+            if (next.stamp == generation) continue;
+            next = Node{ generation, nextDistance, static_cast<std::uint8_t>(OPPOSITE[d]), 0 };
+            queue.push_back(nextSlot);
+        }
+    }
+    reachedCells = static_cast<int>(queue.size());
+}
+
+int FlowField::getDistance(int row, int col) const {
+    const int slot = slotOf(row, col);
+    if (slot < 0 || nodes[slot].stamp != generation || !valid) return -1;
+    return nodes[slot].distance;
+}
+
+bool FlowField::getStep(int row, int col, int& stepRow, int& stepCol) const {
+    const int slot = slotOf(row, col);
+    if (slot < 0 || !valid) return false;
+    const Node& node = nodes[slot];
+    if (node.stamp != generation || node.direction == ROOT) return false;
+    stepRow = row + STEP_ROW[node.direction];
+    stepCol = col + STEP_COL[node.direction];
+    return true;
+}
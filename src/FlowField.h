@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Config.h" // For FLOW_FIELD_RADIUS
+#include <cstdint>
+#include <vector>
+
+class Maze; // Forward declaration
+
+// Breadth-first distance field over open maze cells, rooted at one cell (the player's).
+// Every reached cell stores its path distance to the root and the direction of its first
+// step back toward it, so any number of followers can move one cell closer in O(1).
+// The search stops `radius` steps from the root and only covers the square window of cells
+// around it, which keeps the cost independent of the maze size.
+class FlowField {
+public:
+    explicit FlowField(int radius = FLOW_FIELD_RADIUS);
+
+    // Re-root the field at (rootRow, rootCol) if that differs from the current root, if the
+    // maze's version changed (walls edited or a new layout), or if invalidate() was called
+    // since the last build. Returns true if the field was rebuilt.
+    bool update(const Maze& maze, int rootRow, int rootCol);
+
+    // Force the next update() to rebuild
+    void invalidate() { valid = false; }
+
+    // Path distance (in cells) from (row, col) to the root, or -1 if not reached
+    int getDistance(int row, int col) const;
+
+    // One-cell step toward the root from (row, col). Returns false if the cell is not
+    // reached or is the root itself.
+    bool getStep(int row, int col, int& stepRow, int& stepCol) const;
+
+    int getRootRow() const { return rootRow; }
+    int getRootCol() const { return rootCol; }
+    int getRadius() const { return radius; }
+    int getReachedCells() const { return reachedCells; }
+    int getBuildCount() const { return buildCount; }
+
+private:
+    // One entry per window cell; stale unless stamp matches the current generation
+    struct Node {
+        std::uint32_t stamp;
+        std::uint16_t distance;
+        std::uint8_t direction; // Index into the step tables, or ROOT
+        std::uint8_t unused;
+    };
+
+    int radius;
+    int side;                  // Window side: 2 * radius + 1
+    int originRow, originCol;  // Maze cell of window slot 0
+    int rootRow, rootCol;
+    std::uint64_t mazeVersion; // Maze::getVersion() the field was built from
+    bool valid;
+    std::uint32_t generation;  // Bumped per build so old entries never need clearing
+    int reachedCells;
+    int buildCount;
+
+    std::vector<Node> nodes;
+    std::vector<std::int32_t> queue; // BFS frontier (window slots), reused across builds
+
+    // Window slot of (row, col), or -1 if outside the window
+    int slotOf(int row, int col) const {
+        const int localRow = row - originRow, localCol = col - originCol;
+        if (static_cast<unsigned>(localRow) >= static_cast<unsigned>(side) ||
+            static_cast<unsigned>(localCol) >= static_cast<unsigned>(side)) {
+            return -1;
+        }
+        return localRow * side + localCol;
+    }
+
+    void build(const Maze& maze);
+};
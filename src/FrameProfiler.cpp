@@ -0,0 +1,127 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+void FrameProfiler::History::push(float value) {
+    samples[next] = value;
+    next = (next + 1) % HISTORY_FRAMES;
+    count = std::min(count + 1, HISTORY_FRAMES);
+}
+
+FrameProfiler::FrameProfiler()
+    : gpuTimers(false), overlayVisible(false), frameSlot(0), activeGpuPass(-1),
+      queries(), queryIssued(), cpuHistory(), gpuHistory() {}
+
+FrameProfiler::~FrameProfiler() {
+    release();
+}
+
+void FrameProfiler::initialize() {
+    release();
+    gpuTimers = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (!gpuTimers) {
+        std::cout << "[FrameProfiler] Timer queries unsupported; recording CPU times only." << std::endl;
+        return;
+    }
+    glGenQueries(QUERY_LATENCY * PASS_COUNT, &queries[0][0]);
+}
+
+void FrameProfiler::release() {
+    if (gpuTimers) {
+        glDeleteQueries(QUERY_LATENCY * PASS_COUNT, &queries[0][0]);
+        gpuTimers = false;
+    }
+    for (auto& slot : queryIssued) {
+        std::fill(std::begin(slot), std::end(slot), false);
+    }
+    activeGpuPass = -1;
+}
+
+void FrameProfiler::beginFrame() {
+    if (!gpuTimers) return;
+
+    // These queries were issued QUERY_LATENCY frames ago and are about to be reused
+    for (int pass = 0; pass < PASS_COUNT; ++pass) {
+        if (!queryIssued[frameSlot][pass]) continue;
+        queryIssued[frameSlot][pass] = false;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[frameSlot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue; // Drop the sample instead of stalling
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[frameSlot][pass], GL_QUERY_RESULT, &nanoseconds);
+        gpuHistory[pass].push(static_cast<float>(nanoseconds / 1.0e6));
+    }
+}
+
+void FrameProfiler::endFrame() {
+    frameSlot = (frameSlot + 1) % QUERY_LATENCY;
+}
+
+void FrameProfiler::beginPass(FramePass pass) {
+    const int index = static_cast<int>(pass);
+    passStart[index] = std::chrono::steady_clock::now();
+    if (gpuTimers && activeGpuPass < 0 && !queryIssued[frameSlot][index]) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[frameSlot][index]);
+        activeGpuPass = index;
+    }
+}
+
+void FrameProfiler::endPass(FramePass pass) {
+    const int index = static_cast<int>(pass);
+    if (activeGpuPass == index) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryIssued[frameSlot][index] = true;
+        activeGpuPass = -1;
+    }
+    cpuHistory[index].push(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - passStart[index]).count());
+}
+
+void FrameProfiler::summarize(const History& history, int& samples, float& minimum, float& average, float& p99) {
+    samples = history.count;
+    minimum = average = p99 = 0.0f;
+    if (history.count == 0) return;
+
+    std::vector<float> sorted(history.samples, history.samples + history.count);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float value : sorted) sum += value;
+    minimum = sorted.front();
+    average = static_cast<float>(sum / sorted.size());
+    p99 = sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99))];
+}
+
+FrameProfiler::PassStats FrameProfiler::getStats(FramePass pass) const {
+    const int index = static_cast<int>(pass);
+    PassStats stats;
+    summarize(cpuHistory[index], stats.cpuSamples, stats.cpuMin, stats.cpuAvg, stats.cpuP99);
+    summarize(gpuHistory[index], stats.gpuSamples, stats.gpuMin, stats.gpuAvg, stats.gpuP99);
+    return stats;
+}
+
+const char* FrameProfiler::getPassName(FramePass pass) {
+    static const char* const names[PASS_COUNT] = {
+        "cull", "maze", "furniture", "decorations", "ghost", "ui", "swap",
+    };
+    return names[static_cast<int>(pass)];
+}
+
+bool FrameProfiler::dumpCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "[FrameProfiler] Cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << "pass,cpu_samples,cpu_min_ms,cpu_avg_ms,cpu_p99_ms,gpu_samples,gpu_min_ms,gpu_avg_ms,gpu_p99_ms\n";
+    for (int index = 0; index < PASS_COUNT; ++index) {
+        const FramePass pass = static_cast<FramePass>(index);
+        const PassStats s = getStats(pass);
+        out << getPassName(pass) << ',' << s.cpuSamples << ',' << s.cpuMin << ',' << s.cpuAvg << ',' << s.cpuP99
+            << ',' << s.gpuSamples << ',' << s.gpuMin << ',' << s.gpuAvg << ',' << s.gpuP99 << '\n';
+    }
+    std::cout << "[FrameProfiler] Wrote " << path << std::endl;
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Renderer passes timed by FrameProfiler, in frame order
+enum class FramePass {
+    Cull,
+    Maze,
+    Furniture,
+    Decorations,
+    Ghost,
+    UI,
+    Swap,
+    Count
+};
+
+// CPU and GPU time per render pass.
+// GPU time comes from GL_TIME_ELAPSED queries kept in a ring and read back QUERY_LATENCY
+// frames later; a result that is still not ready is dropped rather than waited for, so
+// profiling never stalls the pipeline. Passes must not nest.
+class FrameProfiler {
+public:
+    static const int PASS_COUNT = static_cast<int>(FramePass::Count);
+    static const int QUERY_LATENCY = 4;    // Frames between issuing a query and reading it
+    static const int HISTORY_FRAMES = 240; // Samples per pass kept for the statistics
+
+    // Milliseconds over the recorded history (zero when there are no samples)
+    struct PassStats {
+        int cpuSamples;
+        float cpuMin, cpuAvg, cpuP99;
+        int gpuSamples;
+        float gpuMin, gpuAvg, gpuP99;
+    };
+
+    // Times one pass for the lifetime of the object
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, FramePass pass) : profiler(profiler), pass(pass) { profiler.beginPass(pass); }
+        ~Scope() { profiler.endPass(pass); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        FrameProfiler& profiler;
+        FramePass pass;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Create the query ring; without timer query support only CPU times are recorded
+    void initialize();
+    void release();
+
+    // Bracket every frame; beginFrame collects the queries of the ring slot it is about to reuse
+    void beginFrame();
+    void endFrame();
+
+    void beginPass(FramePass pass);
+    void endPass(FramePass pass);
+
+    PassStats getStats(FramePass pass) const;
+    static const char* getPassName(FramePass pass);
+    bool hasGpuTimers() const { return gpuTimers; }
+
+    // One row per pass: samples and min/avg/p99 for CPU and GPU. Returns false if the file cannot be written.
+    bool dumpCsv(const std::string& path) const;
+
+    void toggleOverlay() { overlayVisible = !overlayVisible; }
+    bool isOverlayVisible() const { return overlayVisible; }
+
+private:
+    // Fixed-size ring of the most recent samples of one pass
+    struct History {
+        float samples[HISTORY_FRAMES];
+        int count;
+        int next;
+        void push(float value);
+    };
+
+    bool gpuTimers;
+    bool overlayVisible;
+    int frameSlot;
+    int activeGpuPass; // -1 if no query is open
+    GLuint queries[QUERY_LATENCY][PASS_COUNT];
+    bool queryIssued[QUERY_LATENCY][PASS_COUNT];
+    std::chrono::steady_clock::time_point passStart[PASS_COUNT];
+    History cpuHistory[PASS_COUNT];
+    History gpuHistory[PASS_COUNT];
+
+    static void summarize(const History& history, int& samples, float& minimum, float& average, float& p99);
+};
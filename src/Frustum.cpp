@@ -0,0 +1,56 @@
+#include "Frustum.h"
+#define _USE_MATH_DEFINES // For M_PI
+#include <math.h>
+
+namespace {
+    float dot3(float ax, float ay, float az, float bx, float by, float bz) {
+        return ax * bx + ay * by + az * bz;
+    }
+}
+
+Frustum::Frustum() : planes{} {}
+
+void Frustum::setFromCamera(float eyeX, float eyeY, float eyeZ, float yaw, float pitch,
+                            float fovYDegrees, float aspect, float zNear, float zFar) {
+    // Forward vector matches Camera::applyViewMatrix
+    const float fx = sinf(yaw) * cosf(pitch);
+    const float fy = sinf(pitch);
+    const float fz = -cosf(yaw) * cosf(pitch);
+
+    // Right = forward x worldUp, then the true up = right x forward
+    float rx = -fz, ry = 0.0f, rz = fx;
+    const float rLen = sqrtf(rx * rx + rz * rz);
+    if (rLen > 0.0f) { rx /= rLen; rz /= rLen; } else { rx = 1.0f; rz = 0.0f; }
+    const float ux = ry * fz - rz * fy;
+    const float uy = rz * fx - rx * fz;
+    const float uz = rx * fy - ry * fx;
+
+    const float tanV = tanf(fovYDegrees * 0.5f * static_cast<float>(M_PI) / 180.0f);
+    const float tanH = tanV * aspect;
+
+    // A point p is inside when |x_view| <= z_view * tanH etc., which gives these inward normals
+    auto setPlane = [&](Plane& p, float nx, float ny, float nz, float offset) {
+        p.nx = nx; p.ny = ny; p.nz = nz;
+        p.d = -dot3(nx, ny, nz, eyeX, eyeY, eyeZ) + offset;
+    };
+    setPlane(planes[0], fx, fy, fz, -zNear);
+    setPlane(planes[1], -fx, -fy, -fz, zFar);
+    setPlane(planes[2], rx + fx * tanH, ry + fy * tanH, rz + fz * tanH, 0.0f);
+    setPlane(planes[3], -rx + fx * tanH, -ry + fy * tanH, -rz + fz * tanH, 0.0f);
+    setPlane(planes[4], ux + fx * tanV, uy + fy * tanV, uz + fz * tanV, 0.0f);
+    setPlane(planes[5], -ux + fx * tanV, -uy + fy * tanV, -uz + fz * tanV, 0.0f);
+}
+
+bool Frustum::intersectsBox(float minX, float minY, float minZ,
+                            float maxX, float maxY, float maxZ) const {
+    for (const Plane& p : planes) {
+        // Test the box corner furthest along the plane normal
+        const float x = p.nx >= 0.0f ? maxX : minX;
+        const float y = p.ny >= 0.0f ? maxY : minY;
+        const float z = p.nz >= 0.0f ? maxZ : minZ;
+        if (dot3(p.nx, p.ny, p.nz, x, y, z) + p.d < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
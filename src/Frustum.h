@@ -0,0 +1,25 @@
+#pragma once
+
+// View frustum in world space, built directly from the camera parameters so culling
+// never has to read matrices back from OpenGL.
+class Frustum {
+public:
+    Frustum();
+
+    // Rebuild the six planes from the eye position, yaw/pitch (radians, same convention as Camera)
+    // and the perspective projection (vertical field of view in degrees)
+    void setFromCamera(float eyeX, float eyeY, float eyeZ, float yaw, float pitch,
+                       float fovYDegrees, float aspect, float zNear, float zFar);
+
+    // Returns false only if the axis-aligned box lies completely outside one of the planes
+    bool intersectsBox(float minX, float minY, float minZ,
+                       float maxX, float maxY, float maxZ) const;
+
+private:
+    // Plane equation nx*x + ny*y + nz*z + d >= 0 for points inside
+    struct Plane {
+        float nx, ny, nz, d;
+    };
+
+    Plane planes[6]; // Near, far, left, right, bottom, top
+};
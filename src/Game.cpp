@@ -1,264 +1,845 @@
-#include "Game.h"
-#include <GL/glew.h> // Must be included before freeglut
-#include <GL/freeglut.h>
-#include <iostream>
-#include <cmath> // For distance calculation
-
-// Initialize static instance pointer
-Game* Game::instance = nullptr;
-
-Game::Game() :
-    isRunning(false),
-    gameWon(false),
-    hasKey(false),
-    playerStartX(1.5f), // Default, will be updated from maze
-    playerStartZ(1.5f),
-    keyX(0.0f), keyZ(0.0f), // Will be placed during load
-    keyVisible(true),
-    lastUpdateTime(0),
-    maze(), // Initialize maze
-    ghost(maze) // Initialize ghost, passing maze reference
-    // textureManager is default constructed
-    // camera is default constructed
-    // audioManager is default constructed
-{
-    if (instance == nullptr) {
-        instance = this;
-    } else {
-        // Handle error: Trying to create multiple Game instances
-        std::cerr << "Error: Multiple Game instances requested." << std::endl;
-        // Consider throwing an exception or exiting
-    }
-}
-
-Game::~Game() {
-    audioManager.shutdown();
-    if (instance == this) {
-        instance = nullptr;
-    }
-}
-
-bool Game::initialize(int argc, char** argv) {
-    std::cout << "Initializing Game..." << std::endl;
-
-    // Initialize GLUT
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
-    glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
-    glutInitWindowPosition(100, 100);
-    glutCreateWindow("AI Haunted House");
-
-    // Initialize Renderer (which initializes GLEW and Textures)
-    renderer = std::make_unique<Renderer>(textureManager);
-    if (!renderer->initialize()) {
-        std::cerr << "Renderer initialization failed." << std::endl;
-        return false;
-    }
-
-    // Initialize Input Handler
-    inputHandler = std::make_unique<InputHandler>(*this, camera);
-    inputHandler->registerCallbacks(); // Register GLUT input callbacks AFTER window creation
-
-    // Initialize Audio Manager
-    if (!audioManager.initialize()) {
-        std::cerr << "Audio Manager initialization failed." << std::endl;
-        // Continue without audio? Or return false?
-    }
-
-    // Load game data (maze, player start, key position)
-    loadGameData();
-
-    // Set initial camera position based on maze start
-    camera.setPosition(playerStartX, PLAYER_EYE_HEIGHT, playerStartZ);
-
-    // Register other GLUT callbacks using static wrappers
-    glutDisplayFunc(displayCallback);
-    glutReshapeFunc(reshapeCallback);
-
-    // Get initial time for update loop
-    lastUpdateTime = glutGet(GLUT_ELAPSED_TIME);
-
-    // Setup timers for update loop, flickering, ghost
-    setupTimers();
-
-    // Start background ambient sound
-    audioManager.loadSound(SOUND_AMBIENT); // Ensure it's loaded
-    audioManager.playAmbientSound(SOUND_AMBIENT, true);
-
-    isRunning = true;
-    std::cout << "Game Initialization Complete." << std::endl;
-    return true;
-}
-
-void Game::loadGameData() {
-    // Get player start position from maze
-    int startR, startC;
-    maze.getStartPosition(startR, startC);
-    playerStartX = static_cast<float>(startC) + 0.5f;
-    playerStartZ = static_cast<float>(startR) + 0.5f;
-
-    // Place the key at a specific location (example: near the middle)
-    // Could be randomized or read from level data
-    int keyR = MAZE_SIZE / 2;
-    int keyC = MAZE_SIZE / 3;
-    // Ensure key is not placed inside a wall
-    while (maze.isWall(keyR, keyC)) {
-        keyR = rand() % MAZE_SIZE;
-        keyC = rand() % MAZE_SIZE;
-    }
-    keyX = static_cast<float>(keyC) + 0.5f;
-    keyZ = static_cast<float>(keyR) + 0.5f;
-    keyVisible = true;
-    hasKey = false; // Reset key status
-    gameWon = false; // Reset win status
-
-    std::cout << "Player Start: (" << playerStartX << ", " << playerStartZ << ")" << std::endl;
-    std::cout << "Key Position: (" << keyX << ", " << keyZ << ")" << std::endl;
-}
-
-void Game::run() {
-    if (!isRunning) {
-        std::cerr << "Game not initialized. Call initialize() first." << std::endl;
-        return;
-    }
-    std::cout << "Starting Game Loop..." << std::endl;
-    glutMainLoop(); // Start the GLUT event processing loop
-}
-
-void Game::setupTimers() {
-    // Main update loop timer (e.g., aiming for ~60 FPS)
-    int updateInterval = 1000 / 60; // milliseconds
-    glutTimerFunc(updateInterval, timerCallback, 0);
-
-    // Light flicker timer
-    glutTimerFunc(FLICKER_INTERVAL, flickerTimerCallback, 0);
-
-    // Initial ghost appearance timer (random delay)
-    int ghostDelay = rand() % (GHOST_APPEAR_INTERVAL_MAX - GHOST_APPEAR_INTERVAL_MIN + 1) + GHOST_APPEAR_INTERVAL_MIN;
-    glutTimerFunc(ghostDelay, ghostTimerCallback, 0);
-}
-
-// --- GLUT Callback Wrappers ---
-
-void Game::displayCallback() {
-    if (instance) {
-        instance->render();
-    }
-}
-
-void Game::reshapeCallback(int width, int height) {
-    if (instance) {
-        instance->reshape(width, height);
-    }
-}
-
-void Game::timerCallback(int value) {
-    if (instance && instance->isRunning) {
-        instance->update(value);
-        // Re-register the timer for the next update cycle
-        int updateInterval = 1000 / 60;
-        glutTimerFunc(updateInterval, timerCallback, 0); // Pass 0 as value
-    }
-}
-
-void Game::flickerTimerCallback(int value) {
-    if (instance && instance->isRunning) {
-        instance->flickerLight(value);
-        // Re-register the timer
-        glutTimerFunc(FLICKER_INTERVAL, flickerTimerCallback, 0);
-    }
-}
-
-void Game::ghostTimerCallback(int value) {
-    if (instance && instance->isRunning) {
-        instance->triggerGhostAppearance(value);
-        // Re-register the timer for the *next* possible appearance check
-        int nextCheckDelay = rand() % (GHOST_APPEAR_INTERVAL_MAX - GHOST_APPEAR_INTERVAL_MIN + 1) + GHOST_APPEAR_INTERVAL_MIN;
-        glutTimerFunc(nextCheckDelay, ghostTimerCallback, 0);
-    }
-}
-
-// --- Update and Render ---
-
-void Game::update(int value) {
-    if (gameWon) return; // Stop updates if game is won
-
-    int currentTime = glutGet(GLUT_ELAPSED_TIME);
-    float deltaTime = static_cast<float>(currentTime - lastUpdateTime) / 1000.0f; // Delta time in seconds
-    lastUpdateTime = currentTime;
-
-    // Process held keys for movement
-    inputHandler->processHeldKeys(deltaTime);
-
-    // Store camera position before collision detection
-    float oldCamX = camera.getX();
-    float oldCamZ = camera.getZ();
-
-    // Update ghost logic
-    ghost.update(deltaTime, camera);
-
-    // Check collisions (player vs maze, key, exit)
-    checkCollisions();
-
-    // If collision occurred, revert camera position (simple wall collision)
-    // More sophisticated collision response (sliding) would be better.
-    int currentR = static_cast<int>(camera.getZ());
-    int currentC = static_cast<int>(camera.getX());
-    if (maze.isWall(currentR, currentC)) {
-        // Check which direction caused collision and revert only that axis?
-        // Simpler: revert both for now
-        camera.setPosition(oldCamX, camera.getY(), oldCamZ);
-        // Optionally play a bump sound
-        // audioManager.playSound("sounds/bump.wav");
-    }
-
-    // Force redraw
-    glutPostRedisplay();
-}
-
-void Game::render() {
-    if (!renderer) return;
-
-    renderer->beginFrame(camera);
-
-    // Draw scene elements
-    renderer->drawMaze(maze);
-    renderer->drawFurniture();
-    renderer->drawDecorations();
-
-    // Draw the key if it's visible
-    if (keyVisible) {
-        // Draw a simple representation for the key (e.g., a small yellow cube/sphere)
-        glPushMatrix();
-        glTranslatef(keyX, 0.3f, keyZ); // Position slightly above floor
-        glDisable(GL_TEXTURE_2D); // Use color for key
-        glDisable(GL_LIGHTING);   // Make key bright
-        glColor3f(1.0f, 1.0f, 0.0f); // Yellow
-        glutSolidCube(0.15f); // Small cube
-        glColor3f(1.0f, 1.0f, 1.0f); // Reset color
-        if (renderer->setLight) glEnable(GL_LIGHTING); // Re-enable lighting if it was on
-        glEnable(GL_TEXTURE_2D);
-        glPopMatrix();
-    }
-
-    // Draw the ghost
-    renderer->drawGhost(ghost);
-
-    // Draw UI elements (on top)
-    renderer->drawHUD();
-
-    // End frame (swap buffers)
-    glutSwapBuffers();
-}
-
-void Game::flickerLight(int value) {
-    // Randomly flicker light intensity or turn it off completely for short periods
-    // E.g., dim lights
-    renderer->flickerLights();
-}
-
-void Game::triggerGhostAppearance(int value) {
-    // Make ghost appear at a random location in the maze
-    // If the ghost is not already visible, spawn it
-    ghost.spawnRandom();
-}
+#include "Game.h"
+#include "AllocationCounter.h"
+#include "MazeGenerator.h"
+#include "Trace.h"
+#include <GL/glew.h> // Must be included before freeglut
+#include <GL/freeglut.h>
+#include <algorithm>
+#include <iostream>
+#include <cmath> // For distance calculation
+#include <cstring>
+#include <string>
+
+namespace {
+    // Random stream of each subsystem; changing one reshuffles only that subsystem
+    const std::uint64_t STREAM_LAYOUT = 1;
+    const std::uint64_t STREAM_TIMERS = 2;
+    const std::uint64_t STREAM_GHOST = 3;
+    const std::uint64_t STREAM_SWARM = 4;
+    const std::uint64_t STREAM_FLICKER = 5;
+
+    // Simulation steps covering ms milliseconds, at least one
+    int ticksFromMilliseconds(int ms) {
+        return std::max(1, (ms * SIMULATION_STEP_HZ + 500) / 1000);
+    }
+
+    // Random wait between ghost appearance checks, in milliseconds
+    int randomAppearDelay(Random& random) {
+        return random.between(GHOST_APPEAR_INTERVAL_MIN, GHOST_APPEAR_INTERVAL_MAX);
+    }
+
+    // FNV-1a over the bits of each value, for simulation checksums
+    void mixChecksum(std::uint64_t& hash, std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001B3ULL;
+        }
+    }
+
+    void mixChecksum(std::uint64_t& hash, float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mixChecksum(hash, bits);
+    }
+}
+
+// Initialize static instance pointer
+Game* Game::instance = nullptr;
+
+Game::Game() :
+    isRunning(false),
+    bakeOnly(false),
+    headlessTicks(0),
+    gameSeed(0),
+    deterministic(false),
+    replaying(false),
+    replayDiverged(false),
+    replayMatches(0),
+    simulationTick(0),
+    swarmSize(0),
+    gameWon(false),
+    hasKey(false),
+    keyVisible(true),
+    playerStartX(1.5f), // Default, will be updated from maze
+    playerStartZ(1.5f),
+    keyX(0.0f), keyZ(0.0f), // Will be placed during load
+    keyEntity(-1),
+    ghostEntity(-1),
+    ghostTouching(false),
+    maze(), // Initialize maze
+    pathHierarchy(maze),
+    pathfinder(maze),
+    pathHierarchyDirty(false),
+    ghost(maze, pathfinder), // Initialize ghost, passing maze and pathfinder references
+    ghostSwarm(maze),
+    jobs(JOB_WORKER_THREADS),
+    stepAccumulator(0.0),
+    renderAlpha(1.0f),
+    previousCamX(0.0f), previousCamY(0.0f), previousCamZ(0.0f),
+    flickerTicks(0),
+    lightOn(true),
+    ghostAppearTicks(0)
+    // textureManager is default constructed
+    // camera is default constructed
+    // audioManager is default constructed
+{
+    if (instance == nullptr) {
+        instance = this;
+    } else {
+        // Handle error: Trying to create multiple Game instances
+        std::cerr << "Error: Multiple Game instances requested." << std::endl;
+        // Consider throwing an exception or exiting
+    }
+}
+
+Game::~Game() {
+    audioManager.shutdown();
+    if (instance == this) {
+        instance = nullptr;
+    }
+}
+
+bool Game::initialize(int argc, char** argv) {
+    TRACE_THREAD_NAME("Main");
+    TRACE_SCOPE("Game::initialize");
+    std::cout << "Initializing Game..." << std::endl;
+
+    std::string mazeFile;
+    std::string generateSeed;
+    std::string swarmCount;
+    std::string headlessCount;
+    std::string scriptFile;
+    std::string seedText;
+    std::string recordFile;
+    std::string replayFile;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--bake-textures") {
+            bakeOnly = true;
+        } else if (arg == "--maze" && i + 1 < argc) {
+            mazeFile = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generateSeed = argv[++i];
+        } else if (arg == "--swarm" && i + 1 < argc) {
+            swarmCount = argv[++i];
+        } else if (arg == "--headless" && i + 1 < argc) {
+            headlessCount = argv[++i];
+        } else if (arg == "--script" && i + 1 < argc) {
+            scriptFile = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seedText = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        }
+    }
+
+    if (!generateSeed.empty()) {
+        try {
+            MazeGenerator generator;
+            generator.setBraid(MAZE_GENERATE_BRAID);
+            generator.setRooms(MAZE_GENERATE_ROOMS, MAZE_GENERATE_MAX_ROOM);
+            maze = generator.generate(MAZE_GENERATE_WIDTH, MAZE_GENERATE_HEIGHT, std::stoull(generateSeed));
+            std::cout << "Generated maze with seed " << generateSeed << " in "
+                      << generator.getGenerateMilliseconds() << " ms" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to generate maze from seed '" << generateSeed << "': " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    if (!swarmCount.empty()) {
+        try {
+            swarmSize = std::stoi(swarmCount);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid swarm size '" << swarmCount << "': " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    if (!headlessCount.empty()) {
+        try {
+            headlessTicks = std::stoi(headlessCount);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid headless tick count '" << headlessCount << "': " << e.what() << std::endl;
+            return false;
+        }
+        if (headlessTicks < 1) {
+            std::cerr << "--headless needs at least one tick" << std::endl;
+            return false;
+        }
+    }
+
+    // Map the level before opening a window so a bad file fails fast
+    if (!mazeFile.empty() && !maze.loadFromFile(mazeFile)) {
+        std::cerr << "Failed to load maze " << mazeFile << std::endl;
+        return false;
+    }
+    if (!mazeFile.empty()) {
+        std::cout << "Mapped maze " << mazeFile << " (" << maze.getWidth() << "x" << maze.getHeight() << ")" << std::endl;
+    }
+
+    if (!replayFile.empty()) {
+        if (!scriptFile.empty() || !recordFile.empty()) {
+            std::cerr << "--replay cannot be combined with --script or --record" << std::endl;
+            return false;
+        }
+        if (!recording.loadFromFile(replayFile)) {
+            return false;
+        }
+        const RecordingHeader& header = recording.getHeader();
+        if (header.mazeWidth != maze.getWidth() || header.mazeHeight != maze.getHeight()) {
+            std::cerr << replayFile << " was recorded on a " << header.mazeWidth << "x" << header.mazeHeight
+                      << " maze; pass the same --maze or --generate option" << std::endl;
+            return false;
+        }
+        if (header.mazeHash != maze.contentHash()) {
+            std::cerr << replayFile << " was recorded on a different " << header.mazeWidth << "x" << header.mazeHeight
+                      << " maze; pass the same --maze or --generate option" << std::endl;
+            return false;
+        }
+        // The recording decides everything the simulation depends on; it always replays headless
+        gameSeed = header.seed;
+        swarmSize = header.swarmSize;
+        if (headlessTicks == 0) headlessTicks = recording.getLastTick() + 1;
+        inputScript.setEvents(recording.getEvents());
+        replaying = true;
+        std::cout << "Replaying " << replayFile << ": " << recording.getEvents().size() << " events over "
+                  << recording.getLastTick() + 1 << " ticks" << std::endl;
+    } else if (!seedText.empty()) {
+        try {
+            gameSeed = std::stoull(seedText);
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid seed '" << seedText << "': " << e.what() << std::endl;
+            return false;
+        }
+    } else {
+        std::uint64_t clock = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+        gameSeed = Random::splitMix64(clock);
+    }
+    std::cout << "Game seed: " << gameSeed << " (repeat with --seed " << gameSeed << ")" << std::endl;
+    layoutRandom.reseed(gameSeed, STREAM_LAYOUT);
+    timerRandom.reseed(gameSeed, STREAM_TIMERS);
+    flickerRandom.reseed(gameSeed, STREAM_FLICKER);
+    deterministic = replaying || !recordFile.empty();
+
+    if (headlessTicks > 0) {
+        // Simulation only: no window, GL context or audio device. Input comes from the
+        // script, fed to an InputHandler that never registers GLUT callbacks.
+        if (!scriptFile.empty()) {
+            if (!inputScript.loadFromFile(scriptFile)) {
+                return false;
+            }
+            std::cout << "Input script " << scriptFile << ": " << inputScript.getEventCount() << " events" << std::endl;
+        }
+        inputHandler = std::make_unique<InputHandler>(*this, camera);
+        loadGameData();
+        setupSimulation();
+        if (!recordFile.empty() && !startRecording(recordFile)) {
+            return false;
+        }
+        isRunning = true;
+        std::cout << "Headless Initialization Complete." << std::endl;
+        return true;
+    }
+
+    // Initialize GLUT
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
+    glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow("AI Haunted House");
+
+    // Initialize Renderer (which initializes GLEW and Textures)
+    renderer = std::make_unique<Renderer>(textureManager);
+    if (!renderer->initialize()) {
+        std::cerr << "Renderer initialization failed." << std::endl;
+        return false;
+    }
+
+    if (bakeOnly) {
+        // Let the streaming load settle so nothing reads a cache file while it is rewritten
+        try {
+            textureManager.finishLoading();
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+        const int baked = textureManager.bakeTextureCache();
+        std::cout << "Baked " << baked << " texture cache files." << std::endl;
+        return true;
+    }
+
+    // Initialize Input Handler
+    inputHandler = std::make_unique<InputHandler>(*this, camera);
+    inputHandler->registerCallbacks(); // Register GLUT input callbacks AFTER window creation
+
+    // Initialize Audio Manager
+    if (!audioManager.initialize()) {
+        std::cerr << "Audio Manager initialization failed." << std::endl;
+        // Continue without audio? Or return false?
+    }
+
+    // Load game data (maze, player start, key position)
+    loadGameData();
+
+    // Bake the static maze geometry and visibility once for this layout
+    renderer->buildMazeMesh(maze);
+    if (mazePVS.build(maze, renderer->getCullDistance())) {
+        renderer->setVisibilitySet(&mazePVS);
+        std::cout << "PVS precompute: " << mazePVS.getBuildMilliseconds() << " ms ("
+                  << mazePVS.getMemoryBytes() / 1024 << " KB)" << std::endl;
+    }
+    setupSimulation();
+    if (!recordFile.empty() && !startRecording(recordFile)) {
+        return false;
+    }
+
+    // Register other GLUT callbacks using static wrappers
+    glutDisplayFunc(displayCallback);
+    glutReshapeFunc(reshapeCallback);
+
+    // Setup the main loop
+    setupTimers();
+
+    // Start background ambient sound
+    const unsigned int ambientSound = audioManager.loadSound(SOUND_AMBIENT);
+    audioManager.playAmbientSound(ambientSound, true);
+
+    isRunning = true;
+    std::cout << "Game Initialization Complete." << std::endl;
+    return true;
+}
+
+void Game::loadGameData() {
+    TRACE_SCOPE("Game::loadGameData");
+    // Get player start position from maze
+    int startR, startC;
+    maze.getStartPosition(startR, startC);
+    playerStartX = static_cast<float>(startC) + 0.5f;
+    playerStartZ = static_cast<float>(startR) + 0.5f;
+    playerField.invalidate(); // New layout: rebuild the chase field on the next update
+
+    // Use the level's key placement if it has one, otherwise pick a spot near the middle
+    int keyR = maze.getHeight() / 2;
+    int keyC = maze.getWidth() / 3;
+    maze.getKeyPosition(keyR, keyC);
+    // Ensure key is not placed inside a wall
+    while (maze.isWall(keyR, keyC)) {
+        keyR = layoutRandom.below(maze.getHeight());
+        keyC = layoutRandom.below(maze.getWidth());
+    }
+    keyX = static_cast<float>(keyC) + 0.5f;
+    keyZ = static_cast<float>(keyR) + 0.5f;
+    keyVisible = true;
+    hasKey = false; // Reset key status
+    gameWon = false; // Reset win status
+
+    int endR, endC;
+    maze.getEndPosition(endR, endC);
+    entities.reset(maze.getWidth(), maze.getHeight());
+    keyEntity = entities.insert(keyX, keyZ, static_cast<std::uint32_t>(EntityTag::Key));
+    entities.insert(static_cast<float>(endC) + 0.5f, static_cast<float>(endR) + 0.5f, static_cast<std::uint32_t>(EntityTag::Exit));
+
+    placeProps();
+
+    std::cout << "Player Start: (" << playerStartX << ", " << playerStartZ << ")" << std::endl;
+    std::cout << "Key Position: (" << keyX << ", " << keyZ << ")" << std::endl;
+}
+
+void Game::placeProps() {
+    // Scatter furniture through the open cells. A hash of the cell picks the prop and its
+    // facing, so the same maze always gets the same layout. Props also block the player, so
+    // they are placed in headless runs too and only drawing is skipped there.
+    if (renderer) renderer->clearProps();
+    const int startR = static_cast<int>(playerStartZ), startC = static_cast<int>(playerStartX);
+    const int keyR = static_cast<int>(keyZ), keyC = static_cast<int>(keyX);
+    int endR, endC;
+    maze.getEndPosition(endR, endC);
+    int placed = 0;
+
+    for (int r = 0; r < maze.getHeight(); ++r) {
+        for (int c = 0; c < maze.getWidth(); ++c) {
+            if (maze.isWall(r, c) || (r == startR && c == startC) || (r == keyR && c == keyC) ||
+                (r == endR && c == endC)) {
+                continue;
+            }
+
+            // Mix further than the wall textures need: the percentage below uses the low bits
+            unsigned int h = Maze::cellHash(r, c);
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+
+            PropType type;
+            switch (h % 100) {
+                case 0: case 1: case 2: case 3: case 4: case 5:
+                    type = PropType::Chair;
+                    break;
+                case 6: case 7: case 8:
+                    type = PropType::Table;
+                    break;
+                case 9: case 10:
+                    type = PropType::Mannequin;
+                    break;
+                case 11:
+                    type = PropType::Mirror;
+                    break;
+                default:
+                    continue;
+            }
+            const float yaw = static_cast<float>((h >> 8) & 3) * 1.5707963f;
+            const float x = static_cast<float>(c) + 0.5f, z = static_cast<float>(r) + 0.5f;
+            entities.insert(x, z, static_cast<std::uint32_t>(EntityTag::Prop));
+            if (renderer) renderer->addProp(type, x, z, yaw);
+            ++placed;
+        }
+    }
+    std::cout << "Placed " << placed << " props." << std::endl;
+}
+
+void Game::run() {
+    if (bakeOnly) {
+        return;
+    }
+    if (!isRunning) {
+        std::cerr << "Game not initialized. Call initialize() first." << std::endl;
+        return;
+    }
+    if (headlessTicks > 0) {
+        runHeadless();
+        return;
+    }
+    std::cout << "Starting Game Loop..." << std::endl;
+    glutMainLoop(); // Start the GLUT event processing loop
+}
+
+void Game::setupSimulation() {
+    TRACE_SCOPE("Game::setupSimulation");
+    std::cout << "Job system: " << jobs.getThreadCount() << " threads" << std::endl;
+    ghost.reseed(Random(gameSeed, STREAM_GHOST).next64());
+    ghostSwarm.setSeed(Random(gameSeed, STREAM_SWARM).next64());
+    ghostSwarm.resize(swarmSize);
+    registerGhosts();
+    if (swarmSize > 0) {
+        std::cout << "Ghost swarm: " << swarmSize << " ghosts ("
+                  << (GhostSystem::isVectorized() ? "SSE2" : "scalar") << " update)" << std::endl;
+    }
+    pathHierarchy.build();
+    pathfinder.setHierarchy(&pathHierarchy);
+    std::cout << "Path hierarchy: " << pathHierarchy.getBuildMilliseconds() << " ms ("
+              << pathHierarchy.getNodeCount() << " nodes in " << pathHierarchy.getClusterCount()
+              << " clusters)" << std::endl;
+
+    // Set initial camera position based on maze start
+    camera.setPosition(playerStartX, PLAYER_EYE_HEIGHT, playerStartZ);
+    previousCamX = camera.getX();
+    previousCamY = camera.getY();
+    previousCamZ = camera.getZ();
+
+    // Light flicker and ghost appearance count simulation steps, so they keep pace with it
+    flickerTicks = ticksFromMilliseconds(FLICKER_INTERVAL);
+    ghostAppearTicks = ticksFromMilliseconds(randomAppearDelay(timerRandom));
+    simulationTick = 0;
+}
+
+bool Game::startRecording(const std::string& path) {
+    const RecordingHeader header = { gameSeed, swarmSize, maze.getWidth(), maze.getHeight(), maze.contentHash() };
+    if (!recording.startRecording(path, header)) {
+        return false;
+    }
+    inputHandler->setRecording(&recording);
+    std::cout << "Recording input to " << path << std::endl;
+    return true;
+}
+
+void Game::setupTimers() {
+    // The simulation runs in fixed steps from the idle callback; see advanceFrame()
+    glutIdleFunc(idleCallback);
+    lastFrameTime = std::chrono::steady_clock::now();
+    stepAccumulator = 0.0;
+}
+
+void Game::runHeadless() {
+    std::cout << "Running " << headlessTicks << " headless ticks..." << std::endl;
+    const float stepSeconds = 1.0f / SIMULATION_STEP_HZ;
+    const std::uint64_t startAllocations = AllocationCounter::getAllocations();
+    const std::uint64_t startBytes = AllocationCounter::getBytes();
+    const auto start = std::chrono::steady_clock::now();
+
+    // Progress lines for long soak runs: rate and allocations since the previous line
+    auto reportTime = start;
+    std::uint64_t reportAllocations = startAllocations;
+    int reportTick = 0;
+
+    int tick = 0;
+    for (; tick < headlessTicks && isRunning && !gameWon; ++tick) {
+        inputScript.dispatch(simulationTick, *inputHandler);
+        update(stepSeconds);
+
+        const auto now = std::chrono::steady_clock::now();
+        const double sinceReport = std::chrono::duration<double>(now - reportTime).count();
+        if (sinceReport >= HEADLESS_REPORT_SECONDS) {
+            const std::uint64_t allocations = AllocationCounter::getAllocations();
+            std::cout << "[Headless] tick " << tick + 1 << ": " << (tick + 1 - reportTick) / sinceReport
+                      << " ticks/s, " << allocations - reportAllocations << " allocations" << std::endl;
+            reportTime = now;
+            reportAllocations = allocations;
+            reportTick = tick + 1;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const std::uint64_t allocations = AllocationCounter::getAllocations() - startAllocations;
+    const std::uint64_t bytes = AllocationCounter::getBytes() - startBytes;
+    std::cout << "Headless run: " << tick << " ticks in " << seconds << " s ("
+              << (seconds > 0.0 ? tick / seconds : 0.0) << " ticks/s, "
+              << tick / static_cast<double>(SIMULATION_STEP_HZ) << " s simulated)" << std::endl;
+    std::cout << "Allocations: " << allocations << " (" << bytes / 1024 << " KB), "
+              << (tick > 0 ? static_cast<double>(allocations) / tick : 0.0) << " per tick" << std::endl;
+    if (gameWon) {
+        std::cout << "Stopped early: the player escaped on tick " << tick << std::endl;
+    }
+    if (replaying) {
+        std::cout << "Replay " << (replayDiverged ? "diverged" : "matched") << ": " << replayMatches
+                  << " checkpoints matched" << std::endl;
+    }
+    if (Trace::isEnabled()) {
+        dumpTrace();
+    }
+}
+
+void Game::checkpoint() {
+    if (!recording.isRecording() && !replaying) return;
+    const std::uint64_t checksum = simulationChecksum();
+    if (recording.isRecording()) {
+        recording.recordCheckpoint(simulationTick, checksum);
+        return;
+    }
+    const CheckpointResult result = recording.checkCheckpoint(simulationTick, checksum);
+    if (result == CheckpointResult::Match) {
+        ++replayMatches;
+    } else if (result == CheckpointResult::Mismatch && !replayDiverged) {
+        replayDiverged = true;
+        std::cerr << "Replay diverged from the recording by tick " << simulationTick << std::endl;
+    }
+}
+
+std::uint64_t Game::simulationChecksum() const {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    mixChecksum(hash, camera.getX());
+    mixChecksum(hash, camera.getY());
+    mixChecksum(hash, camera.getZ());
+    mixChecksum(hash, camera.getAngleX());
+    mixChecksum(hash, camera.getAngleY());
+    mixChecksum(hash, ghost.getX());
+    mixChecksum(hash, ghost.getZ());
+    mixChecksum(hash, static_cast<std::uint32_t>(ghost.isVisible()));
+    for (int i = 0; i < ghostSwarm.getCount(); ++i) {
+        mixChecksum(hash, ghostSwarm.getX(i));
+        mixChecksum(hash, ghostSwarm.getZ(i));
+        mixChecksum(hash, static_cast<std::uint32_t>(ghostSwarm.isVisible(i)));
+    }
+    mixChecksum(hash, static_cast<std::uint32_t>(hasKey) | static_cast<std::uint32_t>(gameWon) << 1);
+    return hash;
+}
+
+// --- GLUT Callback Wrappers ---
+
+void Game::displayCallback() {
+    if (instance) {
+        instance->render();
+    }
+}
+
+void Game::reshapeCallback(int width, int height) {
+    if (instance) {
+        instance->reshape(width, height);
+    }
+}
+
+void Game::idleCallback() {
+    if (instance && instance->isRunning) {
+        instance->advanceFrame();
+    }
+}
+
+// --- Update and Render ---
+
+void Game::advanceFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    const double frameSeconds = std::chrono::duration<double>(now - lastFrameTime).count();
+    lastFrameTime = now;
+    stepAccumulator += std::min(frameSeconds, MAX_FRAME_SECONDS);
+
+    // Run every step that is due, but never more than MAX_CATCH_UP_STEPS: a slow machine then
+    // runs the game slower instead of spending each frame catching up on the last one
+    const double stepSeconds = 1.0 / SIMULATION_STEP_HZ;
+    int steps = 0;
+    while (stepAccumulator >= stepSeconds && steps < MAX_CATCH_UP_STEPS) {
+        update(static_cast<float>(stepSeconds));
+        stepAccumulator -= stepSeconds;
+        ++steps;
+    }
+    if (steps == MAX_CATCH_UP_STEPS) {
+        stepAccumulator = std::min(stepAccumulator, stepSeconds);
+    }
+    renderAlpha = static_cast<float>(stepAccumulator / stepSeconds);
+    if (renderAlpha > 1.0f) renderAlpha = 1.0f;
+
+    glutPostRedisplay();
+}
+
+void Game::update(float deltaTime) {
+    if (gameWon) return; // Stop updates if game is won
+    TRACE_SCOPE("Game::update");
+
+    // Rendering interpolates from here to where this step leaves the camera
+    previousCamX = camera.getX();
+    previousCamY = camera.getY();
+    previousCamZ = camera.getZ();
+
+    // Process held keys for movement
+    inputHandler->processHeldKeys(deltaTime);
+
+    // Store camera position before collision detection
+    float oldCamX = camera.getX();
+    float oldCamZ = camera.getZ();
+
+    // Walls edited since the last step: refresh only the clusters around them
+    if (pathHierarchyDirty) {
+        pathHierarchy.rebuildDirty();
+        pathHierarchyDirty = false;
+    }
+
+    // Update ghost logic; the flow field only rebuilds when the player enters a new cell
+    playerField.update(maze, static_cast<int>(camera.getZ()), static_cast<int>(camera.getX()));
+    ghost.update(deltaTime, camera.getX(), camera.getZ(), playerField); // Talks to the pathfinder, so before its job
+
+    // Fan out the stages that only read the maze: path searches and the audio listener run as
+    // jobs while this thread helps with the swarm batches. GL calls stay on this thread.
+    JobCounter stages;
+    const auto searchPaths = [this]() {
+        TRACE_SCOPE("Pathfinder::update");
+        if (deterministic) {
+            pathfinder.updateExpansions(PATHFINDER_BUDGET_NODES);
+        } else {
+            pathfinder.update(PATHFINDER_BUDGET_MS);
+        }
+    };
+    const auto moveListener = [this]() {
+        const float pitch = camera.getAngleX(), yaw = camera.getAngleY();
+        audioManager.updateListenerPosition(camera.getX(), camera.getY(), camera.getZ(),
+                                            sin(yaw) * cos(pitch), sin(pitch), -cos(yaw) * cos(pitch));
+    };
+    jobs.run(stages, searchPaths);
+    if (headlessTicks == 0) {
+        jobs.run(stages, moveListener); // Headless runs have no audio device
+    }
+    ghostSwarm.update(deltaTime, camera.getX(), camera.getZ(), playerField, jobs);
+    jobs.wait(stages);
+    moveGhostEntities();
+
+    // Scare cue when the first swarm ghost gets a clear look at the player
+    const int sightings = ghostSwarm.getSightingCount();
+    ghostSwarm.updateSight(camera.getX(), camera.getZ(), GHOST_SIGHT_RANGE);
+    if (sightings == 0 && ghostSwarm.getSightingCount() > 0) {
+        std::cout << "Something is watching you..." << std::endl;
+    }
+
+    // Check collisions (player vs maze, key, exit)
+    checkCollisions();
+
+    // If collision occurred, revert camera position (simple wall collision)
+    // More sophisticated collision response (sliding) would be better.
+    int currentR = static_cast<int>(camera.getZ());
+    int currentC = static_cast<int>(camera.getX());
+    bool blocked = maze.isWall(currentR, currentC);
+    entities.forEachInRadius(camera.getX(), camera.getZ(), PROP_COLLISION_RADIUS, [&](int id) {
+        if (entities.getTag(id) != static_cast<std::uint32_t>(EntityTag::Prop)) return;
+        // Only block stepping into a prop, so a player already overlapping one can walk out
+        const float dx = oldCamX - entities.getX(id), dz = oldCamZ - entities.getZ(id);
+        blocked = blocked || dx * dx + dz * dz > PROP_COLLISION_RADIUS * PROP_COLLISION_RADIUS;
+    });
+    if (blocked) {
+        // Check which direction caused collision and revert only that axis?
+        // Simpler: revert both for now
+        camera.setPosition(oldCamX, camera.getY(), oldCamZ);
+        // Optionally play a bump sound
+        // audioManager.playSound("sounds/bump.wav");
+    }
+
+    if (--flickerTicks <= 0) {
+        flickerLight(0);
+        flickerTicks = ticksFromMilliseconds(FLICKER_INTERVAL);
+    }
+    if (--ghostAppearTicks <= 0) {
+        triggerGhostAppearance(0);
+        ghostAppearTicks = ticksFromMilliseconds(randomAppearDelay(timerRandom));
+    }
+
+    ++simulationTick;
+    if (simulationTick % RECORDING_CHECKPOINT_TICKS == 0) {
+        checkpoint();
+    }
+}
+
+void Game::checkCollisions() {
+    // Walking over the key picks it up; reaching the exit with it wins
+    bool touchedKey = false, atExit = false, touchedGhost = false;
+    entities.forEachInRadius(camera.getX(), camera.getZ(), TRIGGER_RADIUS, [&](int id) {
+        const std::uint32_t tag = entities.getTag(id);
+        touchedKey = touchedKey || tag == static_cast<std::uint32_t>(EntityTag::Key);
+        atExit = atExit || tag == static_cast<std::uint32_t>(EntityTag::Exit);
+        if (tag == static_cast<std::uint32_t>(EntityTag::Ghost)) {
+            touchedGhost = touchedGhost || ghost.isVisible();
+        } else if (tag >= static_cast<std::uint32_t>(EntityTag::SwarmGhost)) {
+            touchedGhost = touchedGhost || ghostSwarm.isVisible(static_cast<int>(tag - static_cast<std::uint32_t>(EntityTag::SwarmGhost)));
+        }
+    });
+    if (touchedKey) {
+        pickUpKey();
+    }
+    if (touchedGhost && !ghostTouching) {
+        std::cout << "A chill runs through you..." << std::endl;
+    }
+    ghostTouching = touchedGhost;
+    if (atExit && hasKey && !gameWon) {
+        gameWon = true;
+        std::cout << "You escaped the haunted house!" << std::endl;
+    }
+}
+
+void Game::interact() {
+    bool keyInReach = false;
+    entities.forEachInRadius(camera.getX(), camera.getZ(), INTERACT_RADIUS, [&](int id) {
+        keyInReach = keyInReach || static_cast<EntityTag>(entities.getTag(id)) == EntityTag::Key;
+    });
+    if (keyInReach) {
+        pickUpKey();
+    } else {
+        std::cout << "Nothing to interact with here." << std::endl;
+    }
+}
+
+void Game::setWall(int row, int col, bool wall) {
+    const std::uint64_t version = maze.getVersion();
+    maze.setWall(row, col, wall);
+    if (maze.getVersion() == version) return; // Outside the maze or already that way
+
+    pathHierarchy.markDirty(row, col);
+    pathHierarchyDirty = true;
+    mazePVS.rebuildAround(maze, row, col);
+    // The chase field and the maze mesh notice the new version by themselves
+}
+
+void Game::registerGhosts() {
+    // loadGameData() reset `entities`, so nothing of an earlier run is left to remove
+    ghostEntity = entities.insert(ghost.getX(), ghost.getZ(), static_cast<std::uint32_t>(EntityTag::Ghost));
+    swarmEntities.resize(ghostSwarm.getCount());
+    for (int i = 0; i < ghostSwarm.getCount(); ++i) {
+        swarmEntities[i] = entities.insert(ghostSwarm.getX(i), ghostSwarm.getZ(i),
+                                           static_cast<std::uint32_t>(EntityTag::SwarmGhost) + static_cast<std::uint32_t>(i));
+    }
+}
+
+void Game::moveGhostEntities() {
+    // move() only relinks a ghost that crossed into another bucket this step
+    entities.move(ghostEntity, ghost.getX(), ghost.getZ());
+    for (int i = 0; i < ghostSwarm.getCount(); ++i) {
+        entities.move(swarmEntities[i], ghostSwarm.getX(i), ghostSwarm.getZ(i));
+    }
+}
+
+void Game::pickUpKey() {
+    if (hasKey) return;
+    hasKey = true;
+    keyVisible = false;
+    entities.remove(keyEntity);
+    keyEntity = -1;
+    std::cout << "Picked up the key. Find the exit!" << std::endl;
+}
+
+void Game::render() {
+    if (!renderer) return;
+    TRACE_SCOPE("Game::render");
+
+    // Draw between the last two simulation steps, so motion is smooth at any refresh rate
+    Camera view = camera;
+    view.setPosition(previousCamX + (camera.getX() - previousCamX) * renderAlpha,
+                     previousCamY + (camera.getY() - previousCamY) * renderAlpha,
+                     previousCamZ + (camera.getZ() - previousCamZ) * renderAlpha);
+    renderer->beginFrame(view);
+    FrameProfiler& profiler = renderer->getProfiler();
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Cull);
+        renderer->cullScene(maze);
+    }
+
+    // Draw scene elements
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Maze);
+        renderer->drawMaze(maze);
+    }
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Furniture);
+        renderer->drawFurniture();
+    }
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Decorations);
+        renderer->drawDecorations();
+    }
+
+    // Draw the key if it's visible
+    if (keyVisible) {
+        renderer->drawKey(keyX, keyZ);
+    }
+
+    // Draw the ghost and the swarm
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Ghost);
+        renderer->drawGhost(ghost, renderAlpha);
+        renderer->drawGhostSwarm(ghostSwarm, renderAlpha);
+    }
+
+    // Draw UI elements (on top)
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::UI);
+        renderer->drawUI(gameWon, hasKey);
+    }
+
+    // End frame (swap buffers)
+    renderer->endFrame();
+}
+
+void Game::toggleProfilerOverlay() {
+    if (!renderer) return;
+    renderer->getProfiler().toggleOverlay();
+}
+
+void Game::dumpProfile() {
+    if (!renderer) return;
+    renderer->getProfiler().dumpCsv(PROFILE_CSV_PATH);
+}
+
+void Game::dumpTrace() {
+    Trace::writeChromeJson(TRACE_JSON_PATH);
+}
+
+void Game::toggleLight() {
+    lightOn = !lightOn;
+    if (renderer) renderer->setLight(lightOn, 1.0f);
+}
+
+void Game::flickerLight(int /*value*/) {
+    // Mostly a slight waver, now and then a deep dip; a switched-off light stays off
+    const float intensity = flickerRandom.chance(FLICKER_DIM_CHANCE)
+        ? FLICKER_DIM_INTENSITY
+        : FLICKER_MIN_INTENSITY + (1.0f - FLICKER_MIN_INTENSITY) * flickerRandom.below(101) / 100.0f;
+    if (renderer && lightOn) renderer->setLight(true, intensity);
+}
+
+void Game::triggerGhostAppearance(int /*value*/) {
+    // Make ghost appear at a random location in the maze
+    // If the ghost is not already visible, spawn it
+    ghost.appearRandomly();
+    ghostSwarm.appearRandomly(ghostSwarm.getCount());
+}
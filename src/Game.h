@@ -1,85 +1,153 @@
-#pragma once
-
-#include "Config.h"
-#include "Renderer.h"
-#include "TextureManager.h"
-#include "InputHandler.h"
-#include "Camera.h"
-#include "AudioManager.h"
-#include "Maze.h"
-#include "Ghost.h"
-#include <memory> // For unique_ptr
-
-// Main game class orchestrating all subsystems
-class Game {
-public:
-    Game();
-    ~Game();
-
-    // Initialize all game systems and GLUT
-    bool initialize(int argc, char** argv);
-
-    // Start the main game loop
-    void run();
-
-    // Called periodically by GLUT timer
-    void update(int value); // 'value' is unused here but required by glutTimerFunc
-
-    // Called by GLUT for rendering
-    void render();
-
-    // Called by GLUT for window resizing
-    void reshape(int width, int height);
-
-    // --- Game Logic Actions ---
-    void quitGame();
-    void toggleLight();
-    void interact(); // Player interaction (e.g., pick up key, open door)
-    void flickerLight(int value); // Timer callback for light flickering
-    void triggerGhostAppearance(int value); // Timer callback for ghost
-
-    // --- Getters for Callbacks ---
-    Camera& getCamera() { return camera; }
-    Renderer& getRenderer() { return *renderer; } // Return reference
-
-private:
-    // Game state
-    bool isRunning;
-    bool gameWon;
-    bool hasKey; // Does the player have the key?
-    bool keyVisible;
-    
-    // Player start position
-    float playerStartX, playerStartZ; // Initial position based on maze 'S'
-
-    // Key position (example, could be placed dynamically)
-    float keyX, keyZ;
-
-    // Core systems (using unique_ptr for automatic memory management)
-    TextureManager textureManager;
-    std::unique_ptr<Renderer> renderer;
-    std::unique_ptr<InputHandler> inputHandler;
-    Camera camera;
-    AudioManager audioManager;
-    Maze maze;
-    Ghost ghost;
-
-    // Timing
-    int lastUpdateTime; // For calculating deltaTime
-
-    // --- Static Wrappers for GLUT Callbacks ---
-    // These functions call the corresponding methods on the singleton instance.
-    static void displayCallback();
-    static void reshapeCallback(int width, int height);
-    static void timerCallback(int value); // For main update loop
-    static void flickerTimerCallback(int value); // For light flicker
-    static void ghostTimerCallback(int value); // For ghost appearance
-
-    // Singleton instance pointer (required for static GLUT callbacks)
-    static Game* instance;
-
-    // --- Private Helper Methods ---
-    void checkCollisions(); // Check player collision with walls, key, exit
-    void setupTimers();     // Initialize GLUT timers
-    void loadGameData();    // Load maze, place key, etc.
-};
+#pragma once
+
+#include "Config.h"
+#include "Renderer.h"
+#include "TextureManager.h"
+#include "InputHandler.h"
+#include "InputScript.h"
+#include "InputRecording.h"
+#include "Camera.h"
+#include "AudioManager.h"
+#include "Maze.h"
+#include "MazePVS.h"
+#include "Ghost.h"
+#include "GhostSystem.h"
+#include "JobSystem.h"
+#include "FlowField.h"
+#include "Pathfinder.h"
+#include "HierarchicalPathfinder.h"
+#include "SpatialGrid.h"
+#include "Random.h"
+#include <chrono>
+#include <cstdint>
+#include <memory> // For unique_ptr
+#include <string>
+#include <vector>
+
+// Main game class orchestrating all subsystems
+class Game {
+public:
+    Game();
+    ~Game();
+
+    // Initialize all game systems and GLUT
+    bool initialize(int argc, char** argv);
+
+    // Start the main game loop
+    void run();
+
+    // Advance the simulation by one fixed step of deltaTime seconds
+    void update(float deltaTime);
+
+    // Called whenever GLUT is idle: run the fixed steps that are due, then request a redraw
+    void advanceFrame();
+
+    // Called by GLUT for rendering
+    void render();
+
+    // Called by GLUT for window resizing
+    void reshape(int width, int height);
+
+    // --- Game Logic Actions ---
+    void quitGame();
+    void toggleLight();
+    void interact(); // Player interaction (e.g., pick up key, open door)
+    // Change a wall during play. Use this rather than Maze::setWall so the path hierarchy
+    // rebuilds just the clusters around the cell before the next step's searches, and the
+    // chase field, visibility set and maze mesh follow the new layout.
+    void setWall(int row, int col, bool wall);
+    void toggleProfilerOverlay(); // Show/hide per-pass frame timings
+    void dumpProfile();           // Write the per-pass timing statistics to PROFILE_CSV_PATH
+    void dumpTrace();             // Write the buffered trace events to TRACE_JSON_PATH
+    void flickerLight(int value); // Timer callback for light flickering
+    void triggerGhostAppearance(int value); // Timer callback for ghost
+
+    // --- Getters for Callbacks ---
+    Camera& getCamera() { return camera; }
+    Renderer& getRenderer() { return *renderer; } // Return reference
+    int getTick() const { return simulationTick; } // Simulation steps run so far
+
+private:
+    // Game state
+    bool isRunning;
+    bool bakeOnly; // Started with --bake-textures: bake the texture cache and exit
+    int headlessTicks; // Started with --headless <ticks>: simulate that many steps without a window
+    std::uint64_t gameSeed; // From --seed, a replayed recording, or the clock; every Random derives from it
+    bool deterministic;     // Recording or replaying: nothing in update() may depend on wall time
+    bool replaying;         // Started with --replay <file>
+    bool replayDiverged;    // A replay checkpoint did not match the recording
+    int replayMatches;      // Replay checkpoints that matched
+    int simulationTick;     // Steps run so far; input is stamped with it when recorded
+    int swarmSize; // Ghosts in ghostSwarm, from --swarm <count>
+    bool gameWon;
+    bool hasKey; // Does the player have the key?
+    bool keyVisible;
+    
+    // Player start position
+    float playerStartX, playerStartZ; // Initial position based on maze 'S'
+
+    // Key position (example, could be placed dynamically)
+    float keyX, keyZ;
+
+    // What the player can touch, bump into or interact with, registered in `entities`. Swarm
+    // ghost i is tagged SwarmGhost + i.
+    enum class EntityTag : std::uint32_t { Key, Exit, Prop, Ghost, SwarmGhost };
+    SpatialGrid entities;
+    int keyEntity; // -1 once picked up
+    int ghostEntity;
+    std::vector<int> swarmEntities; // Entity id of each swarm ghost
+    bool ghostTouching; // A visible ghost was within TRIGGER_RADIUS last step
+
+    // Core systems (using unique_ptr for automatic memory management)
+    TextureManager textureManager;
+    std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<InputHandler> inputHandler;
+    InputScript inputScript; // Input for headless runs, from --script <file> or --replay <file>
+    InputRecording recording; // Written with --record <file>, read with --replay <file>
+    Random layoutRandom;     // Key placement
+    Random timerRandom;      // Ghost appearance delays
+    Random flickerRandom;    // Light flicker; cosmetic, so it never feeds the checksum
+    Camera camera;
+    AudioManager audioManager;
+    Maze maze;
+    MazePVS mazePVS; // Per-cell visibility, rebuilt whenever the maze is loaded
+    FlowField playerField; // Distances to the player's cell, shared by every ghost
+    HierarchicalPathfinder pathHierarchy; // Cluster graph for long ghost routes
+    Pathfinder pathfinder; // Time-sliced route searches for ghosts
+    bool pathHierarchyDirty; // setWall() marked clusters that rebuildDirty() has not refreshed yet
+    Ghost ghost;
+    GhostSystem ghostSwarm; // Extra ghosts from --swarm <count>, updated as one batch
+    JobSystem jobs; // Worker threads that update stages fan out onto
+
+    // Timing: fixed steps on a monotonic clock, with rendering interpolated in between
+    std::chrono::steady_clock::time_point lastFrameTime;
+    double stepAccumulator; // Wall time not yet simulated, in seconds
+    float renderAlpha;      // Position of this frame between the previous and the latest step
+    float previousCamX, previousCamY, previousCamZ; // Camera position before the latest step
+    int flickerTicks;       // Steps until the next light flicker
+    bool lightOn;           // Switched with toggleLight(); flickerLight() only varies the intensity
+    int ghostAppearTicks;   // Steps until the next ghost appearance check
+
+    // --- Static Wrappers for GLUT Callbacks ---
+    // These functions call the corresponding methods on the singleton instance.
+    static void displayCallback();
+    static void reshapeCallback(int width, int height);
+    static void idleCallback(); // For the main loop
+
+    // Singleton instance pointer (required for static GLUT callbacks)
+    static Game* instance;
+
+    // --- Private Helper Methods ---
+    void checkCollisions(); // Check player collision with walls, key, exit
+    void pickUpKey();
+    void registerGhosts();      // Put the ghost and every swarm ghost into `entities`
+    void moveGhostEntities();   // Follow this step's ghost movement in `entities`
+    void setupSimulation(); // Build what update() needs: path hierarchy, swarm, player start, tick timers
+    void setupTimers();     // Start the main loop clock
+    void runHeadless();     // Run headlessTicks steps back to back and report the rate and allocations
+    bool startRecording(const std::string& path); // Log this run's input to path
+    void checkpoint();      // Record or verify the simulation checksum while recording or replaying
+    std::uint64_t simulationChecksum() const;     // Hash of everything update() changes
+    void loadGameData();    // Load maze, place key, etc.
+    void placeProps();      // Scatter furniture through the maze
+};
@@ -1,102 +1,199 @@
-#include "Ghost.h"
-#include "Camera.h" // Include Camera header
-#include "Maze.h"   // Include Maze header
-#include <cmath>    // For atan2, sqrt
-#include <iostream> // For debugging
-
-Ghost::Ghost(const Maze& mazeRef) :
-    maze(mazeRef),
-    x(0.0f), y(WALL_HEIGHT / 2.0f), z(0.0f), // Initial position (will be randomized)
-    angle(0.0f),
-    visible(false),
-    visibilityTimer(0.0f),
-    timeUntilNextPossibleAppearance(0.0f), // Appear immediately possibility
-    speed(GHOST_SPEED),
-    targetX(0.0f), targetZ(0.0f)
-{
-    // Seed random number generator
-    srand(static_cast<unsigned int>(time(0)));
-
-    // Set initial random position and target
-    findRandomSpawnPoint(x, z);
-    findRandomSpawnPoint(targetX, targetZ); // Initial random target
-    y = WALL_HEIGHT / 2.0f; // Set Y position based on wall height
-}
-
-void Ghost::findRandomSpawnPoint(float& outX, float& outZ) {
-    int r, c;
-    do {
-        r = rand() % maze.getHeight();
-        c = rand() % maze.getWidth();
-    } while (maze.isWall(r, c)); // Keep trying until a non-wall space is found
-
-    // Convert maze coordinates (row, col) to world coordinates (x, z)
-    // Assuming each maze cell is 1x1 unit in world space
-    outX = static_cast<float>(c) + 0.5f; // Center of the cell
-    outZ = static_cast<float>(r) + 0.5f; // Center of the cell
-}
-
-void Ghost::appearRandomly() {
-    if (!visible && timeUntilNextPossibleAppearance <= 0.0f) {
-        findRandomSpawnPoint(x, z);
-        y = WALL_HEIGHT / 2.0f; // Reset height
-        visible = true;
-        visibilityTimer = static_cast<float>(GHOST_VISIBLE_DURATION) / 1000.0f; // Reset timer (in seconds)
-        std::cout << "Ghost appeared at (" << x << ", " << z << ")" << std::endl; // Debug
-
-        // Reset time for next *possible* appearance (random interval)
-        timeUntilNextPossibleAppearance = static_cast<float>(rand() % (GHOST_APPEAR_INTERVAL_MAX - GHOST_APPEAR_INTERVAL_MIN + 1) + GHOST_APPEAR_INTERVAL_MIN) / 1000.0f;
-    }
-}
-
-void Ghost::update(float deltaTime, const Camera& playerCamera) {
-    if (visible) {
-        visibilityTimer -= deltaTime;
-        if (visibilityTimer <= 0.0f) {
-            visible = false;
-            std::cout << "Ghost disappeared." << std::endl; // Debug
-            // Don't reset timeUntilNextPossibleAppearance here, it was set when it appeared
-        } else {
-            // --- Simple AI: Move towards target, face player ---
-
-            // 1. Face the player
-            float dx = playerCamera.getX() - x;
-            float dz = playerCamera.getZ() - z;
-            angle = atan2(dx, dz) * 180.0f / M_PI; // Calculate angle in degrees
-
-            // 2. Move towards target (simple linear movement)
-            // More complex pathfinding (A*) would be needed for maze navigation
-            float moveDx = targetX - x;
-            float moveDz = targetZ - z;
-            float dist = sqrt(moveDx * moveDx + moveDz * moveDz);
-
-            if (dist > 0.1f) { // If not already at target
-                moveDx /= dist; // Normalize direction
-                moveDz /= dist;
-                x += moveDx * speed * deltaTime; // Apply speed and deltaTime
-                z += moveDz * speed * deltaTime;
-
-                // Basic collision detection with walls (crude)
-                int currentR = static_cast<int>(z);
-                int currentC = static_cast<int>(x);
-
-                if (maze.isWall(currentR, currentC)) {
-                    // Hit a wall, move back or find new target
-                    x -= moveDx * speed * deltaTime; // Move back
-                    z -= moveDz * speed * deltaTime;
-                    findRandomSpawnPoint(targetX, targetZ); // Pick a new random target
-                }
-            } else {
-                // Reached target, find a new random one
-                findRandomSpawnPoint(targetX, targetZ);
-            }
-        }
-    } else {
-        // If not visible, decrease timer until next possible appearance
-        if (timeUntilNextPossibleAppearance > 0.0f) {
-            timeUntilNextPossibleAppearance -= deltaTime;
-        }
-        // Optionally, trigger appearance randomly here if timer <= 0
-        // appearRandomly(); // Or trigger based on game events/AI
-    }
-}
+#include "Ghost.h"
+#include "Maze.h"   // Include Maze header
+#include "FlowField.h"
+#include "Trace.h"
+#include <cmath>    // For atan2, sqrt
+#include <iostream> // For debugging
+
+Ghost::Ghost(const Maze& mazeRef, Pathfinder& pathfinderRef, std::uint64_t seed) :
+    maze(mazeRef),
+    pathfinder(pathfinderRef),
+    x(0.0f), y(WALL_HEIGHT / 2.0f), z(0.0f), // Initial position (will be randomized)
+    angle(0.0f),
+    previousX(0.0f), previousZ(0.0f),
+    visible(false),
+    visibilityTimer(0.0f),
+    timeUntilNextPossibleAppearance(0.0f), // Appear immediately possibility
+    random(seed),
+    speed(GHOST_SPEED),
+    targetX(0.0f), targetZ(0.0f),
+    routeTicket(Pathfinder::INVALID_TICKET),
+    routeIndex(0),
+    legIndex(0)
+{
+    // Set initial random position and target
+    findRandomSpawnPoint(x, z);
+    findRandomSpawnPoint(targetX, targetZ); // Initial random target
+    y = WALL_HEIGHT / 2.0f; // Set Y position based on wall height
+    previousX = x;
+    previousZ = z;
+}
+
+void Ghost::reseed(std::uint64_t seed) {
+    random.reseed(seed);
+    pathfinder.cancel(routeTicket);
+    routeTicket = Pathfinder::INVALID_TICKET;
+    clearRoute();
+    visible = false;
+    visibilityTimer = 0.0f;
+    timeUntilNextPossibleAppearance = 0.0f;
+    findRandomSpawnPoint(x, z);
+    findRandomSpawnPoint(targetX, targetZ);
+    previousX = x;
+    previousZ = z;
+}
+
+void Ghost::findRandomSpawnPoint(float& outX, float& outZ) {
+    int r, c;
+    do {
+        r = random.below(maze.getHeight());
+        c = random.below(maze.getWidth());
+    } while (maze.isWall(r, c)); // Keep trying until a non-wall space is found
+
+    // Convert maze coordinates (row, col) to world coordinates (x, z)
+    // Assuming each maze cell is 1x1 unit in world space
+    outX = static_cast<float>(c) + 0.5f; // Center of the cell
+    outZ = static_cast<float>(r) + 0.5f; // Center of the cell
+}
+
+void Ghost::followRoute(int cellR, int cellC) {
+    if (routeTicket != Pathfinder::INVALID_TICKET) {
+        const PathStatus status = pathfinder.takePath(routeTicket, route);
+        if (status == PathStatus::Pending) {
+            targetX = x; // Hold still until the search lands
+            targetZ = z;
+            return;
+        }
+        routeTicket = Pathfinder::INVALID_TICKET;
+        leg.clear();
+        routeIndex = 0;
+        legIndex = 0;
+        if (status != PathStatus::Found) route.clear();
+    }
+
+    // Walk the current leg cell by cell; once it runs out, refine the leg to the next waypoint
+    while (legIndex < leg.size() && leg[legIndex].row == cellR && leg[legIndex].col == cellC) {
+        ++legIndex;
+    }
+    if (legIndex >= leg.size()) {
+        while (routeIndex < route.size() && route[routeIndex].row == cellR && route[routeIndex].col == cellC) {
+            ++routeIndex;
+        }
+        if (routeIndex >= route.size()) {
+            float wanderX, wanderZ;
+            findRandomSpawnPoint(wanderX, wanderZ);
+            routeTicket = pathfinder.requestPath(cellR, cellC, static_cast<int>(wanderZ), static_cast<int>(wanderX));
+            clearRoute();
+            targetX = x;
+            targetZ = z;
+            return;
+        }
+        legIndex = 0;
+        if (!pathfinder.refineSegment(PathCell{ cellR, cellC }, route[routeIndex], leg) || leg.empty()) {
+            // Off the route, or the leg needs a grid search: queue one to the same destination
+            // so it runs within the pathfinder's budget rather than on this frame
+            const PathCell destination = route.back();
+            routeTicket = pathfinder.requestPath(cellR, cellC, destination.row, destination.col);
+            clearRoute();
+            targetX = x;
+            targetZ = z;
+            return;
+        }
+    }
+    targetX = static_cast<float>(leg[legIndex].col) + 0.5f;
+    targetZ = static_cast<float>(leg[legIndex].row) + 0.5f;
+}
+
+void Ghost::clearRoute() {
+    route.clear();
+    leg.clear();
+    routeIndex = 0;
+    legIndex = 0;
+}
+
+void Ghost::appearRandomly() {
+    if (!visible && timeUntilNextPossibleAppearance <= 0.0f) {
+        findRandomSpawnPoint(x, z);
+        previousX = x; // Appear in place rather than slide in from the old spot
+        previousZ = z;
+        y = WALL_HEIGHT / 2.0f; // Reset height
+        visible = true;
+        // Any route was planned from the old position
+        pathfinder.cancel(routeTicket);
+        routeTicket = Pathfinder::INVALID_TICKET;
+        clearRoute();
+        visibilityTimer = static_cast<float>(GHOST_VISIBLE_DURATION) / 1000.0f; // Reset timer (in seconds)
+        std::cout << "Ghost appeared at (" << x << ", " << z << ")" << std::endl; // Debug
+
+        // Reset time for next *possible* appearance (random interval)
+        timeUntilNextPossibleAppearance = static_cast<float>(random.between(GHOST_APPEAR_INTERVAL_MIN, GHOST_APPEAR_INTERVAL_MAX)) / 1000.0f;
+    }
+}
+
+void Ghost::update(float deltaTime, float playerX, float playerZ, const FlowField& playerField) {
+    TRACE_SCOPE("Ghost::update");
+    previousX = x;
+    previousZ = z;
+    if (visible) {
+        visibilityTimer -= deltaTime;
+        if (visibilityTimer <= 0.0f) {
+            visible = false;
+            std::cout << "Ghost disappeared." << std::endl; // Debug
+            // Don't reset timeUntilNextPossibleAppearance here, it was set when it appeared
+        } else {
+            // --- Simple AI: Move towards target, face player ---
+
+            // 1. Face the player
+            float dx = playerX - x;
+            float dz = playerZ - z;
+            angle = atan2(dx, dz) * 180.0f / M_PI; // Calculate angle in degrees
+
+            // 2. Chase through the flow field: head for the centre of the next cell toward
+            //    the player, or straight at the player once in the same cell. The current and
+            //    next cell form a rectangle, so the straight move never cuts through a wall.
+            const int cellR = static_cast<int>(z);
+            const int cellC = static_cast<int>(x);
+            int stepR, stepC;
+            if (playerField.getStep(cellR, cellC, stepR, stepC)) {
+                targetX = static_cast<float>(stepC) + 0.5f;
+                targetZ = static_cast<float>(stepR) + 0.5f;
+            } else if (playerField.getDistance(cellR, cellC) == 0) {
+                targetX = playerX;
+                targetZ = playerZ;
+            } else {
+                // Out of the player's reach: wander along a route to a random cell
+                followRoute(cellR, cellC);
+            }
+
+            // 3. Move towards target (simple linear movement)
+            float moveDx = targetX - x;
+            float moveDz = targetZ - z;
+            float dist = sqrt(moveDx * moveDx + moveDz * moveDz);
+
+            if (dist > 0.1f) { // If not already at target
+                moveDx /= dist; // Normalize direction
+                moveDz /= dist;
+                x += moveDx * speed * deltaTime; // Apply speed and deltaTime
+                z += moveDz * speed * deltaTime;
+
+                // Basic collision detection with walls (crude)
+                int currentR = static_cast<int>(z);
+                int currentC = static_cast<int>(x);
+
+                if (maze.isWall(currentR, currentC)) {
+                    // Hit a wall (the maze changed under the route): move back and replan
+                    x -= moveDx * speed * deltaTime; // Move back
+                    z -= moveDz * speed * deltaTime;
+                    clearRoute();
+                }
+            }
+        }
+    } else {
+        // If not visible, decrease timer until next possible appearance
+        if (timeUntilNextPossibleAppearance > 0.0f) {
+            timeUntilNextPossibleAppearance -= deltaTime;
+        }
+        // Optionally, trigger appearance randomly here if timer <= 0
+        // appearRandomly(); // Or trigger based on game events/AI
+    }
+}
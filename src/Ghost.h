@@ -1,48 +1,75 @@
-#pragma once
-
-#include "Config.h" // For constants (e.g., GHOST_SPEED, GHOST_VISIBLE_DURATION)
-#include <cstdlib>   // For rand()
-#include <ctime>     // For time()
-
-class Camera; // Forward declaration to avoid circular dependency
-class Maze;   // Forward declaration to avoid circular dependency
-
-class Ghost {
-public:
-    // Constructor: Initializes the ghost with the maze for pathfinding and placement
-    Ghost(const Maze& maze);
-
-    // Update ghost state (movement, visibility timer)
-    void update(float deltaTime, const Camera& playerCamera);
-
-    // Getters for position, visibility, and angle
-    float getX() const { return x; }
-    float getY() const { return y; }
-    float getZ() const { return z; }
-    float getAngle() const { return angle; } // Angle to face player
-    bool isVisible() const { return visible; }
-
-    // Trigger the ghost to appear at a random valid location in the maze
-    void appearRandomly();
-
-private:
-    // Reference to maze data for pathfinding/placement
-    const Maze& maze;
-
-    // Ghost position (x, y, z), and angle (facing direction)
-    float x, y, z;
-    float angle;
-
-    // Visibility state and timers for appearance logic
-    bool visible;                // Is the ghost currently visible?
-    float visibilityTimer;       // Time remaining for the ghost's visibility
-    float timeUntilNextPossibleAppearance; // Timer until the next possible appearance
-
-    // Movement-related properties
-    float speed;                 // Speed of the ghost movement
-    float targetX, targetZ;      // Target position for ghost movement
-
-    // Private helper methods
-    // Find a random non-wall location in the maze for spawning
-    void findRandomSpawnPoint(float& outX, float& outZ);
-};
+#pragma once
+
+#include "Config.h" // For constants (e.g., GHOST_SPEED, GHOST_VISIBLE_DURATION)
+#include "Pathfinder.h"
+#include "Random.h"
+#include <cstdint>
+#include <vector>
+
+class Maze;      // Forward declaration to avoid circular dependency
+class FlowField; // Forward declaration to avoid circular dependency
+
+class Ghost {
+public:
+    // Constructor: Initializes the ghost with the maze for placement and the shared
+    // pathfinder it asks for wandering routes. seed drives spawn points and intervals.
+    Ghost(const Maze& maze, Pathfinder& pathfinder, std::uint64_t seed = 1);
+
+    // Restart the random stream from seed and respawn hidden at a random spot, e.g. once
+    // the game seed and maze are known
+    void reseed(std::uint64_t seed);
+
+    // Update ghost state (movement, visibility timer) for a player at (playerX, playerZ).
+    // Inside the player's flow field the ghost steps toward the player; elsewhere it
+    // wanders between random targets.
+    void update(float deltaTime, float playerX, float playerZ, const FlowField& playerField);
+
+    // Getters for position, visibility, and angle
+    float getX() const { return x; }
+    float getY() const { return y; }
+    float getZ() const { return z; }
+    float getAngle() const { return angle; } // Angle to face player
+    // Position between the previous (alpha = 0) and latest (alpha = 1) update, for rendering
+    float getInterpolatedX(float alpha) const { return previousX + (x - previousX) * alpha; }
+    float getInterpolatedZ(float alpha) const { return previousZ + (z - previousZ) * alpha; }
+    bool isVisible() const { return visible; }
+
+    // Trigger the ghost to appear at a random valid location in the maze
+    void appearRandomly();
+
+private:
+    // Reference to maze data for pathfinding/placement
+    const Maze& maze;
+    Pathfinder& pathfinder;
+
+    // Ghost position (x, y, z), and angle (facing direction)
+    float x, y, z;
+    float angle;
+    float previousX, previousZ; // Position before the latest update
+
+    // Visibility state and timers for appearance logic
+    bool visible;                // Is the ghost currently visible?
+    float visibilityTimer;       // Time remaining for the ghost's visibility
+    float timeUntilNextPossibleAppearance; // Timer until the next possible appearance
+
+    Random random; // Spawn points, wander targets and appearance intervals
+
+    // Movement-related properties
+    float speed;                 // Speed of the ghost movement
+    float targetX, targetZ;      // Target position for ghost movement
+
+    // Wandering route from the pathfinder: waypoints, each leg refined to cells when reached
+    Pathfinder::Ticket routeTicket; // Outstanding request, or INVALID_TICKET
+    std::vector<PathCell> route;
+    size_t routeIndex;           // Waypoint the current leg leads to
+    std::vector<PathCell> leg;
+    size_t legIndex;             // Next cell of leg to head for
+
+    // Private helper methods
+    // Find a random non-wall location in the maze for spawning
+    void findRandomSpawnPoint(float& outX, float& outZ);
+
+    // Set the target to the next route cell, requesting a new route when done
+    void followRoute(int cellR, int cellC);
+    void clearRoute();
+};
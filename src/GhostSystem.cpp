@@ -0,0 +1,314 @@
+#include "GhostSystem.h"
+#include "Maze.h"
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "Random.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GHOST_SYSTEM_SSE2 1
+#include <emmintrin.h>
+#else
+#define GHOST_SYSTEM_SSE2 0
+#endif
+
+namespace {
+    const int LANES = 4;
+    const float ARRIVE_DISTANCE = 0.1f; // Same as Ghost: closer than this counts as arrived
+    const float RADIANS_TO_DEGREES = 180.0f / 3.14159265f;
+    const float HALF_PI = 1.57079633f;
+    const float PI = 3.14159265f;
+    const int SPAWN_ATTEMPTS = 1024;
+
+    // Minimax polynomial for atan on [0, 1]; max error about 1e-5 radians
+    const float ATAN_C3 = -0.327622764f;
+    const float ATAN_C5 = 0.15931422f;
+    const float ATAN_C7 = -0.0464964749f;
+
+    const int STEP_ROW[4] = { -1, 1, 0, 0 };
+    const int STEP_COL[4] = { 0, 0, -1, 1 };
+
+    // atan2(y, x) in degrees with the same polynomial as the vector kernel
+    float fastAtan2Degrees(float y, float x) {
+        const float absY = std::fabs(y), absX = std::fabs(x);
+        const float a = std::min(absY, absX) / std::max(std::max(absY, absX), 1e-30f);
+        const float s = a * a;
+        float r = ((ATAN_C7 * s + ATAN_C5) * s + ATAN_C3) * s * a + a;
+        if (absY > absX) r = HALF_PI - r;
+        if (x < 0.0f) r = PI - r;
+        if (y < 0.0f) r = -r;
+        return r * RADIANS_TO_DEGREES;
+    }
+
+#if GHOST_SYSTEM_SSE2
+    inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    __m128 fastAtan2Degrees4(__m128 y, __m128 x) {
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        const __m128 absY = _mm_andnot_ps(signBit, y), absX = _mm_andnot_ps(signBit, x);
+        const __m128 a = _mm_div_ps(_mm_min_ps(absY, absX), _mm_max_ps(_mm_max_ps(absY, absX), _mm_set1_ps(1e-30f)));
+        const __m128 s = _mm_mul_ps(a, a);
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ATAN_C7), s), _mm_set1_ps(ATAN_C5));
+        r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C3));
+        r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), a);
+        r = select(_mm_cmpgt_ps(absY, absX), _mm_sub_ps(_mm_set1_ps(HALF_PI), r), r);
+        r = select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), r), r);
+        r = _mm_or_ps(r, _mm_and_ps(y, signBit)); // r >= 0 here, so this copies y's sign
+        return _mm_mul_ps(r, _mm_set1_ps(RADIANS_TO_DEGREES));
+    }
+#endif
+}
+
+GhostSystem::GhostSystem(const Maze& mazeRef, std::uint64_t seed)
+    : maze(mazeRef), seed(seed), count(0), visibleCount(0), appearCursor(0), sightingCount(0) {
+}
+
+bool GhostSystem::isVectorized() {
+    return GHOST_SYSTEM_SSE2 != 0;
+}
+
+std::uint32_t GhostSystem::nextRandom(int index) {
+    std::uint32_t state = random[index];
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    random[index] = state;
+    return state;
+}
+
+void GhostSystem::placeRandomly(int index) {
+    const int width = maze.getWidth(), height = maze.getHeight();
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; ++attempt) {
+        const int r = static_cast<int>(nextRandom(index) % static_cast<std::uint32_t>(height));
+        const int c = static_cast<int>(nextRandom(index) % static_cast<std::uint32_t>(width));
+        if (!maze.isWall(r, c)) {
+            x[index] = previousX[index] = targetX[index] = static_cast<float>(c) + 0.5f;
+            z[index] = previousZ[index] = targetZ[index] = static_cast<float>(r) + 0.5f;
+            return;
+        }
+    }
+    // Nearly solid maze: stay put rather than loop forever
+}
+
+void GhostSystem::resize(int newCount) {
+    newCount = std::max(0, newCount);
+    const int oldCount = count;
+    const size_t padded = (static_cast<size_t>(newCount) + LANES - 1) / LANES * LANES;
+    for (std::vector<float>* column : { &x, &z, &previousX, &previousZ, &targetX, &targetZ, &angle, &visibleTimer, &appearTimer, &stepX, &stepZ }) {
+        column->resize(padded, 0.0f);
+    }
+    visible.resize(padded, 0);
+    random.resize(padded, 0);
+    sightTargetX.resize(padded, 0.0f);
+    sightTargetZ.resize(padded, 0.0f);
+    sight.assign((padded + 63) / 64, 0);
+    sightingCount = 0;
+    count = newCount;
+
+    for (int i = oldCount; i < newCount; ++i) {
+        std::uint64_t mix = seed ^ (static_cast<std::uint64_t>(i) * 0xD1B54A32D192ED03ULL);
+        random[i] = static_cast<std::uint32_t>(Random::splitMix64(mix)) | 1u;
+        visible[i] = 0;
+        visibleTimer[i] = 0.0f;
+        appearTimer[i] = 0.0f;
+        placeRandomly(i);
+    }
+    // Padding lanes must stay hidden so the kernel leaves them alone
+    for (size_t i = static_cast<size_t>(newCount); i < padded; ++i) {
+        visible[i] = 0;
+    }
+    visibleCount = static_cast<int>(std::count(visible.begin(), visible.begin() + newCount, std::uint8_t(1)));
+    appearCursor = newCount > 0 ? appearCursor % newCount : 0;
+}
+
+int GhostSystem::appearRandomly(int maxCount) {
+    int appeared = 0;
+    for (int checked = 0; checked < count && appeared < maxCount; ++checked) {
+        const int i = appearCursor;
+        appearCursor = (appearCursor + 1) % count;
+        if (visible[i] || appearTimer[i] > 0.0f) continue;
+
+        placeRandomly(i);
+        visible[i] = 1;
+        visibleTimer[i] = static_cast<float>(GHOST_VISIBLE_DURATION) / 1000.0f;
+        const int span = GHOST_APPEAR_INTERVAL_MAX - GHOST_APPEAR_INTERVAL_MIN + 1;
+        appearTimer[i] = static_cast<float>(static_cast<int>(nextRandom(i) % static_cast<std::uint32_t>(span)) +
+                                            GHOST_APPEAR_INTERVAL_MIN) / 1000.0f;
+        ++appeared;
+    }
+    visibleCount += appeared;
+    return appeared;
+}
+
+void GhostSystem::update(float deltaTime, float playerX, float playerZ, const FlowField& playerField) {
+    if (count == 0) return;
+    TRACE_SCOPE("GhostSystem::update");
+    visibleCount -= updateRange(0, count, deltaTime, playerX, playerZ, playerField);
+}
+
+void GhostSystem::update(float deltaTime, float playerX, float playerZ, const FlowField& playerField, JobSystem& jobs) {
+    if (count == 0) return;
+    TRACE_SCOPE("GhostSystem::update");
+    std::atomic<int> retired(0);
+    // GHOST_BATCH_SIZE is a multiple of four, so every batch starts on a lane boundary
+    jobs.parallelFor(0, count, GHOST_BATCH_SIZE, [&](int begin, int end) {
+        retired.fetch_add(updateRange(begin, end, deltaTime, playerX, playerZ, playerField), std::memory_order_relaxed);
+    });
+    visibleCount -= retired.load();
+}
+
+void GhostSystem::updateSight(float playerX, float playerZ, float range) {
+    TRACE_SCOPE("GhostSystem::updateSight");
+    // Ghosts that cannot see the player anyway get a zero-length ray, which costs nothing
+    const float rangeSquared = range * range;
+    for (int i = 0; i < count; ++i) {
+        const float dx = playerX - x[i], dz = playerZ - z[i];
+        const bool candidate = visible[i] && dx * dx + dz * dz <= rangeSquared;
+        sightTargetX[i] = candidate ? playerX : x[i];
+        sightTargetZ[i] = candidate ? playerZ : z[i];
+    }
+    maze.lineOfSight(x.data(), z.data(), sightTargetX.data(), sightTargetZ.data(), count, sight.data());
+
+    // Zero-length rays came back clear; drop them
+    sightingCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!seesPlayer(i)) continue;
+        const float dx = playerX - x[i], dz = playerZ - z[i];
+        if (visible[i] && dx * dx + dz * dz <= rangeSquared) {
+            ++sightingCount;
+        } else {
+            sight[i >> 6] &= ~(std::uint64_t(1) << (i & 63));
+        }
+    }
+}
+
+int GhostSystem::updateRange(int begin, int end, float deltaTime, float playerX, float playerZ, const FlowField& playerField) {
+    TRACE_SCOPE("GhostSystem::updateRange"); // One per batch, on whichever thread ran it
+    // Running all passes per batch keeps a batch's columns in cache between them
+    std::copy(x.begin() + begin, x.begin() + end, previousX.begin() + begin);
+    std::copy(z.begin() + begin, z.begin() + end, previousZ.begin() + begin);
+    updateTargets(begin, end, playerX, playerZ, playerField);
+    integrate(begin, end, deltaTime, playerX, playerZ);
+    return commitMoves(begin, end);
+}
+
+void GhostSystem::updateTargets(int begin, int end, float playerX, float playerZ, const FlowField& playerField) {
+    for (int i = begin; i < end; ++i) {
+        if (!visible[i]) continue;
+        const int cellR = static_cast<int>(z[i]);
+        const int cellC = static_cast<int>(x[i]);
+
+        // Same chase rule as Ghost: next cell toward the player, or the player itself
+        // once in its cell. Current and next cell form a rectangle, so no wall is cut.
+        int stepR, stepC;
+        if (playerField.getStep(cellR, cellC, stepR, stepC)) {
+            targetX[i] = static_cast<float>(stepC) + 0.5f;
+            targetZ[i] = static_cast<float>(stepR) + 0.5f;
+            continue;
+        }
+        if (playerField.getDistance(cellR, cellC) == 0) {
+            targetX[i] = playerX;
+            targetZ[i] = playerZ;
+            continue;
+        }
+
+        // Out of reach: wander to a random open neighbour once the target cell is entered
+        if (static_cast<int>(targetZ[i]) != cellR || static_cast<int>(targetX[i]) != cellC) continue;
+        const int first = static_cast<int>(nextRandom(i) & 3u);
+        for (int k = 0; k < 4; ++k) {
+            const int d = (first + k) & 3;
+            const int nextR = cellR + STEP_ROW[d], nextC = cellC + STEP_COL[d];
+            if (static_cast<unsigned>(nextR) < static_cast<unsigned>(maze.getHeight()) &&
+                static_cast<unsigned>(nextC) < static_cast<unsigned>(maze.getWidth()) &&
+                !maze.isWall(nextR, nextC)) {
+                targetX[i] = static_cast<float>(nextC) + 0.5f;
+                targetZ[i] = static_cast<float>(nextR) + 0.5f;
+                break;
+            }
+        }
+    }
+}
+
+void GhostSystem::integrate(int begin, int end, float deltaTime, float playerX, float playerZ) {
+    // The last batch also covers the hidden padding lanes
+    const size_t padded = std::min((static_cast<size_t>(end) + LANES - 1) / LANES * LANES, x.size());
+    const float moveScale = GHOST_SPEED * deltaTime;
+    const float arriveSquared = ARRIVE_DISTANCE * ARRIVE_DISTANCE;
+    size_t i = static_cast<size_t>(begin);
+#if GHOST_SYSTEM_SSE2
+    const __m128 playerX4 = _mm_set1_ps(playerX), playerZ4 = _mm_set1_ps(playerZ);
+    const __m128 moveScale4 = _mm_set1_ps(moveScale), arrive4 = _mm_set1_ps(arriveSquared);
+    const __m128 delta4 = _mm_set1_ps(deltaTime), zero4 = _mm_setzero_ps();
+    for (; i + LANES <= padded; i += LANES) {
+        // Widen four visibility bytes into lane masks
+        std::int32_t packed;
+        std::memcpy(&packed, &visible[i], sizeof(packed));
+        __m128i flags = _mm_cvtsi32_si128(packed);
+        flags = _mm_unpacklo_epi8(flags, _mm_setzero_si128());
+        flags = _mm_unpacklo_epi16(flags, _mm_setzero_si128());
+        const __m128 shown = _mm_castsi128_ps(_mm_cmpgt_epi32(flags, _mm_setzero_si128()));
+
+        const __m128 gx = _mm_loadu_ps(&x[i]), gz = _mm_loadu_ps(&z[i]);
+        _mm_storeu_ps(&angle[i], fastAtan2Degrees4(_mm_sub_ps(playerX4, gx), _mm_sub_ps(playerZ4, gz)));
+
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&targetX[i]), gx);
+        const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&targetZ[i]), gz);
+        const __m128 distSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        const __m128 moving = _mm_and_ps(shown, _mm_cmpgt_ps(distSquared, arrive4));
+        const __m128 scale = _mm_div_ps(moveScale4, _mm_sqrt_ps(_mm_max_ps(distSquared, arrive4)));
+        _mm_storeu_ps(&stepX[i], _mm_and_ps(moving, _mm_mul_ps(dx, scale)));
+        _mm_storeu_ps(&stepZ[i], _mm_and_ps(moving, _mm_mul_ps(dz, scale)));
+
+        // Visible ghosts run down their visibility, hidden ones their appearance delay
+        _mm_storeu_ps(&visibleTimer[i], _mm_sub_ps(_mm_loadu_ps(&visibleTimer[i]), _mm_and_ps(shown, delta4)));
+        _mm_storeu_ps(&appearTimer[i],
+                      _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&appearTimer[i]), _mm_andnot_ps(shown, delta4)), zero4));
+    }
+#endif
+    for (; i < padded; ++i) {
+        angle[i] = fastAtan2Degrees(playerX - x[i], playerZ - z[i]);
+        const float dx = targetX[i] - x[i], dz = targetZ[i] - z[i];
+        const float distSquared = dx * dx + dz * dz;
+        if (visible[i] && distSquared > arriveSquared) {
+            const float scale = moveScale / std::sqrt(distSquared);
+            stepX[i] = dx * scale;
+            stepZ[i] = dz * scale;
+        } else {
+            stepX[i] = 0.0f;
+            stepZ[i] = 0.0f;
+        }
+        if (visible[i]) {
+            visibleTimer[i] -= deltaTime;
+        } else {
+            appearTimer[i] = std::max(appearTimer[i] - deltaTime, 0.0f);
+        }
+    }
+}
+
+int GhostSystem::commitMoves(int begin, int end) {
+    int retired = 0;
+    for (int i = begin; i < end; ++i) {
+        if (!visible[i]) continue;
+        if (visibleTimer[i] <= 0.0f) {
+            visible[i] = 0;
+            ++retired;
+            continue;
+        }
+        const float nextX = x[i] + stepX[i], nextZ = z[i] + stepZ[i];
+        if (maze.isWall(static_cast<int>(nextZ), static_cast<int>(nextX))) {
+            // The maze changed under the ghost: hold and pick a new target from this cell
+            targetX[i] = std::floor(x[i]) + 0.5f;
+            targetZ[i] = std::floor(z[i]) + 0.5f;
+            continue;
+        }
+        x[i] = nextX;
+        z[i] = nextZ;
+    }
+    return retired;
+}
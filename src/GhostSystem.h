@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Config.h" // For GHOST_SPEED, GHOST_VISIBLE_DURATION
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Maze;      // Forward declaration
+class FlowField; // Forward declaration
+class JobSystem; // Forward declaration
+
+// Many ghosts updated as one batch. State is kept as parallel arrays (structure of arrays)
+// padded to a multiple of four, so the per-frame math — facing angle, distance to the
+// target, movement step and timers — runs four ghosts per SSE2 instruction, with a scalar
+// loop for other targets. Targets come from the shared player flow field; ghosts outside
+// it wander cell to cell. Decisions that read the maze stay scalar and touch only cells.
+// Unlike Ghost, nothing here logs or allocates per frame.
+class GhostSystem {
+public:
+    // seed drives every ghost's own random stream (spawn cells, wandering, intervals)
+    explicit GhostSystem(const Maze& maze, std::uint64_t seed = 1);
+
+    // Seed for ghosts added by later resize() calls
+    void setSeed(std::uint64_t newSeed) { seed = newSeed; }
+
+    // Grow or shrink to count ghosts; new ghosts start hidden on random open cells
+    void resize(int count);
+
+    // Advance every ghost by deltaTime seconds, facing and chasing the player at (playerX, playerZ)
+    void update(float deltaTime, float playerX, float playerZ, const FlowField& playerField);
+
+    // Same, with batches of GHOST_BATCH_SIZE ghosts spread over the job system's threads.
+    // Ghosts only read the maze and the field, so batches never touch shared state.
+    void update(float deltaTime, float playerX, float playerZ, const FlowField& playerField, JobSystem& jobs);
+
+    // Test which visible ghosts within range of the player have a clear line of sight to
+    // it, as one batch of maze rays. Results hold until the next call.
+    void updateSight(float playerX, float playerZ, float range);
+    bool seesPlayer(int index) const { return (sight[index >> 6] >> (index & 63)) & 1u; }
+    int getSightingCount() const { return sightingCount; }
+
+    // Make up to maxCount hidden ghosts whose appearance timers ran out appear on random
+    // open cells. Returns how many appeared.
+    int appearRandomly(int maxCount);
+
+    int getCount() const { return count; }
+    int getVisibleCount() const { return visibleCount; }
+    float getX(int index) const { return x[index]; }
+    float getZ(int index) const { return z[index]; }
+    float getAngle(int index) const { return angle[index]; } // Degrees, facing the player
+    // Position between the previous (alpha = 0) and latest (alpha = 1) update, for rendering
+    float getInterpolatedX(int index, float alpha) const { return previousX[index] + (x[index] - previousX[index]) * alpha; }
+    float getInterpolatedZ(int index, float alpha) const { return previousZ[index] + (z[index] - previousZ[index]) * alpha; }
+    bool isVisible(int index) const { return visible[index] != 0; }
+
+    // True if update() uses the SSE2 kernel
+    static bool isVectorized();
+
+private:
+    const Maze& maze;
+    std::uint64_t seed;
+    int count;
+    int visibleCount;
+    int appearCursor; // Where appearRandomly() resumes, so every ghost gets a turn
+
+    // One entry per ghost, padded with hidden ghosts to a multiple of four
+    std::vector<float> x, z;
+    std::vector<float> previousX, previousZ; // Positions before the latest update
+    std::vector<float> targetX, targetZ;
+    std::vector<float> angle;
+    std::vector<float> visibleTimer;  // Seconds left visible
+    std::vector<float> appearTimer;   // Seconds until the ghost may appear again
+    std::vector<float> stepX, stepZ;  // This frame's movement, checked against walls
+    std::vector<std::uint8_t> visible;
+    std::vector<std::uint32_t> random; // xorshift32 state per ghost
+
+    // Line of sight: ray targets (the player, or the ghost itself to skip it) and result bits
+    std::vector<float> sightTargetX, sightTargetZ;
+    std::vector<std::uint64_t> sight;
+    int sightingCount;
+
+    std::uint32_t nextRandom(int index);
+    void placeRandomly(int index);
+    // All three passes over ghosts [begin, end), begin a multiple of four. Returns how many
+    // ghosts disappeared.
+    int updateRange(int begin, int end, float deltaTime, float playerX, float playerZ, const FlowField& playerField);
+    // Pick each visible ghost's next target cell (scalar: reads the field and the maze)
+    void updateTargets(int begin, int end, float playerX, float playerZ, const FlowField& playerField);
+    // Facing angles, movement steps and timers (vectorized; end is rounded up to four lanes)
+    void integrate(int begin, int end, float deltaTime, float playerX, float playerZ);
+    // Apply the steps that stay out of walls and retire ghosts whose time ran out
+    int commitMoves(int begin, int end);
+};
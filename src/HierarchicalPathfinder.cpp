@@ -0,0 +1,468 @@
+#include "HierarchicalPathfinder.h"
+#include "Maze.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+
+namespace {
+    // Open border runs at least this long get an entrance at each end instead of one mid-run
+    const int LONG_RUN = 6;
+
+    const int STEP_ROW[4] = { -1, 1, 0, 0 };
+    const int STEP_COL[4] = { 0, 0, -1, 1 };
+
+    int manhattan(int rowA, int colA, int rowB, int colB) {
+        return std::abs(rowA - rowB) + std::abs(colA - colB);
+    }
+
+    // Append one or two entrance positions for every open run in open[0 .. length)
+    void addEntrances(const std::vector<char>& open, int base, std::vector<int>& out) {
+        const int length = static_cast<int>(open.size());
+        for (int i = 0; i < length;) {
+            if (!open[i]) {
+                ++i;
+                continue;
+            }
+            int end = i;
+            while (end + 1 < length && open[end + 1]) ++end;
+            if (end - i + 1 >= LONG_RUN) {
+                out.push_back(base + i);
+                out.push_back(base + end);
+            } else {
+                out.push_back(base + (i + end) / 2);
+            }
+            i = end + 1;
+        }
+    }
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(const Maze& mazeRef, int size)
+    : maze(mazeRef), clusterSize(std::max(8, std::min(size, 128))), clustersX(0), clustersY(0),
+      totalNodes(0), builtVersion(0), built(false), buildMilliseconds(0.0),
+      generation(0), expandedNodes(0), queryState(QueryState::Idle),
+      queryStartRow(0), queryStartCol(0), queryGoalRow(0), queryGoalCol(0),
+      queryGoalCluster(0), queryVersion(0) {}
+
+bool HierarchicalPathfinder::isOpen(int row, int col) const {
+    return static_cast<unsigned>(row) < static_cast<unsigned>(maze.getHeight()) &&
+           static_cast<unsigned>(col) < static_cast<unsigned>(maze.getWidth()) &&
+           !maze.isWall(row, col);
+}
+
+bool HierarchicalPathfinder::isUpToDate() const {
+    return built && builtVersion == maze.getVersion();
+}
+
+// --- Building ---
+
+void HierarchicalPathfinder::build(unsigned threadCount) {
+    clustersX = (maze.getWidth() + clusterSize - 1) / clusterSize;
+    clustersY = (maze.getHeight() + clusterSize - 1) / clusterSize;
+    clusters.assign(static_cast<size_t>(clustersX) * clustersY, Cluster());
+    verticalEntrances.assign(clusters.size(), std::vector<int>());
+    horizontalEntrances.assign(clusters.size(), std::vector<int>());
+
+    std::vector<int> all(clusters.size());
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        Cluster& cluster = clusters[i];
+        cluster.row0 = static_cast<int>(i / clustersX) * clusterSize;
+        cluster.col0 = static_cast<int>(i % clustersX) * clusterSize;
+        cluster.rows = std::min(clusterSize, maze.getHeight() - cluster.row0);
+        cluster.cols = std::min(clusterSize, maze.getWidth() - cluster.col0);
+        cluster.dirty = true;
+        all[i] = static_cast<int>(i);
+    }
+    rebuild(all, threadCount);
+    built = true;
+}
+
+void HierarchicalPathfinder::markDirty(int row, int col) {
+    if (!built || static_cast<unsigned>(row) >= static_cast<unsigned>(maze.getHeight()) ||
+        static_cast<unsigned>(col) >= static_cast<unsigned>(maze.getWidth())) {
+        return;
+    }
+    clusters[clusterAt(row, col)].dirty = true;
+}
+
+void HierarchicalPathfinder::rebuildDirty(unsigned threadCount) {
+    if (!built) return;
+    std::vector<int> dirty;
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        if (clusters[i].dirty) dirty.push_back(static_cast<int>(i));
+    }
+    rebuild(dirty, threadCount);
+}
+
+void HierarchicalPathfinder::rebuild(const std::vector<int>& dirty, unsigned threadCount) {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // 1. Entrances on every border of a dirty cluster (cheap: one pass along each border)
+    std::vector<char> open;
+    for (int index : dirty) {
+        const int cx = index % clustersX, cy = index / clustersX;
+        for (int side = Top; side <= Right; ++side) {
+            // Borders are stored with the cluster above / left of them
+            if ((side == Top && cy == 0) || (side == Bottom && cy + 1 >= clustersY) ||
+                (side == Left && cx == 0) || (side == Right && cx + 1 >= clustersX)) {
+                continue;
+            }
+            const bool vertical = side == Left || side == Right;
+            const int owner = side == Top ? index - clustersX : side == Left ? index - 1 : index;
+
+            const Cluster& cluster = clusters[owner];
+            std::vector<int>& entrances = vertical ? verticalEntrances[owner] : horizontalEntrances[owner];
+            entrances.clear();
+            if (vertical) {
+                const int col = cluster.col0 + cluster.cols - 1;
+                open.assign(cluster.rows, 0);
+                for (int r = 0; r < cluster.rows; ++r) {
+                    open[r] = isOpen(cluster.row0 + r, col) && isOpen(cluster.row0 + r, col + 1);
+                }
+                addEntrances(open, cluster.row0, entrances);
+            } else {
+                const int row = cluster.row0 + cluster.rows - 1;
+                open.assign(cluster.cols, 0);
+                for (int c = 0; c < cluster.cols; ++c) {
+                    open[c] = isOpen(row, cluster.col0 + c) && isOpen(row + 1, cluster.col0 + c);
+                }
+                addEntrances(open, cluster.col0, entrances);
+            }
+        }
+    }
+
+    // 2. Dirty clusters and their neighbours get new node lists and distance tables
+    std::vector<char> affected(clusters.size(), 0);
+    for (int index : dirty) {
+        const int cx = index % clustersX, cy = index / clustersX;
+        affected[index] = 1;
+        if (cy > 0) affected[index - clustersX] = 1;
+        if (cy + 1 < clustersY) affected[index + clustersX] = 1;
+        if (cx > 0) affected[index - 1] = 1;
+        if (cx + 1 < clustersX) affected[index + 1] = 1;
+    }
+    std::vector<int> work;
+    for (size_t i = 0; i < affected.size(); ++i) {
+        if (affected[i]) work.push_back(static_cast<int>(i));
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, std::max<size_t>(1, work.size() / 4)));
+
+    // Clusters only read the shared entrance lists and write their own tables
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        std::vector<std::uint16_t> distanceScratch;
+        std::vector<std::int16_t> queueScratch;
+        for (;;) {
+            const size_t i = next.fetch_add(1);
+            if (i >= work.size()) break;
+            buildCluster(work[i], distanceScratch, queueScratch);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker(); // The calling thread works too
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    refreshNodeIds();
+    builtVersion = maze.getVersion();
+    buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void HierarchicalPathfinder::buildCluster(int index, std::vector<std::uint16_t>& distanceScratch,
+                                          std::vector<std::int16_t>& queueScratch) {
+    Cluster& cluster = clusters[index];
+    const int cx = index % clustersX, cy = index / clustersX;
+    cluster.nodes.clear();
+
+    cluster.sideStart[Top] = 0;
+    if (cy > 0) {
+        for (int col : horizontalEntrances[index - clustersX]) cluster.nodes.push_back(PathCell{ cluster.row0, col });
+    }
+    cluster.sideStart[Bottom] = static_cast<int>(cluster.nodes.size());
+    if (cy + 1 < clustersY) {
+        for (int col : horizontalEntrances[index]) cluster.nodes.push_back(PathCell{ cluster.row0 + cluster.rows - 1, col });
+    }
+    cluster.sideStart[Left] = static_cast<int>(cluster.nodes.size());
+    if (cx > 0) {
+        for (int row : verticalEntrances[index - 1]) cluster.nodes.push_back(PathCell{ row, cluster.col0 });
+    }
+    cluster.sideStart[Right] = static_cast<int>(cluster.nodes.size());
+    if (cx + 1 < clustersX) {
+        for (int row : verticalEntrances[index]) cluster.nodes.push_back(PathCell{ row, cluster.col0 + cluster.cols - 1 });
+    }
+    cluster.sideStart[4] = static_cast<int>(cluster.nodes.size());
+
+    const size_t n = cluster.nodes.size();
+    cluster.distance.assign(n * n, NO_PATH);
+    for (size_t i = 0; i < n; ++i) {
+        clusterBfs(cluster, cluster.nodes[i].row, cluster.nodes[i].col, distanceScratch, queueScratch);
+        for (size_t j = 0; j < n; ++j) {
+            const PathCell& to = cluster.nodes[j];
+            cluster.distance[i * n + j] = distanceScratch[(to.row - cluster.row0) * cluster.cols + (to.col - cluster.col0)];
+        }
+    }
+    cluster.dirty = false;
+}
+
+void HierarchicalPathfinder::refreshNodeIds() {
+    nodeOffset.resize(clusters.size());
+    totalNodes = 0;
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        nodeOffset[i] = totalNodes;
+        totalNodes += static_cast<int>(clusters[i].nodes.size());
+    }
+    nodeCluster.resize(totalNodes);
+    nodeCells.resize(totalNodes);
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        std::fill(nodeCluster.begin() + nodeOffset[i], nodeCluster.begin() + nodeOffset[i] + clusters[i].nodes.size(),
+                  static_cast<int>(i));
+        std::copy(clusters[i].nodes.begin(), clusters[i].nodes.end(), nodeCells.begin() + nodeOffset[i]);
+    }
+    // Two extra slots for the query's start and goal
+    cost.assign(totalNodes + 2, 0);
+    parent.assign(totalNodes + 2, -1);
+    stamp.assign(totalNodes + 2, 0);
+    generation = 0;
+}
+
+void HierarchicalPathfinder::clusterBfs(const Cluster& cluster, int row, int col,
+                                        std::vector<std::uint16_t>& distance, std::vector<std::int16_t>& queue) const {
+    const int cells = cluster.rows * cluster.cols;
+    distance.assign(cells, NO_PATH);
+    queue.resize(cells);
+    if (!isOpen(row, col)) return;
+
+    // Queue entries pack (row << 7) | col, so popping needs no division (clusters are <= 128 wide)
+    int head = 0, tail = 0;
+    const int startRow = row - cluster.row0, startCol = col - cluster.col0;
+    distance[startRow * cluster.cols + startCol] = 0;
+    queue[tail++] = static_cast<std::int16_t>((startRow << 7) | startCol);
+    while (head < tail) {
+        const int r = queue[head] >> 7, c = queue[head] & 127;
+        ++head;
+        const std::uint16_t nextDistance = static_cast<std::uint16_t>(distance[r * cluster.cols + c] + 1);
+        for (int d = 0; d < 4; ++d) {
+            const int nr = r + STEP_ROW[d], nc = c + STEP_COL[d];
+            if (static_cast<unsigned>(nr) >= static_cast<unsigned>(cluster.rows) ||
+                static_cast<unsigned>(nc) >= static_cast<unsigned>(cluster.cols)) {
+                continue;
+            }
+            std::uint16_t& next = distance[nr * cluster.cols + nc];
+            if (next != NO_PATH || maze.isWall(cluster.row0 + nr, cluster.col0 + nc)) continue;
+            next = nextDistance;
+            queue[tail++] = static_cast<std::int16_t>((nr << 7) | nc);
+        }
+    }
+}
+
+int HierarchicalPathfinder::linkedNode(int index, int local, int& neighbourIndex) const {
+    const Cluster& cluster = clusters[index];
+    int side = Top;
+    while (local >= cluster.sideStart[side + 1]) ++side;
+    const int k = local - cluster.sideStart[side];
+    static const int OPPOSITE[4] = { Bottom, Top, Right, Left };
+    const int offsets[4] = { -clustersX, clustersX, -1, 1 };
+    neighbourIndex = index + offsets[side];
+    return clusters[neighbourIndex].sideStart[OPPOSITE[side]] + k;
+}
+
+// --- Queries ---
+
+bool HierarchicalPathfinder::findPath(int startRow, int startCol, int goalRow, int goalCol,
+                                      std::vector<PathCell>& waypoints) {
+    waypoints.clear();
+    QueryState state = beginQuery(startRow, startCol, goalRow, goalCol);
+    while (state == QueryState::Running) {
+        state = stepQuery(std::numeric_limits<int>::max());
+    }
+    if (state != QueryState::Found) {
+        queryState = QueryState::Idle;
+        return false;
+    }
+    takeWaypoints(waypoints);
+    return true;
+}
+
+PathCell HierarchicalPathfinder::queryCell(int node) const {
+    if (node == totalNodes) return PathCell{ queryStartRow, queryStartCol };
+    if (node == totalNodes + 1) return PathCell{ queryGoalRow, queryGoalCol };
+    return nodeCells[node];
+}
+
+void HierarchicalPathfinder::relaxQuery(int node, int newCost, int via) {
+    if (stamp[node] == generation && cost[node] <= newCost) return;
+    stamp[node] = generation;
+    cost[node] = newCost;
+    parent[node] = via;
+    const PathCell cell = queryCell(node);
+    openList.push_back(HeapEntry{ newCost + manhattan(cell.row, cell.col, queryGoalRow, queryGoalCol), newCost, node });
+    std::push_heap(openList.begin(), openList.end(), openListAfter);
+}
+
+HierarchicalPathfinder::QueryState HierarchicalPathfinder::beginQuery(int startRow, int startCol, int goalRow, int goalCol) {
+    openList.clear();
+    queryState = QueryState::NotFound;
+    if (!built || !isOpen(startRow, startCol) || !isOpen(goalRow, goalCol)) return queryState;
+
+    queryStartRow = startRow;
+    queryStartCol = startCol;
+    queryGoalRow = goalRow;
+    queryGoalCol = goalCol;
+    const int startCluster = clusterAt(startRow, startCol);
+    queryGoalCluster = clusterAt(goalRow, goalCol);
+    queryVersion = builtVersion;
+    const Cluster& from = clusters[startCluster];
+    const Cluster& to = clusters[queryGoalCluster];
+    const int START = totalNodes, GOAL = totalNodes + 1;
+
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    stamp[START] = generation;
+    cost[START] = 0;
+    parent[START] = -1;
+    if (startRow == goalRow && startCol == goalCol) {
+        relaxQuery(GOAL, 0, START);
+        queryState = QueryState::Running;
+        return queryState;
+    }
+
+    // Connect the goal to its cluster's entrances
+    clusterBfs(to, goalRow, goalCol, bfsDistance, bfsQueue);
+    goalScratch.resize(to.nodes.size());
+    for (size_t j = 0; j < to.nodes.size(); ++j) {
+        goalScratch[j] = bfsDistance[(to.nodes[j].row - to.row0) * to.cols + (to.nodes[j].col - to.col0)];
+    }
+
+    // Expand the start here, while its distances are in the BFS scratch, so later steps
+    // need nothing but the open list (refineSegment may reuse the scratch in between)
+    clusterBfs(from, startRow, startCol, bfsDistance, bfsQueue);
+    ++expandedNodes;
+    for (size_t j = 0; j < from.nodes.size(); ++j) {
+        const std::uint16_t d = bfsDistance[(from.nodes[j].row - from.row0) * from.cols + (from.nodes[j].col - from.col0)];
+        if (d != NO_PATH) relaxQuery(nodeOffset[startCluster] + static_cast<int>(j), d, START);
+    }
+    if (startCluster == queryGoalCluster) {
+        const std::uint16_t d = bfsDistance[(goalRow - from.row0) * from.cols + (goalCol - from.col0)];
+        if (d != NO_PATH) relaxQuery(GOAL, d, START);
+    }
+    queryState = QueryState::Running;
+    return queryState;
+}
+
+HierarchicalPathfinder::QueryState HierarchicalPathfinder::stepQuery(int maxExpansions) {
+    if (queryState != QueryState::Running) return queryState;
+    if (builtVersion != queryVersion || !isUpToDate()) {
+        // Node ids and distances changed under the query
+        queryState = QueryState::NotFound;
+        return queryState;
+    }
+
+    const int GOAL = totalNodes + 1;
+    for (int i = 0; i < maxExpansions; ++i) {
+        if (openList.empty()) {
+            queryState = QueryState::NotFound;
+            break;
+        }
+        std::pop_heap(openList.begin(), openList.end(), openListAfter);
+        const HeapEntry entry = openList.back();
+        openList.pop_back();
+        if (entry.cost != cost[entry.node]) continue; // Stale duplicate
+        if (entry.node == GOAL) {
+            queryState = QueryState::Found;
+            break;
+        }
+        ++expandedNodes;
+
+        const int index = nodeCluster[entry.node];
+        const Cluster& cluster = clusters[index];
+        const int local = entry.node - nodeOffset[index];
+        const size_t n = cluster.nodes.size();
+        const std::uint16_t* row = &cluster.distance[local * n];
+        for (size_t j = 0; j < n; ++j) {
+            if (row[j] != NO_PATH && static_cast<int>(j) != local) relaxQuery(nodeOffset[index] + static_cast<int>(j), entry.cost + row[j], entry.node);
+        }
+        int neighbour;
+        const int linked = linkedNode(index, local, neighbour);
+        relaxQuery(nodeOffset[neighbour] + linked, entry.cost + 1, entry.node);
+        if (index == queryGoalCluster && goalScratch[local] != NO_PATH) {
+            relaxQuery(GOAL, entry.cost + goalScratch[local], entry.node);
+        }
+    }
+    return queryState;
+}
+
+void HierarchicalPathfinder::takeWaypoints(std::vector<PathCell>& waypoints) {
+    waypoints.clear();
+    if (queryState == QueryState::Found) {
+        for (int node = totalNodes + 1; node >= 0; node = parent[node]) {
+            const PathCell cell = queryCell(node);
+            if (waypoints.empty() || waypoints.back().row != cell.row || waypoints.back().col != cell.col) {
+                waypoints.push_back(cell);
+            }
+            if (node == totalNodes) break;
+        }
+        std::reverse(waypoints.begin(), waypoints.end());
+    }
+    queryState = QueryState::Idle;
+}
+
+bool HierarchicalPathfinder::refineSegment(const PathCell& from, const PathCell& to, std::vector<PathCell>& cells) {
+    cells.clear();
+    if (from.row == to.row && from.col == to.col) return true;
+    if (manhattan(from.row, from.col, to.row, to.col) == 1) {
+        if (!isOpen(to.row, to.col)) return false;
+        cells.push_back(to);
+        return true;
+    }
+    const int index = clusterAt(from.row, from.col);
+    if (!built || index != clusterAt(to.row, to.col)) return false;
+
+    // Distances to `to`, then walk downhill from `from`
+    const Cluster& cluster = clusters[index];
+    clusterBfs(cluster, to.row, to.col, bfsDistance, bfsQueue);
+    int r = from.row - cluster.row0, c = from.col - cluster.col0;
+    std::uint16_t remaining = bfsDistance[r * cluster.cols + c];
+    if (remaining == NO_PATH) return false;
+    while (remaining > 0) {
+        for (int d = 0; d < 4; ++d) {
+            const int nr = r + STEP_ROW[d], nc = c + STEP_COL[d];
+            if (nr < 0 || nr >= cluster.rows || nc < 0 || nc >= cluster.cols) continue;
+            if (bfsDistance[nr * cluster.cols + nc] == remaining - 1) {
+                r = nr;
+                c = nc;
+                break;
+            }
+        }
+        --remaining;
+        cells.push_back(PathCell{ cluster.row0 + r, cluster.col0 + c });
+    }
+    return true;
+}
+
+bool HierarchicalPathfinder::findFullPath(int startRow, int startCol, int goalRow, int goalCol, std::vector<PathCell>& path) {
+    std::vector<PathCell> waypoints;
+    path.clear();
+    if (!findPath(startRow, startCol, goalRow, goalCol, waypoints)) return false;
+    path.push_back(waypoints.front());
+    std::vector<PathCell> leg;
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        if (!refineSegment(waypoints[i - 1], waypoints[i], leg)) {
+            path.clear();
+            return false;
+        }
+        path.insert(path.end(), leg.begin(), leg.end());
+    }
+    return true;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Config.h" // For HPA_CLUSTER_SIZE
+#include "Pathfinder.h" // For PathCell
+#include <cstdint>
+#include <vector>
+
+class Maze; // Forward declaration
+
+// HPA* over the maze: the grid is cut into square clusters, every open run along a cluster
+// border gets one or two entrances (a node on each side), and each cluster stores the
+// in-cluster path lengths between its entrance nodes. Long routes are searched on that
+// small abstract graph and come back as waypoints; consecutive waypoints are either
+// adjacent or inside one cluster, and refineSegment() expands a leg to cells when needed.
+// Routes are near-optimal rather than shortest (they always pass through entrances).
+class HierarchicalPathfinder {
+public:
+    enum class QueryState { Idle, Running, Found, NotFound };
+
+    explicit HierarchicalPathfinder(const Maze& maze, int clusterSize = HPA_CLUSTER_SIZE);
+
+    // Build every cluster from scratch. threadCount == 0 uses all hardware threads.
+    void build(unsigned threadCount = 0);
+
+    // Record a wall change at (row, col); the clusters it touches are rebuilt by rebuildDirty()
+    void markDirty(int row, int col);
+
+    // Rebuild the clusters marked dirty, plus their neighbours (they share changed borders)
+    void rebuildDirty(unsigned threadCount = 0);
+
+    // True if built and no wall changed since; stale hierarchies must not be queried
+    bool isUpToDate() const;
+
+    // Waypoints from start to goal (both included). Returns false if either end is blocked
+    // or no route exists. Runs to completion and ends any query in progress.
+    bool findPath(int startRow, int startCol, int goalRow, int goalCol, std::vector<PathCell>& waypoints);
+
+    // findPath in slices, for callers on a frame budget: beginQuery, then stepQuery until it
+    // stops returning Running, then takeWaypoints. One query at a time. A query fails if the
+    // hierarchy is rebuilt before it finishes.
+    QueryState beginQuery(int startRow, int startCol, int goalRow, int goalCol);
+    QueryState stepQuery(int maxExpansions);
+    // Route of a Found query; clears waypoints otherwise. Ends the query either way.
+    void takeWaypoints(std::vector<PathCell>& waypoints);
+
+    // Expand one leg between consecutive waypoints into every cell, `from` excluded
+    bool refineSegment(const PathCell& from, const PathCell& to, std::vector<PathCell>& cells);
+
+    // Waypoints refined into a full cell path
+    bool findFullPath(int startRow, int startCol, int goalRow, int goalCol, std::vector<PathCell>& path);
+
+    int getClusterSize() const { return clusterSize; }
+    int getClusterCount() const { return static_cast<int>(clusters.size()); }
+    int getNodeCount() const { return totalNodes; }
+    double getBuildMilliseconds() const { return buildMilliseconds; }
+    std::uint64_t getExpandedNodes() const { return expandedNodes; }
+
+private:
+    static constexpr std::uint16_t NO_PATH = 0xFFFF;
+
+    // Cluster sides, in the order their entrance nodes are stored
+    enum Side { Top = 0, Bottom = 1, Left = 2, Right = 3 };
+
+    struct Cluster {
+        int row0, col0, rows, cols;       // Cell rectangle
+        std::vector<PathCell> nodes;      // Entrance cells on this side of each border
+        int sideStart[5];                 // nodes[sideStart[s] .. sideStart[s + 1]) lie on side s
+        std::vector<std::uint16_t> distance; // nodes x nodes in-cluster path lengths
+        bool dirty;
+    };
+
+    struct HeapEntry {
+        int estimate;
+        int cost;
+        int node;
+    };
+
+    static bool openListAfter(const HeapEntry& a, const HeapEntry& b) {
+        return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+    }
+
+    const Maze& maze;
+    int clusterSize;
+    int clustersX, clustersY;
+    std::vector<Cluster> clusters;
+
+    // Entrance positions per border: rows for the border right of cluster (cx, cy),
+    // columns for the border below it
+    std::vector<std::vector<int>> verticalEntrances;
+    std::vector<std::vector<int>> horizontalEntrances;
+
+    // Global node id = nodeOffset[cluster] + local index, refreshed after (re)builds
+    std::vector<int> nodeOffset;
+    std::vector<int> nodeCluster;
+    std::vector<PathCell> nodeCells;
+    int totalNodes;
+    std::uint64_t builtVersion;
+    bool built;
+    double buildMilliseconds;
+
+    // Query scratch, reused between queries
+    std::vector<int> cost;
+    std::vector<int> parent;
+    std::vector<std::uint32_t> stamp;
+    std::uint32_t generation;
+    std::vector<HeapEntry> openList;
+    std::vector<std::uint16_t> bfsDistance;
+    std::vector<std::int16_t> bfsQueue;
+    std::vector<std::uint16_t> goalScratch; // Goal cluster's entrance distances to the goal
+    std::uint64_t expandedNodes;
+
+    // Query in progress; start and goal are nodes totalNodes and totalNodes + 1
+    QueryState queryState;
+    int queryStartRow, queryStartCol, queryGoalRow, queryGoalCol;
+    int queryGoalCluster;
+    std::uint64_t queryVersion; // builtVersion when the query began
+    PathCell queryCell(int node) const;
+    void relaxQuery(int node, int newCost, int via);
+
+    bool isOpen(int row, int col) const;
+    int clusterAt(int row, int col) const { return (row / clusterSize) * clustersX + col / clusterSize; }
+    void buildCluster(int index, std::vector<std::uint16_t>& distanceScratch, std::vector<std::int16_t>& queueScratch);
+    // Recompute the borders of the given clusters, then rebuild them and their neighbours
+    void rebuild(const std::vector<int>& dirtyClusters, unsigned threadCount);
+    void refreshNodeIds();
+
+    // Breadth-first distances from (row, col) to every cell of the cluster
+    void clusterBfs(const Cluster& cluster, int row, int col,
+                    std::vector<std::uint16_t>& distance, std::vector<std::int16_t>& queue) const;
+    // Local node index across the border from node `local` of cluster `index`
+    int linkedNode(int index, int local, int& neighbourIndex) const;
+};
@@ -0,0 +1,253 @@
+#include "InputRecording.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const char RECORDING_MAGIC[4] = { 'A', 'H', 'R', 'C' };
+    const std::uint32_t RECORDING_VERSION = 2;
+    const size_t HEADER_BYTES = 4 + 4 + 8 + 4 + 4 + 4 + 8;
+
+    // Record kinds; never renumber, old recordings depend on them
+    enum RecordKind : std::uint8_t {
+        RECORD_KEY_DOWN = 0,
+        RECORD_KEY_UP = 1,
+        RECORD_SPECIAL_DOWN = 2,
+        RECORD_SPECIAL_UP = 3,
+        RECORD_LOOK = 4,       // Two zigzag varints: deltaX, deltaY
+        RECORD_CHECKPOINT = 5  // uint64 state checksum
+    };
+
+    void putBytes(std::ofstream& out, std::uint64_t value, int count) {
+        char bytes[8];
+        for (int i = 0; i < count; ++i) {
+            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        out.write(bytes, count);
+    }
+
+    void putVarint(std::ofstream& out, std::uint64_t value) {
+        char bytes[10];
+        int length = 0;
+        do {
+            const std::uint8_t low = value & 0x7F;
+            value >>= 7;
+            bytes[length++] = static_cast<char>(value != 0 ? (low | 0x80) : low);
+        } while (value != 0);
+        out.write(bytes, length);
+    }
+
+    std::uint64_t zigzag(int value) {
+        return (static_cast<std::uint64_t>(static_cast<std::int64_t>(value)) << 1) ^
+               static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> 63);
+    }
+
+    int unzigzag(std::uint64_t value) {
+        return static_cast<int>(static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1));
+    }
+
+    // Bounds-checked reader over the mapped file
+    class ByteReader {
+    public:
+        ByteReader(const unsigned char* data, size_t size) : position(data), end(data + size) {}
+
+        bool atEnd() const { return position == end; }
+
+        bool bytes(int count, std::uint64_t& value) {
+            if (end - position < count) return false;
+            value = 0;
+            for (int i = 0; i < count; ++i) {
+                value |= static_cast<std::uint64_t>(position[i]) << (8 * i);
+            }
+            position += count;
+            return true;
+        }
+
+        bool varint(std::uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && position != end; shift += 7) {
+                const std::uint8_t byte = *position++;
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+    private:
+        const unsigned char* position;
+        const unsigned char* end;
+    };
+}
+
+InputRecording::InputRecording()
+    : header{ 0, 0, 0, 0, 0 }, recordedTick(0), checkpointCursor(0), lastTick(0) {
+}
+
+InputRecording::~InputRecording() {
+    stopRecording();
+}
+
+bool InputRecording::startRecording(const std::string& path, const RecordingHeader& newHeader) {
+    stopRecording();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "[InputRecording] Cannot create " << path << std::endl;
+        return false;
+    }
+    header = newHeader;
+    recordedTick = 0;
+
+    file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    putBytes(file, RECORDING_VERSION, 4);
+    putBytes(file, header.seed, 8);
+    putBytes(file, static_cast<std::uint32_t>(header.swarmSize), 4);
+    putBytes(file, static_cast<std::uint32_t>(header.mazeWidth), 4);
+    putBytes(file, static_cast<std::uint32_t>(header.mazeHeight), 4);
+    putBytes(file, header.mazeHash, 8);
+    file.flush();
+    return true;
+}
+
+void InputRecording::stopRecording() {
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+void InputRecording::writeRecord(std::uint8_t kind, int tick) {
+    // Ticks only move forward; the delta keeps most records at three bytes or less
+    const int delta = tick > recordedTick ? tick - recordedTick : 0;
+    recordedTick += delta;
+    file.put(static_cast<char>(kind));
+    putVarint(file, static_cast<std::uint64_t>(delta));
+}
+
+void InputRecording::record(const InputEvent& event) {
+    if (!file.is_open()) return;
+    switch (event.type) {
+        case InputEventType::KeyDown:
+            writeRecord(RECORD_KEY_DOWN, event.tick);
+            file.put(static_cast<char>(event.key));
+            break;
+        case InputEventType::KeyUp:
+            writeRecord(RECORD_KEY_UP, event.tick);
+            file.put(static_cast<char>(event.key));
+            break;
+        case InputEventType::KeyPress:
+            writeRecord(RECORD_KEY_DOWN, event.tick);
+            file.put(static_cast<char>(event.key));
+            writeRecord(RECORD_KEY_UP, event.tick);
+            file.put(static_cast<char>(event.key));
+            break;
+        case InputEventType::MouseLook:
+            writeRecord(RECORD_LOOK, event.tick);
+            putVarint(file, zigzag(event.deltaX));
+            putVarint(file, zigzag(event.deltaY));
+            break;
+        case InputEventType::SpecialKeyDown:
+            writeRecord(RECORD_SPECIAL_DOWN, event.tick);
+            file.put(static_cast<char>(event.key));
+            break;
+        case InputEventType::SpecialKeyUp:
+            writeRecord(RECORD_SPECIAL_UP, event.tick);
+            file.put(static_cast<char>(event.key));
+            break;
+    }
+}
+
+void InputRecording::recordCheckpoint(int tick, std::uint64_t checksum) {
+    if (!file.is_open()) return;
+    writeRecord(RECORD_CHECKPOINT, tick);
+    putBytes(file, checksum, 8);
+    file.flush(); // A crash loses at most the input since the last checkpoint
+}
+
+bool InputRecording::loadFromFile(const std::string& path) {
+    events.clear();
+    checkpoints.clear();
+    checkpointCursor = 0;
+    lastTick = 0;
+
+    MappedFile mapped;
+    if (!mapped.open(path)) {
+        std::cerr << "[InputRecording] Cannot open recording " << path << std::endl;
+        return false;
+    }
+    auto reject = [&path](const char* reason) {
+        std::cerr << "[InputRecording] Rejected " << path << ": " << reason << std::endl;
+        return false;
+    };
+
+    if (mapped.size() < HEADER_BYTES) return reject("truncated header");
+    if (std::memcmp(mapped.data(), RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) return reject("not a recording");
+    ByteReader reader(mapped.data() + sizeof(RECORDING_MAGIC), mapped.size() - sizeof(RECORDING_MAGIC));
+    std::uint64_t version, seed, swarmSize, mazeWidth, mazeHeight, mazeHash;
+    reader.bytes(4, version);
+    reader.bytes(8, seed);
+    reader.bytes(4, swarmSize);
+    reader.bytes(4, mazeWidth);
+    reader.bytes(4, mazeHeight);
+    reader.bytes(8, mazeHash);
+    if (version != RECORDING_VERSION) return reject("unsupported version");
+    header.seed = seed;
+    header.swarmSize = static_cast<std::int32_t>(swarmSize);
+    header.mazeWidth = static_cast<std::int32_t>(mazeWidth);
+    header.mazeHeight = static_cast<std::int32_t>(mazeHeight);
+    header.mazeHash = mazeHash;
+
+    int tick = 0;
+    while (!reader.atEnd()) {
+        std::uint64_t kind, delta, a, b;
+        if (!reader.bytes(1, kind) || !reader.varint(delta) || delta > 0x7FFFFFFF - static_cast<std::uint64_t>(tick)) {
+            // A truncated last record is what a crash leaves behind; keep everything before it
+            std::cerr << "[InputRecording] " << path << " ends mid-record; replaying up to tick " << tick << std::endl;
+            break;
+        }
+        tick += static_cast<int>(delta);
+
+        InputEvent event = { tick, InputEventType::KeyDown, 0, 0, 0 };
+        bool complete = true;
+        switch (kind) {
+            case RECORD_KEY_DOWN:
+            case RECORD_KEY_UP:
+            case RECORD_SPECIAL_DOWN:
+            case RECORD_SPECIAL_UP:
+                complete = reader.bytes(1, a);
+                event.key = static_cast<unsigned char>(a);
+                event.type = kind == RECORD_KEY_DOWN ? InputEventType::KeyDown
+                           : kind == RECORD_KEY_UP ? InputEventType::KeyUp
+                           : kind == RECORD_SPECIAL_DOWN ? InputEventType::SpecialKeyDown
+                           : InputEventType::SpecialKeyUp;
+                break;
+            case RECORD_LOOK:
+                complete = reader.varint(a) && reader.varint(b);
+                event.type = InputEventType::MouseLook;
+                event.deltaX = unzigzag(a);
+                event.deltaY = unzigzag(b);
+                break;
+            case RECORD_CHECKPOINT:
+                complete = reader.bytes(8, a);
+                if (complete) checkpoints.push_back(Checkpoint{ tick, a });
+                break;
+            default:
+                return reject("unknown record kind");
+        }
+        if (!complete) {
+            std::cerr << "[InputRecording] " << path << " ends mid-record; replaying up to tick " << tick << std::endl;
+            break;
+        }
+        if (kind != RECORD_CHECKPOINT) events.push_back(event);
+        lastTick = tick;
+    }
+    return true;
+}
+
+CheckpointResult InputRecording::checkCheckpoint(int tick, std::uint64_t checksum) {
+    while (checkpointCursor < checkpoints.size() && checkpoints[checkpointCursor].tick < tick) {
+        ++checkpointCursor;
+    }
+    if (checkpointCursor >= checkpoints.size() || checkpoints[checkpointCursor].tick != tick) {
+        return CheckpointResult::None;
+    }
+    return checkpoints[checkpointCursor++].checksum == checksum ? CheckpointResult::Match : CheckpointResult::Mismatch;
+}
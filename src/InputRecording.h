@@ -0,0 +1,75 @@
+#pragma once
+
+#include "InputScript.h" // For InputEvent
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// What a recording was made with; a replay must start from the same state
+struct RecordingHeader {
+    std::uint64_t seed;  // Game seed every subsystem's Random stream derives from
+    std::int32_t swarmSize;
+    std::int32_t mazeWidth, mazeHeight;
+    std::uint64_t mazeHash; // Maze::contentHash of the level
+};
+
+enum class CheckpointResult {
+    None,    // No checkpoint was recorded for this tick
+    Match,
+    Mismatch // The replay has diverged from the recorded run
+};
+
+// Compact binary log of a run's input, for replaying it bit for bit. The simulation runs in
+// fixed steps and all randomness comes from the game seed, so the header plus every input
+// event (stamped with the step it arrived before) reproduces the run exactly. Every few
+// steps a checksum of the simulation state is stored too, so a replay can tell where it
+// stopped matching. Events are appended and flushed as they happen, so a crash or a killed
+// process still leaves a usable file.
+//
+// Layout (little endian): "AHRC", uint32 version, the header fields, then records of one
+// kind byte, a varint tick delta from the previous record and the kind's payload.
+class InputRecording {
+public:
+    InputRecording();
+    ~InputRecording();
+
+    // Start writing to path. Returns false if the file cannot be created.
+    bool startRecording(const std::string& path, const RecordingHeader& header);
+    void stopRecording();
+    bool isRecording() const { return file.is_open(); }
+
+    void record(const InputEvent& event);
+    void recordCheckpoint(int tick, std::uint64_t checksum);
+
+    // Read a whole recording for replay. Returns false on a read or format error.
+    bool loadFromFile(const std::string& path);
+
+    const RecordingHeader& getHeader() const { return header; }
+    const std::vector<InputEvent>& getEvents() const { return events; }
+    int getLastTick() const { return lastTick; } // Last event or checkpoint of the loaded run
+
+    // Compare a replayed state against the checkpoint recorded for tick. Ticks must be
+    // checked in increasing order.
+    CheckpointResult checkCheckpoint(int tick, std::uint64_t checksum);
+
+private:
+    struct Checkpoint {
+        int tick;
+        std::uint64_t checksum;
+    };
+
+    RecordingHeader header;
+
+    // Recording
+    std::ofstream file;
+    int recordedTick; // Tick of the last record written, for the deltas
+
+    // Replay
+    std::vector<InputEvent> events;
+    std::vector<Checkpoint> checkpoints;
+    size_t checkpointCursor;
+    int lastTick;
+
+    void writeRecord(std::uint8_t kind, int tick);
+};
@@ -0,0 +1,93 @@
+#include "InputScript.h"
+#include "InputHandler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+InputScript::InputScript() : cursor(0) {}
+
+bool InputScript::loadFromFile(const std::string& path) {
+    events.clear();
+    cursor = 0;
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "[InputScript] Cannot open script " << path << std::endl;
+        return false;
+    }
+
+    std::vector<InputEvent> parsed;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string action;
+        InputEvent event = { 0, InputEventType::KeyDown, 0, 0, 0 };
+        if (!(fields >> event.tick)) {
+            if (fields.eof() && line.find_first_not_of(" \t\r") == std::string::npos) continue; // Blank line
+            std::cerr << "[InputScript] " << path << ":" << lineNumber << ": expected a tick" << std::endl;
+            return false;
+        }
+
+        bool valid = event.tick >= 0 && static_cast<bool>(fields >> action);
+        if (valid && action == "look") {
+            event.type = InputEventType::MouseLook;
+            valid = static_cast<bool>(fields >> event.deltaX >> event.deltaY);
+        } else if (valid) {
+            std::string key;
+            valid = static_cast<bool>(fields >> key) && key.size() == 1;
+            event.key = valid ? static_cast<unsigned char>(key[0]) : 0;
+            if (action == "down") event.type = InputEventType::KeyDown;
+            else if (action == "up") event.type = InputEventType::KeyUp;
+            else if (action == "press") event.type = InputEventType::KeyPress;
+            else valid = false;
+        }
+        if (!valid) {
+            std::cerr << "[InputScript] " << path << ":" << lineNumber << ": cannot parse '" << line << "'" << std::endl;
+            return false;
+        }
+        parsed.push_back(event);
+    }
+
+    std::stable_sort(parsed.begin(), parsed.end(),
+                     [](const InputEvent& a, const InputEvent& b) { return a.tick < b.tick; });
+    events.swap(parsed);
+    return true;
+}
+
+void InputScript::setEvents(const std::vector<InputEvent>& newEvents) {
+    events = newEvents;
+    cursor = 0;
+}
+
+void InputScript::dispatch(int tick, InputHandler& input) {
+    for (; cursor < events.size() && events[cursor].tick <= tick; ++cursor) {
+        const InputEvent& event = events[cursor];
+        switch (event.type) {
+            case InputEventType::KeyDown:
+                input.injectKey(event.key, true);
+                break;
+            case InputEventType::KeyUp:
+                input.injectKey(event.key, false);
+                break;
+            case InputEventType::KeyPress:
+                input.injectKey(event.key, true);
+                input.injectKey(event.key, false);
+                break;
+            case InputEventType::MouseLook:
+                input.injectMouseLook(event.deltaX, event.deltaY);
+                break;
+            case InputEventType::SpecialKeyDown:
+                input.injectSpecialKey(event.key, true);
+                break;
+            case InputEventType::SpecialKeyUp:
+                input.injectSpecialKey(event.key, false);
+                break;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class InputHandler; // Forward declaration
+
+// What a scripted input event does
+enum class InputEventType {
+    KeyDown,   // Key held from this tick on
+    KeyUp,     // Key released
+    KeyPress,  // Down and up on the same tick, for one-shot actions like 'e'
+    MouseLook, // Mouse moved by (deltaX, deltaY) pixels
+    SpecialKeyDown, // GLUT special key (arrows); only found in recordings
+    SpecialKeyUp
+};
+
+struct InputEvent {
+    int tick;
+    InputEventType type;
+    unsigned char key;
+    int deltaX, deltaY;
+};
+
+// Timed input for headless runs, fed to the InputHandler as if it came from GLUT. Events
+// come from a text script or from an InputRecording. A script is a text file with one event per line; '#' starts a comment:
+//
+//     # tick  event  arguments
+//     0      down   w
+//     90     look   120 0
+//     240    up     w
+//     241    press  e
+//
+// Events are replayed in tick order; events on the same tick keep their file order.
+class InputScript {
+public:
+    InputScript();
+
+    // Parse a script. Returns false (and leaves the script empty) on a read or syntax error.
+    bool loadFromFile(const std::string& path);
+
+    // Replay these events instead, e.g. those of an InputRecording; must be in tick order
+    void setEvents(const std::vector<InputEvent>& newEvents);
+
+    // Send every event due at or before tick to input
+    void dispatch(int tick, InputHandler& input);
+
+    // Start again from the first event
+    void rewind() { cursor = 0; }
+
+    int getEventCount() const { return static_cast<int>(events.size()); }
+    bool isFinished() const { return cursor >= events.size(); }
+
+private:
+    std::vector<InputEvent> events;
+    size_t cursor; // Next event to send
+};
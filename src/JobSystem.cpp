@@ -0,0 +1,107 @@
+#include "JobSystem.h"
+#include "Trace.h"
+
+namespace {
+    // Which system's worker this thread is, if any
+    thread_local const JobSystem* workerSystem = nullptr;
+    thread_local unsigned workerIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned workerCount)
+    : queueCount(0), queuedJobs(0), running(true) {
+    if (workerCount == 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 0;
+    }
+    queueCount = workerCount + 1;
+    queues.reset(new WorkQueue[queueCount]);
+    workers.reserve(workerCount);
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false);
+    }
+    sleepCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned JobSystem::currentQueue() const {
+    return workerSystem == this ? workerIndex : 0;
+}
+
+void JobSystem::push(const Job& job) {
+    WorkQueue& queue = queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+}
+
+void JobSystem::wake() {
+    if (workers.empty()) return;
+    // Taking the lock orders this with a worker that is about to sleep, so no wakeup is lost
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    sleepCondition.notify_all();
+}
+
+bool JobSystem::runOne(unsigned self) {
+    Job job;
+    bool found = false;
+    {
+        // Own queue first, newest job: its data is most likely still in cache
+        WorkQueue& own = queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            found = true;
+        }
+    }
+    for (unsigned k = 1; !found && k < queueCount; ++k) {
+        // Steal the oldest job of the next non-empty queue
+        WorkQueue& victim = queues[(self + k) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    job.invoke(job.callable, job.begin, job.end);
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    const unsigned self = currentQueue();
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        if (!runOne(self)) {
+            // Remaining jobs are running elsewhere
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    workerSystem = this;
+    workerIndex = index;
+    TRACE_THREAD_NAME("Job worker " + std::to_string(index));
+    while (running.load(std::memory_order_relaxed)) {
+        if (runOne(index)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]() {
+            return !running.load(std::memory_order_relaxed) || queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
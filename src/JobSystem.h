@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts unfinished jobs; JobSystem::wait() returns once it drops to zero
+struct JobCounter {
+    std::atomic<int> pending{ 0 };
+};
+
+// Small work-stealing scheduler. Every worker thread, plus the thread that owns the system
+// (queue 0), has its own deque: owners push and pop at the back, idle threads steal from
+// the front of someone else's. A waiting thread runs jobs instead of blocking, so with no
+// workers everything simply runs inline. Jobs hold a pointer to the caller's callable, not a
+// copy, so submitting never allocates beyond deque growth; the callable must outlive the wait.
+// Only the owning thread and the workers themselves may submit.
+class JobSystem {
+public:
+    // workerCount extra threads; 0 means one fewer than the hardware threads
+    explicit JobSystem(unsigned workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Queue fn() as one job counted by counter. fn is referenced, not copied, so it must
+    // be a named object that lives until wait(counter) returns.
+    template <typename Fn>
+    void run(JobCounter& counter, const Fn& fn) {
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+        push(Job{ &invokeTask<Fn>, &fn, 0, 0, &counter });
+        wake();
+    }
+    template <typename Fn>
+    void run(JobCounter& counter, const Fn&& fn) = delete;
+
+    // Call fn(rangeBegin, rangeEnd) over [begin, end) in chunks of at most grain items,
+    // spread over every thread, and return when all chunks are done
+    template <typename Fn>
+    void parallelFor(int begin, int end, int grain, const Fn& fn) {
+        JobCounter counter;
+        if (grain < 1) grain = 1;
+        for (int chunk = begin; chunk < end; chunk += grain) {
+            counter.pending.fetch_add(1, std::memory_order_relaxed);
+            push(Job{ &invokeRange<Fn>, &fn, chunk, chunk + grain < end ? chunk + grain : end, &counter });
+        }
+        wake();
+        wait(counter);
+    }
+
+    // Run queued jobs on this thread until counter reaches zero
+    void wait(JobCounter& counter);
+
+    // Threads that run jobs, including the owning thread
+    unsigned getThreadCount() const { return queueCount; }
+
+private:
+    struct Job {
+        void (*invoke)(const void* callable, int begin, int end);
+        const void* callable;
+        int begin, end;
+        JobCounter* counter;
+    };
+
+    // One per thread, on its own cache line so owners and thieves do not false-share
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    template <typename Fn>
+    static void invokeTask(const void* callable, int, int) { (*static_cast<const Fn*>(callable))(); }
+
+    template <typename Fn>
+    static void invokeRange(const void* callable, int begin, int end) { (*static_cast<const Fn*>(callable))(begin, end); }
+
+    unsigned queueCount;
+    std::unique_ptr<WorkQueue[]> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queuedJobs;
+    std::atomic<bool> running;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    void workerLoop(unsigned index);
+    // Queue of the calling thread: its own for workers, queue 0 for everyone else
+    unsigned currentQueue() const;
+    void push(const Job& job);
+    void wake();
+    // Pop from queue self, else steal from another; runs the job. False if none was found.
+    bool runOne(unsigned self);
+};
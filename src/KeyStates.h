@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cctype>
+#include <unordered_map>
+
+// Which keyboard and GLUT special keys are held, as InputHandler tracks them. Needs no
+// GLUT, so the bench can time the per-step queries without a window.
+class KeyStates {
+public:
+    // Letters are stored lowercase, so 'W' and 'w' are the same key
+    void setKey(unsigned char key, bool pressed) { keys[lower(key)] = pressed; }
+    void setSpecialKey(int key, bool pressed) { specialKeys[key] = pressed; }
+
+    bool isKeyPressed(unsigned char key) const {
+        auto it = keys.find(lower(key));
+        return it != keys.end() && it->second;
+    }
+
+    bool isSpecialKeyPressed(int key) const {
+        auto it = specialKeys.find(key);
+        return it != specialKeys.end() && it->second;
+    }
+
+private:
+    std::unordered_map<unsigned char, bool> keys;
+    std::unordered_map<int, bool> specialKeys;
+
+    static unsigned char lower(unsigned char key) { return static_cast<unsigned char>(std::tolower(key)); }
+};
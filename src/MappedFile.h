@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (CreateFileMapping on Windows, mmap elsewhere)
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file; returns false if it is missing, empty or cannot be mapped
+    bool open(const std::string& path);
+
+    // Unmaps the file (also done by the destructor)
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+    size_t size() const { return length; }
+
+private:
+    void* mapping;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;    // HANDLE
+    void* mappingHandle; // HANDLE
+#endif
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cmath>
+
+// Column-major 4x4 matrix helpers matching the GLU conventions, for shaders that take
+// their matrices from uniforms instead of the fixed-function matrix stack
+namespace MathUtil {
+
+    // Same matrix as gluPerspective
+    inline void perspective(float out[16], float fovYDegrees, float aspect, float zNear, float zFar) {
+        const float f = 1.0f / std::tan(fovYDegrees * 0.5f * 3.14159265f / 180.0f);
+        for (int i = 0; i < 16; ++i) out[i] = 0.0f;
+        out[0] = f / aspect;
+        out[5] = f;
+        out[10] = (zFar + zNear) / (zNear - zFar);
+        out[11] = -1.0f;
+        out[14] = 2.0f * zFar * zNear / (zNear - zFar);
+    }
+
+    // Same matrix as gluLookAt
+    inline void lookAt(float out[16], float eyeX, float eyeY, float eyeZ,
+                       float centerX, float centerY, float centerZ,
+                       float upX, float upY, float upZ) {
+        float fx = centerX - eyeX, fy = centerY - eyeY, fz = centerZ - eyeZ;
+        const float fLength = std::sqrt(fx * fx + fy * fy + fz * fz);
+        fx /= fLength; fy /= fLength; fz /= fLength;
+
+        // side = forward x up
+        float sx = fy * upZ - fz * upY, sy = fz * upX - fx * upZ, sz = fx * upY - fy * upX;
+        const float sLength = std::sqrt(sx * sx + sy * sy + sz * sz);
+        sx /= sLength; sy /= sLength; sz /= sLength;
+
+        // u = side x forward
+        const float ux = sy * fz - sz * fy, uy = sz * fx - sx * fz, uz = sx * fy - sy * fx;
+
+        out[0] = sx;  out[4] = sy;  out[8] = sz;   out[12] = -(sx * eyeX + sy * eyeY + sz * eyeZ);
+        out[1] = ux;  out[5] = uy;  out[9] = uz;   out[13] = -(ux * eyeX + uy * eyeY + uz * eyeZ);
+        out[2] = -fx; out[6] = -fy; out[10] = -fz; out[14] = fx * eyeX + fy * eyeY + fz * eyeZ;
+        out[3] = 0.0f; out[7] = 0.0f; out[11] = 0.0f; out[15] = 1.0f;
+    }
+}
@@ -1,62 +1,536 @@
-#include "Maze.h"
-#include "Config.h"  // For MAZE_SIZE
-#include <iostream>   // For debugging
-
-// Constructor - initializes maze layout and start/end positions
-Maze::Maze() {
-    initializeLayout();
-}
-
-// Initialize the hardcoded maze layout
-void Maze::initializeLayout() {
-    // Example of a hardcoded maze layout; adjust as needed
-    // Use 'W' for walls and ' ' for paths
-    char maze[MAZE_SIZE][MAZE_SIZE] = {
-        {'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W'},
-        {'W', ' ', ' ', 'W', ' ', ' ', ' ', ' ', ' ', 'W'},
-        {'W', ' ', 'W', 'W', 'W', 'W', 'W', 'W', ' ', 'W'},
-        {'W', ' ', ' ', ' ', ' ', 'W', ' ', ' ', ' ', 'W'},
-        {'W', ' ', 'W', 'W', ' ', 'W', ' ', 'W', ' ', 'W'},
-        {'W', ' ', ' ', 'W', ' ', ' ', ' ', ' ', ' ', 'W'},
-        {'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W', 'W'}
-    };
-
-    // Copy maze layout into the class member
-    for (int i = 0; i < MAZE_SIZE; ++i) {
-        for (int j = 0; j < MAZE_SIZE; ++j) {
-            layout[i][j] = maze[i][j];
-        }
-    }
-
-    // Hardcode start and end positions (example)
-    startRow = 1; startCol = 1;  // Starting position
-    endRow = 5; endCol = 8;     // Ending position
-}
-
-// Get the character at a specific maze cell (row, col)
-char Maze::getCell(int row, int col) const {
-    if (row >= 0 && row < MAZE_SIZE && col >= 0 && col < MAZE_SIZE) {
-        return layout[row][col];
-    }
-    return ' '; // Return empty space for out-of-bound access
-}
-
-// Check if a cell is a wall
-bool Maze::isWall(int row, int col) const {
-    if (row >= 0 && row < MAZE_SIZE && col >= 0 && col < MAZE_SIZE) {
-        return layout[row][col] == 'W';  // Wall is represented by 'W'
-    }
-    return false; // Out of bounds is not considered a wall
-}
-
-// Get starting position (row, col)
-void Maze::getStartPosition(int& startRowOut, int& startColOut) const {
-    startRowOut = startRow;
-    startColOut = startCol;
-}
-
-// Get ending position (row, col)
-void Maze::getEndPosition(int& endRowOut, int& endColOut) const {
-    endRowOut = endRow;
-    endColOut = endCol;
-}
+#include "Maze.h"
+#include "MappedFile.h"
+#include "Config.h"  // For MAZE_MAX_DIMENSION
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>   // For debugging
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAZE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MAZE_SSE2 0
+#endif
+
+namespace {
+    // Binary maze file layout (native little-endian):
+    //   MazeFileHeader
+    //   tile directory: one std::uint64_t file offset per tile, row-major over the tile grid
+    //   tile data: WORDS_PER_TILE words per tile, 64-byte aligned; identical tiles may share data
+    const char MAZE_FILE_MAGIC[4] = { 'A', 'H', 'M', 'Z' };
+    const std::uint32_t MAZE_FILE_VERSION = 1;
+
+    struct MazeFileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t tileSize;  // Cells per tile side; must equal Maze::TILE_SIZE
+        std::int32_t startRow, startCol;
+        std::int32_t endRow, endCol;
+        std::int32_t keyRow, keyCol; // -1 if the level has no key
+        std::uint32_t reserved;
+        std::uint64_t directoryOffset;
+    };
+
+    static_assert(sizeof(MazeFileHeader) == 56, "MazeFileHeader must stay packed");
+
+    const size_t TILE_BYTES = Maze::WORDS_PER_TILE * sizeof(std::uint64_t);
+
+    std::atomic<std::uint64_t> nextVersion(1);
+
+    // Why the start, exit and key of header are unusable, or nullptr if they are fine: each must
+    // be an open cell inside the maze, except that a level without a key stores -1, -1.
+    // isWall(row, col) is only called for cells inside the maze.
+    template <typename IsWall>
+    const char* markerProblem(const MazeFileHeader& header, IsWall&& isWall) {
+        auto isOpenCell = [&](std::int32_t row, std::int32_t col) {
+            return row >= 0 && col >= 0 && static_cast<std::uint32_t>(row) < header.height &&
+                   static_cast<std::uint32_t>(col) < header.width && !isWall(row, col);
+        };
+        if (!isOpenCell(header.startRow, header.startCol)) return "start is not an open cell";
+        if (!isOpenCell(header.endRow, header.endCol)) return "exit is not an open cell";
+        if ((header.keyRow != -1 || header.keyCol != -1) && !isOpenCell(header.keyRow, header.keyCol)) {
+            return "key is not an open cell";
+        }
+        return nullptr;
+    }
+}
+
+// Constructor - initializes maze layout and start/end positions
+Maze::Maze()
+    : width(0), height(0), tilesX(0), tilesY(0),
+      startRow(0), startCol(0), endRow(0), endCol(0), keyRow(-1), keyCol(-1), version(0) {
+    initializeLayout();
+}
+
+Maze::Maze(int width, int height, bool filled)
+    : width(0), height(0), tilesX(0), tilesY(0),
+      startRow(0), startCol(0), endRow(0), endCol(0), keyRow(-1), keyCol(-1), version(0) {
+    resize(width, height, filled);
+}
+
+Maze::Maze(const Maze& other)
+    : width(other.width), height(other.height), tilesX(other.tilesX), tilesY(other.tilesY),
+      tiles(other.tiles), tileStorage(other.tileStorage), mappedFile(other.mappedFile),
+      startRow(other.startRow), startCol(other.startCol), endRow(other.endRow), endCol(other.endCol),
+      keyRow(other.keyRow), keyCol(other.keyCol), version(other.version) {
+    if (!mappedFile) {
+        bindOwnedTiles();
+    }
+}
+
+Maze& Maze::operator=(const Maze& other) {
+    if (this != &other) {
+        Maze copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Maze::~Maze() = default;
+
+void Maze::touch() {
+    version = nextVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Maze::bindOwnedTiles() {
+    tiles.resize(static_cast<size_t>(tilesX) * tilesY);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        tiles[i] = &tileStorage[i * WORDS_PER_TILE];
+    }
+}
+
+void Maze::detachFromFile() {
+    std::vector<std::uint64_t> storage(tiles.size() * WORDS_PER_TILE);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        std::memcpy(&storage[i * WORDS_PER_TILE], tiles[i], TILE_BYTES);
+    }
+    tileStorage.swap(storage);
+    bindOwnedTiles();
+    mappedFile.reset();
+}
+
+void Maze::resize(int newWidth, int newHeight, bool filled) {
+    if (newWidth < 1 || newHeight < 1 || newWidth > MAZE_MAX_DIMENSION || newHeight > MAZE_MAX_DIMENSION) {
+        throw std::runtime_error("Invalid maze size " + std::to_string(newWidth) + "x" + std::to_string(newHeight));
+    }
+
+    width = newWidth;
+    height = newHeight;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Padding cells past the edge are never read (isWall bounds-checks first)
+    const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    mappedFile.reset();
+    tileStorage.assign(tileCount * WORDS_PER_TILE, filled ? ~std::uint64_t(0) : 0);
+    bindOwnedTiles();
+    touch();
+}
+
+void Maze::setWall(int row, int col, bool wall) {
+    if (static_cast<unsigned>(row) >= static_cast<unsigned>(height) ||
+        static_cast<unsigned>(col) >= static_cast<unsigned>(width)) {
+        return;
+    }
+    if (mappedFile) {
+        detachFromFile();
+    }
+    const size_t tile = static_cast<size_t>(row >> TILE_SHIFT) * tilesX + (col >> TILE_SHIFT);
+    std::uint64_t& word = tileStorage[tile * WORDS_PER_TILE +
+                                      ((row & (TILE_SIZE - 1)) >> 3) * (TILE_SIZE / 8) + ((col & (TILE_SIZE - 1)) >> 3)];
+    const std::uint64_t bit = std::uint64_t(1) << (((row & 7) << 3) | (col & 7));
+    const std::uint64_t updated = wall ? (word | bit) : (word & ~bit);
+    if (updated != word) {
+        word = updated;
+        touch();
+    }
+}
+
+void Maze::setTile(int tileX, int tileY, const std::uint64_t* words) {
+    if (static_cast<unsigned>(tileX) >= static_cast<unsigned>(tilesX) ||
+        static_cast<unsigned>(tileY) >= static_cast<unsigned>(tilesY)) {
+        return;
+    }
+    if (mappedFile) {
+        detachFromFile();
+    }
+    const size_t tile = static_cast<size_t>(tileY) * tilesX + tileX;
+    std::memcpy(&tileStorage[tile * WORDS_PER_TILE], words, TILE_BYTES);
+}
+
+size_t Maze::getMemoryBytes() const {
+    const size_t wallBytes = mappedFile ? mappedFile->size() : tileStorage.size() * sizeof(std::uint64_t);
+    return wallBytes + tiles.size() * sizeof(tiles[0]);
+}
+
+bool Maze::loadFromFile(const std::string& filename) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(filename)) {
+        std::cerr << "[Maze] Cannot open maze file " << filename << std::endl;
+        return false;
+    }
+
+    auto reject = [&filename](const char* reason) {
+        std::cerr << "[Maze] Rejected " << filename << ": " << reason << std::endl;
+        return false;
+    };
+
+    if (file->size() < sizeof(MazeFileHeader)) return reject("truncated header");
+    MazeFileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, MAZE_FILE_MAGIC, sizeof(header.magic)) != 0) return reject("not a maze file");
+    if (header.version != MAZE_FILE_VERSION) return reject("unsupported version");
+    if (header.tileSize != static_cast<std::uint32_t>(TILE_SIZE)) return reject("unsupported tile size");
+    if (header.width < 1 || header.height < 1 ||
+        header.width > static_cast<std::uint32_t>(MAZE_MAX_DIMENSION) ||
+        header.height > static_cast<std::uint32_t>(MAZE_MAX_DIMENSION)) {
+        return reject("invalid dimensions");
+    }
+
+    const int newTilesX = static_cast<int>((header.width + TILE_SIZE - 1) / TILE_SIZE);
+    const int newTilesY = static_cast<int>((header.height + TILE_SIZE - 1) / TILE_SIZE);
+    const size_t tileCount = static_cast<size_t>(newTilesX) * newTilesY;
+    if (header.directoryOffset % sizeof(std::uint64_t) != 0 || header.directoryOffset > file->size() ||
+        tileCount > (file->size() - header.directoryOffset) / sizeof(std::uint64_t)) {
+        return reject("truncated tile directory");
+    }
+
+    // Only the directory is read here; tile pages are faulted in by the first isWall that touches them
+    const unsigned char* base = file->data();
+    std::vector<const std::uint64_t*> newTiles(tileCount);
+    for (size_t i = 0; i < tileCount; ++i) {
+        std::uint64_t offset;
+        std::memcpy(&offset, base + header.directoryOffset + i * sizeof(std::uint64_t), sizeof(offset));
+        if (offset % sizeof(std::uint64_t) != 0 || offset > file->size() || file->size() - offset < TILE_BYTES) {
+            return reject("tile outside the file");
+        }
+        newTiles[i] = reinterpret_cast<const std::uint64_t*>(base + offset);
+    }
+
+    // Read through the new tile table; the maze itself is untouched until everything checks out
+    const char* problem = markerProblem(header, [&](int row, int col) {
+        const std::uint64_t* tile = newTiles[static_cast<size_t>(row >> TILE_SHIFT) * newTilesX + (col >> TILE_SHIFT)];
+        const std::uint64_t word = tile[((row & (TILE_SIZE - 1)) >> 3) * (TILE_SIZE / 8) + ((col & (TILE_SIZE - 1)) >> 3)];
+        return ((word >> (((row & 7) << 3) | (col & 7))) & 1u) != 0;
+    });
+    if (problem) return reject(problem);
+
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    tilesX = newTilesX;
+    tilesY = newTilesY;
+    tiles.swap(newTiles);
+    tileStorage.clear();
+    tileStorage.shrink_to_fit();
+    mappedFile = file;
+    startRow = header.startRow;
+    startCol = header.startCol;
+    endRow = header.endRow;
+    endCol = header.endCol;
+    keyRow = header.keyRow;
+    keyCol = header.keyCol;
+    touch();
+
+    return true;
+}
+
+bool Maze::saveToFile(const std::string& filename) const {
+    MazeFileHeader header;
+    std::memcpy(header.magic, MAZE_FILE_MAGIC, sizeof(header.magic));
+    header.version = MAZE_FILE_VERSION;
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+    header.tileSize = static_cast<std::uint32_t>(TILE_SIZE);
+    header.startRow = startRow;
+    header.startCol = startCol;
+    header.endRow = endRow;
+    header.endCol = endCol;
+    header.keyRow = keyRow;
+    header.keyCol = keyCol;
+    header.reserved = 0;
+    header.directoryOffset = sizeof(MazeFileHeader);
+
+    // Never write a file loadFromFile would reject
+    if (const char* problem = markerProblem(header, [this](int row, int col) { return isWall(row, col); })) {
+        std::cerr << "[Maze] Not writing " << filename << ": " << problem << std::endl;
+        return false;
+    }
+
+    // Tile data starts on a cache line; solid and empty tiles are written once and shared
+    const size_t directoryBytes = tiles.size() * sizeof(std::uint64_t);
+    std::uint64_t nextOffset = (sizeof(MazeFileHeader) + directoryBytes + 63) & ~std::uint64_t(63);
+    const std::uint64_t firstTileOffset = nextOffset;
+    std::vector<std::uint64_t> directory(tiles.size());
+    std::vector<const std::uint64_t*> uniqueTiles;
+    std::uint64_t uniformOffset[2] = { 0, 0 }; // All open, all walls
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const std::uint64_t* tile = tiles[i];
+        const bool allOpen = std::all_of(tile, tile + WORDS_PER_TILE, [](std::uint64_t w) { return w == 0; });
+        const bool allWalls = std::all_of(tile, tile + WORDS_PER_TILE, [](std::uint64_t w) { return w == ~std::uint64_t(0); });
+        if (allOpen || allWalls) {
+            std::uint64_t& shared = uniformOffset[allWalls ? 1 : 0];
+            if (shared == 0) {
+                shared = nextOffset;
+                nextOffset += TILE_BYTES;
+                uniqueTiles.push_back(tile);
+            }
+            directory[i] = shared;
+        } else {
+            directory[i] = nextOffset;
+            nextOffset += TILE_BYTES;
+            uniqueTiles.push_back(tile);
+        }
+    }
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[Maze] Cannot write maze file " << filename << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(directory.data()), static_cast<std::streamsize>(directoryBytes));
+    const std::vector<char> padding(static_cast<size_t>(firstTileOffset - sizeof(MazeFileHeader) - directoryBytes), 0);
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    for (const std::uint64_t* tile : uniqueTiles) {
+        out.write(reinterpret_cast<const char*>(tile), static_cast<std::streamsize>(TILE_BYTES));
+    }
+    return static_cast<bool>(out);
+}
+
+// Initialize the hardcoded maze layout
+void Maze::initializeLayout() {
+    // Example of a hardcoded maze layout; adjust as needed
+    // Use 'W' for walls and ' ' for paths
+    static const char* const rows[] = {
+        "WWWWWWWWWW",
+        "W  W     W",
+        "W WWWWWW W",
+        "W    W   W",
+        "W WW W W W",
+        "W  W     W",
+        "WWWWWWWWWW",
+    };
+    const int rowCount = static_cast<int>(sizeof(rows) / sizeof(rows[0]));
+    const int colCount = static_cast<int>(std::char_traits<char>::length(rows[0]));
+
+    resize(colCount, rowCount, false);
+    for (int r = 0; r < rowCount; ++r) {
+        for (int c = 0; c < colCount; ++c) {
+            setWall(r, c, rows[r][c] == 'W');
+        }
+    }
+
+    // Hardcode start and end positions (example)
+    startRow = 1; startCol = 1;  // Starting position
+    endRow = 5; endCol = 8;     // Ending position
+}
+
+std::uint64_t Maze::contentHash() const {
+    // FNV-1a over the bytes of each value
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](std::uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001B3ULL;
+        }
+    };
+    for (int value : { width, height, startRow, startCol, endRow, endCol, keyRow, keyCol }) {
+        mix(static_cast<std::uint32_t>(value), 4);
+    }
+
+    // Edge tiles hold bits past the last row and column, which are set or not depending on
+    // how the maze was filled; only cells inside the maze count
+    const int blocksPerSide = TILE_SIZE / 8;
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            const std::uint64_t* tile = tiles[static_cast<size_t>(ty) * tilesX + tx];
+            for (int word = 0; word < WORDS_PER_TILE; ++word) {
+                const int row0 = ty * TILE_SIZE + (word / blocksPerSide) * 8;
+                const int col0 = tx * TILE_SIZE + (word % blocksPerSide) * 8;
+                const int rows = std::min(8, height - row0), cols = std::min(8, width - col0);
+                if (rows <= 0 || cols <= 0) continue;
+                std::uint64_t mask = ~std::uint64_t(0);
+                if (rows < 8 || cols < 8) {
+                    const std::uint64_t rowMask = (std::uint64_t(1) << cols) - 1;
+                    mask = 0;
+                    for (int r = 0; r < rows; ++r) mask |= rowMask << (8 * r);
+                }
+                mix(tile[word] & mask, 8);
+            }
+        }
+    }
+    return hash;
+}
+
+// Get starting position (row, col)
+void Maze::getStartPosition(int& startRowOut, int& startColOut) const {
+    startRowOut = startRow;
+    startColOut = startCol;
+}
+
+bool Maze::getKeyPosition(int& keyRowOut, int& keyColOut) const {
+    if (keyRow < 0 || keyCol < 0) return false;
+    keyRowOut = keyRow;
+    keyColOut = keyCol;
+    return true;
+}
+
+// Get ending position (row, col)
+void Maze::getEndPosition(int& endRowOut, int& endColOut) const {
+    endRowOut = endRow;
+    endColOut = endCol;
+}
+
+namespace {
+    // Grid DDA state for one ray: the current cell, the ray parameter t (0 at the origin, 1 at
+    // the target) at which the next column and row boundaries are crossed, and how much t
+    // grows per column or row
+    struct RayWalk {
+        int col, row;
+        int stepCol, stepRow;
+        int remaining; // Cells left to enter, the target cell included
+        float tMaxX, tMaxZ;
+        float tDeltaX, tDeltaZ;
+    };
+
+    const float NEVER = 1e30f; // tMax of an axis the ray does not move along
+
+    RayWalk beginRay(float fromX, float fromZ, float toX, float toZ) {
+        RayWalk walk;
+        walk.col = static_cast<int>(std::floor(fromX));
+        walk.row = static_cast<int>(std::floor(fromZ));
+        const int endCol = static_cast<int>(std::floor(toX));
+        const int endRow = static_cast<int>(std::floor(toZ));
+        walk.remaining = std::abs(endCol - walk.col) + std::abs(endRow - walk.row);
+
+        const float dx = toX - fromX, dz = toZ - fromZ;
+        walk.stepCol = endCol > walk.col ? 1 : (endCol < walk.col ? -1 : 0);
+        walk.stepRow = endRow > walk.row ? 1 : (endRow < walk.row ? -1 : 0);
+        walk.tDeltaX = walk.stepCol != 0 ? 1.0f / std::fabs(dx) : NEVER;
+        walk.tDeltaZ = walk.stepRow != 0 ? 1.0f / std::fabs(dz) : NEVER;
+        walk.tMaxX = walk.stepCol > 0 ? (static_cast<float>(walk.col + 1) - fromX) * walk.tDeltaX
+                   : walk.stepCol < 0 ? (fromX - static_cast<float>(walk.col)) * walk.tDeltaX : NEVER;
+        walk.tMaxZ = walk.stepRow > 0 ? (static_cast<float>(walk.row + 1) - fromZ) * walk.tDeltaZ
+                   : walk.stepRow < 0 ? (fromZ - static_cast<float>(walk.row)) * walk.tDeltaZ : NEVER;
+        return walk;
+    }
+
+    // Cross the nearer boundary; ties go to the row so both walkers agree
+    inline void stepRay(RayWalk& walk) {
+        if (walk.tMaxX < walk.tMaxZ) {
+            walk.col += walk.stepCol;
+            walk.tMaxX += walk.tDeltaX;
+        } else {
+            walk.row += walk.stepRow;
+            walk.tMaxZ += walk.tDeltaZ;
+        }
+        --walk.remaining;
+    }
+}
+
+bool Maze::hasLineOfSight(float fromX, float fromZ, float toX, float toZ) const {
+    RayWalk walk = beginRay(fromX, fromZ, toX, toZ);
+    while (walk.remaining > 0) {
+        stepRay(walk);
+        if (isWall(walk.row, walk.col)) return false;
+    }
+    return true;
+}
+
+void Maze::lineOfSight(const float* fromX, const float* fromZ, const float* toX, const float* toZ,
+                       int count, std::uint64_t* visible) const {
+    std::fill(visible, visible + (count + 63) / 64, std::uint64_t(0));
+    int i = 0;
+#if MAZE_SSE2
+    const __m128i one4 = _mm_set1_epi32(1), zero4 = _mm_setzero_si128();
+    const __m128i maxCol4 = _mm_set1_epi32(width - 1), maxRow4 = _mm_set1_epi32(height - 1);
+    const __m128i tilesX4 = _mm_set1_epi32(tilesX);
+    const __m128i wordMask4 = _mm_set1_epi32(TILE_SIZE / 8 - 1), seven4 = _mm_set1_epi32(7);
+    const __m128 signBit4 = _mm_set1_ps(-0.0f), oneF4 = _mm_set1_ps(1.0f), never4 = _mm_set1_ps(NEVER);
+
+    // Same arithmetic as beginRay, so both walkers visit the same cells
+    const auto floor4 = [](__m128 v) {
+        const __m128i truncated = _mm_cvttps_epi32(v);
+        return _mm_add_epi32(truncated, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), v)));
+    };
+    const auto abs4 = [](__m128i v) {
+        const __m128i sign = _mm_srai_epi32(v, 31);
+        return _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+    };
+    const auto select4 = [](__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        const __m128 fromX4 = _mm_loadu_ps(fromX + i), fromZ4 = _mm_loadu_ps(fromZ + i);
+        const __m128 toX4 = _mm_loadu_ps(toX + i), toZ4 = _mm_loadu_ps(toZ + i);
+        __m128i col4 = floor4(fromX4), row4 = floor4(fromZ4);
+        const __m128i colDelta = _mm_sub_epi32(floor4(toX4), col4), rowDelta = _mm_sub_epi32(floor4(toZ4), row4);
+        __m128i remaining4 = _mm_add_epi32(abs4(colDelta), abs4(rowDelta));
+
+        const __m128i right = _mm_cmpgt_epi32(colDelta, zero4), left = _mm_cmplt_epi32(colDelta, zero4);
+        const __m128i down = _mm_cmpgt_epi32(rowDelta, zero4), up = _mm_cmplt_epi32(rowDelta, zero4);
+        const __m128i stepCol4 = _mm_sub_epi32(left, right), stepRow4 = _mm_sub_epi32(up, down);
+
+        const __m128 tDeltaX4 = select4(_mm_castsi128_ps(_mm_or_si128(left, right)),
+                                        _mm_div_ps(oneF4, _mm_andnot_ps(signBit4, _mm_sub_ps(toX4, fromX4))), never4);
+        const __m128 tDeltaZ4 = select4(_mm_castsi128_ps(_mm_or_si128(up, down)),
+                                        _mm_div_ps(oneF4, _mm_andnot_ps(signBit4, _mm_sub_ps(toZ4, fromZ4))), never4);
+        const __m128 colF = _mm_cvtepi32_ps(col4), rowF = _mm_cvtepi32_ps(row4);
+        __m128 tMaxX4 = select4(_mm_castsi128_ps(right), _mm_mul_ps(_mm_sub_ps(_mm_add_ps(colF, oneF4), fromX4), tDeltaX4),
+                                select4(_mm_castsi128_ps(left), _mm_mul_ps(_mm_sub_ps(fromX4, colF), tDeltaX4), never4));
+        __m128 tMaxZ4 = select4(_mm_castsi128_ps(down), _mm_mul_ps(_mm_sub_ps(_mm_add_ps(rowF, oneF4), fromZ4), tDeltaZ4),
+                                select4(_mm_castsi128_ps(up), _mm_mul_ps(_mm_sub_ps(fromZ4, rowF), tDeltaZ4), never4));
+
+        // Every lane steps each round; finished lanes keep going but are no longer tested
+        int active = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(remaining4, zero4)));
+        int blocked = 0;
+        while (active) {
+            const __m128 alongX = _mm_cmplt_ps(tMaxX4, tMaxZ4);
+            const __m128i alongXi = _mm_castps_si128(alongX);
+            col4 = _mm_add_epi32(col4, _mm_and_si128(alongXi, stepCol4));
+            row4 = _mm_add_epi32(row4, _mm_andnot_si128(alongXi, stepRow4));
+            tMaxX4 = _mm_add_ps(tMaxX4, _mm_and_ps(alongX, tDeltaX4));
+            tMaxZ4 = _mm_add_ps(tMaxZ4, _mm_andnot_ps(alongX, tDeltaZ4));
+            remaining4 = _mm_sub_epi32(remaining4, one4);
+
+            // Tile, word and bit of every lane's cell, as isWall computes them. SSE2 has no
+            // gather, so only the loads are done per lane. Cells outside the maze are open.
+            const __m128i outside = _mm_or_si128(
+                _mm_or_si128(_mm_cmplt_epi32(col4, zero4), _mm_cmplt_epi32(row4, zero4)),
+                _mm_or_si128(_mm_cmpgt_epi32(col4, maxCol4), _mm_cmpgt_epi32(row4, maxRow4)));
+            // Tile rows fit in 16 bits, so madd_epi16 multiplies them by tilesX
+            const __m128i tile4 = _mm_add_epi32(_mm_madd_epi16(_mm_srai_epi32(row4, TILE_SHIFT), tilesX4),
+                                                _mm_srai_epi32(col4, TILE_SHIFT));
+            const __m128i word4 = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(_mm_srai_epi32(row4, 3), wordMask4), 3),
+                                                _mm_and_si128(_mm_srai_epi32(col4, 3), wordMask4));
+            const __m128i bit4 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(row4, seven4), 3), _mm_and_si128(col4, seven4));
+            alignas(16) std::int32_t tile[4], word[4], bit[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(tile), tile4);
+            _mm_store_si128(reinterpret_cast<__m128i*>(word), word4);
+            _mm_store_si128(reinterpret_cast<__m128i*>(bit), bit4);
+            const int testable = active & ~_mm_movemask_ps(_mm_castsi128_ps(outside));
+            for (int lane = 0; lane < 4; ++lane) {
+                if ((testable >> lane) & 1 && (tiles[tile[lane]][word[lane]] >> bit[lane]) & 1u) {
+                    blocked |= 1 << lane;
+                }
+            }
+            active &= ~blocked & _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(remaining4, zero4)));
+        }
+        const std::uint64_t clear = static_cast<std::uint64_t>(~blocked & 0xF);
+        visible[i >> 6] |= clear << (i & 63); // i is a multiple of 4, so the lanes share a word
+    }
+#endif
+    for (; i < count; ++i) {
+        if (hasLineOfSight(fromX[i], fromZ[i], toX[i], toZ[i])) {
+            visible[i >> 6] |= std::uint64_t(1) << (i & 63);
+        }
+    }
+}
@@ -1,41 +1,148 @@
-#pragma once
-
-#include "Config.h" // For MAZE_SIZE
-#include <vector>
-
-class Maze {
-public:
-    // Constructor - Initializes the maze layout and start/end positions
-    Maze();
-
-    // Get the character at a specific maze cell (row, col)
-    char getCell(int row, int col) const;
-
-    // Check if a cell is a wall ('W') at (row, col)
-    bool isWall(int row, int col) const;
-
-    // Get starting position (row, col)
-    void getStartPosition(int& startRow, int& startCol) const;
-
-    // Get ending position (row, col)
-    void getEndPosition(int& endRow, int& endCol) const;
-
-    // Get maze dimensions (width and height are the same for a square maze)
-    int getWidth() const { return MAZE_SIZE; }
-    int getHeight() const { return MAZE_SIZE; }
-
-    // Optional: Load maze from file or generate procedurally
-    // bool loadFromFile(const std::string& filename);
-    // void generateProcedural();
-
-private:
-    // Store the maze layout (2D array of characters)
-    char layout[MAZE_SIZE][MAZE_SIZE];
-
-    // Store start and end positions
-    int startRow, startCol;
-    int endRow, endCol;
-
-    // Initialize the maze layout (hardcoded or procedural generation)
-    void initializeLayout();
-};
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MappedFile; // Forward declaration
+
+// Grid of wall/open cells addressed as (row, col); x = col and z = row in world units.
+// Walls are stored one bit per cell in square tiles of TILE_SIZE cells, each tile 64 words
+// where every word holds an 8x8 block. Nearby rows then share cache lines, and isWall is a
+// couple of shifts and one load through the tile table.
+class Maze {
+public:
+    static const int TILE_SHIFT = 6;
+    static const int TILE_SIZE = 1 << TILE_SHIFT; // Cells per tile side
+    static const int WORDS_PER_TILE = (TILE_SIZE / 8) * (TILE_SIZE / 8);
+
+    // Constructor - Initializes the built-in layout and start/end positions
+    Maze();
+
+    // Empty maze of the given size with every cell a wall (filled) or open.
+    // Throws std::runtime_error if a dimension is not in [1, MAZE_MAX_DIMENSION].
+    Maze(int width, int height, bool filled = true);
+
+    // Copies get their own tile table; a maze loaded from a file shares the mapping
+    Maze(const Maze& other);
+    Maze& operator=(const Maze& other);
+    Maze(Maze&&) noexcept = default;
+    Maze& operator=(Maze&&) noexcept = default;
+    ~Maze();
+
+    // Maps a binary maze file (see Maze.cpp for the layout) and points the tile table
+    // straight into the mapping: no parse step and no copy, and the OS pages tiles in
+    // as they are first read. Returns false (leaving the maze unchanged) if the file is
+    // missing or malformed.
+    bool loadFromFile(const std::string& filename);
+
+    // Writes the binary maze format; all-wall and all-open tiles are stored once and shared
+    bool saveToFile(const std::string& filename) const;
+
+    // Cheap, stable hash of a cell position for per-cell decoration choices (wall textures,
+    // props), so a given layout always looks the same
+    static unsigned int cellHash(int row, int col) {
+        const unsigned int h = static_cast<unsigned int>(row) * 73856093u ^ static_cast<unsigned int>(col) * 19349663u;
+        return h ^ (h >> 13);
+    }
+
+    // Get the character at a specific maze cell (row, col): 'W' for walls, ' ' otherwise
+    char getCell(int row, int col) const { return isWall(row, col) ? 'W' : ' '; }
+
+    // Check if a cell is a wall at (row, col); out of bounds is not a wall
+    bool isWall(int row, int col) const {
+        if (static_cast<unsigned>(row) >= static_cast<unsigned>(height) ||
+            static_cast<unsigned>(col) >= static_cast<unsigned>(width)) {
+            return false;
+        }
+        const std::uint64_t* tile = tiles[static_cast<size_t>(row >> TILE_SHIFT) * tilesX + (col >> TILE_SHIFT)];
+        const std::uint64_t word = tile[((row & (TILE_SIZE - 1)) >> 3) * (TILE_SIZE / 8) + ((col & (TILE_SIZE - 1)) >> 3)];
+        return (word >> (((row & 7) << 3) | (col & 7))) & 1u;
+    }
+
+    // True if no wall lies on the segment from world (fromX, fromZ) to (toX, toZ). Cells are
+    // walked with a 4-connected grid DDA; the origin cell is not tested, the target cell is.
+    bool hasLineOfSight(float fromX, float fromZ, float toX, float toZ) const;
+
+    // hasLineOfSight for count rays given as parallel arrays. Bit i of visible, which needs
+    // (count + 63) / 64 words, is set if ray i is clear. Rays are walked four at a time in
+    // lockstep with SSE2 where available, so the result matches the single-ray version.
+    void lineOfSight(const float* fromX, const float* fromZ, const float* toX, const float* toZ,
+                     int count, std::uint64_t* visible) const;
+
+    // Set or clear the wall at (row, col); ignored out of bounds.
+    // On a maze loaded from a file this first copies every tile out of the mapping.
+    void setWall(int row, int col, bool wall);
+
+    // Overwrite tile (tileX, tileY) with WORDS_PER_TILE words in the layout isWall reads.
+    // Distinct tiles of an owned (not mapped) maze may be written from different threads.
+    // Meant for filling a maze before it is shared, so it does not change getVersion().
+    void setTile(int tileX, int tileY, const std::uint64_t* words);
+
+    // Changes whenever the layout is replaced or a wall is edited. Versions are unique across
+    // all mazes, so caches keyed on it also notice a maze being assigned a different layout.
+    std::uint64_t getVersion() const { return version; }
+
+    // Hash of the size, every wall and the start, exit and key cells: equal for two mazes
+    // with the same content, however they were built. Reads every tile once.
+    std::uint64_t contentHash() const;
+
+    // Get starting position (row, col)
+    void getStartPosition(int& startRow, int& startCol) const;
+
+    // Get ending position (row, col)
+    void getEndPosition(int& endRow, int& endCol) const;
+
+    void setStartPosition(int row, int col) { startRow = row; startCol = col; }
+    void setEndPosition(int row, int col) { endRow = row; endCol = col; }
+
+    // Key placement stored with the level; returns false if the level does not place one
+    bool getKeyPosition(int& keyRow, int& keyCol) const;
+    void setKeyPosition(int row, int col) { keyRow = row; keyCol = col; }
+    void clearKeyPosition() { keyRow = keyCol = -1; }
+
+    // True while the tiles are read from a mapped maze file
+    bool isMapped() const { return mappedFile != nullptr; }
+
+    // Get maze dimensions
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    int getTilesX() const { return tilesX; }
+    int getTilesY() const { return tilesY; }
+
+    // Bytes used by the wall bits (owned or mapped) and the tile table
+    size_t getMemoryBytes() const;
+
+private:
+    int width, height;
+    int tilesX, tilesY;
+
+    // Tile (tx, ty) is tiles[ty * tilesX + tx], pointing into tileStorage or the mapped file
+    std::vector<const std::uint64_t*> tiles;
+    std::vector<std::uint64_t> tileStorage;
+    std::shared_ptr<const MappedFile> mappedFile;
+
+    // Store start and end positions
+    int startRow, startCol;
+    int endRow, endCol;
+    int keyRow, keyCol; // -1 if the level has no key placement
+    std::uint64_t version;
+
+    // Give the maze a fresh, never used version
+    void touch();
+
+    // Point the tile table at tileStorage
+    void bindOwnedTiles();
+
+    // Copy mapped tiles into tileStorage so they can be modified
+    void detachFromFile();
+
+    // Allocate storage for width x height cells, all walls or all open
+    void resize(int newWidth, int newHeight, bool filled);
+
+    // Initialize the maze layout (hardcoded or procedural generation)
+    void initializeLayout();
+};
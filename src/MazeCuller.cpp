@@ -0,0 +1,74 @@
+#include "MazeCuller.h"
+#include "Maze.h"
+#include "Frustum.h"
+#include "MazePVS.h"
+#include "Config.h" // For WALL_HEIGHT
+#include <algorithm>
+#include <cmath>
+
+MazeCuller::MazeCuller() : width(0), height(0), frameStamp(0), cellsTested(0), cellsOccluded(0) {}
+
+void MazeCuller::cull(const Maze& maze, const Frustum& frustum, float eyeX, float eyeZ, float maxDistance,
+                      const MazePVS* pvs) {
+    if (maze.getWidth() != width || maze.getHeight() != height) {
+        width = maze.getWidth();
+        height = maze.getHeight();
+        visibleStamp.assign(static_cast<size_t>(width) * height, 0);
+        frameStamp = 0;
+    }
+
+    if (++frameStamp == 0) {
+        // Stamp counter wrapped; start over so stale stamps cannot match
+        std::fill(visibleStamp.begin(), visibleStamp.end(), 0);
+        frameStamp = 1;
+    }
+
+    visibleCells.clear();
+    cellsTested = 0;
+    cellsOccluded = 0;
+
+    // The PVS only applies while the eye is in an open cell it knows about
+    const int eyeRow = static_cast<int>(std::floor(eyeZ));
+    const int eyeCol = static_cast<int>(std::floor(eyeX));
+    const bool usePvs = pvs && pvs->hasCell(eyeRow, eyeCol);
+    const int pvsRadius = usePvs ? pvs->getRadius() : 0;
+
+    // Cell (row, col) spans x in [col, col + 1] and z in [row, row + 1]
+    const int minCol = std::max(0, static_cast<int>(std::floor(eyeX - maxDistance)));
+    const int maxCol = std::min(width - 1, static_cast<int>(std::floor(eyeX + maxDistance)));
+    const int minRow = std::max(0, static_cast<int>(std::floor(eyeZ - maxDistance)));
+    const int maxRow = std::min(height - 1, static_cast<int>(std::floor(eyeZ + maxDistance)));
+    const float maxDistanceSq = maxDistance * maxDistance;
+
+    for (int r = minRow; r <= maxRow; ++r) {
+        const float z0 = static_cast<float>(r);
+        const float dz = std::max(0.0f, std::max(z0 - eyeZ, eyeZ - (z0 + 1.0f)));
+        for (int c = minCol; c <= maxCol; ++c) {
+            const float x0 = static_cast<float>(c);
+            const float dx = std::max(0.0f, std::max(x0 - eyeX, eyeX - (x0 + 1.0f)));
+            if (dx * dx + dz * dz > maxDistanceSq) continue; // Lost in the fog
+
+            if (usePvs && std::abs(r - eyeRow) <= pvsRadius && std::abs(c - eyeCol) <= pvsRadius &&
+                !pvs->isVisible(eyeRow, eyeCol, r, c)) {
+                ++cellsOccluded;
+                continue;
+            }
+
+            ++cellsTested;
+            if (!frustum.intersectsBox(x0, 0.0f, z0, x0 + 1.0f, WALL_HEIGHT, z0 + 1.0f)) continue;
+
+            const int index = r * width + c;
+            visibleStamp[index] = frameStamp;
+            visibleCells.push_back(index);
+        }
+    }
+}
+
+bool MazeCuller::isCellVisible(int row, int col) const {
+    if (row < 0 || row >= height || col < 0 || col >= width) return false;
+    return visibleStamp[static_cast<size_t>(row) * width + col] == frameStamp;
+}
+
+bool MazeCuller::isPointVisible(float x, float z) const {
+    return isCellVisible(static_cast<int>(std::floor(z)), static_cast<int>(std::floor(x)));
+}
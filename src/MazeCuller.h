@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Maze;    // Forward declaration
+class Frustum; // Forward declaration
+class MazePVS; // Forward declaration
+
+// Finds the maze cells that can appear on screen this frame.
+// Only the square of cells around the eye that fits inside the fog range is walked,
+// so the cost depends on the view distance rather than on the maze size.
+class MazeCuller {
+public:
+    MazeCuller();
+
+    // Collect the cells whose bounds intersect the frustum and lie within maxDistance of the eye.
+    // With a PVS, cells inside its window that the eye's cell cannot see are rejected first.
+    void cull(const Maze& maze, const Frustum& frustum, float eyeX, float eyeZ, float maxDistance,
+              const MazePVS* pvs = nullptr);
+
+    // Visibility queries for the most recent cull() call
+    bool isCellVisible(int row, int col) const;
+    bool isPointVisible(float x, float z) const; // World position, 1 unit per cell
+
+    // Cell indices (row * width + col) found visible, in walk order
+    const std::vector<int>& getVisibleCells() const { return visibleCells; }
+    int getCellsTested() const { return cellsTested; }
+    int getCellsOccluded() const { return cellsOccluded; }
+
+private:
+    int width, height;
+
+    // A cell is visible when its stamp equals the current frame's stamp,
+    // which avoids clearing the whole grid every frame
+    std::vector<std::uint32_t> visibleStamp;
+    std::uint32_t frameStamp;
+
+    std::vector<int> visibleCells;
+    int cellsTested;
+    int cellsOccluded; // Rejected by the PVS before the frustum test
+};
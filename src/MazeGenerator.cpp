@@ -0,0 +1,264 @@
+#include "MazeGenerator.h"
+#include "Maze.h"
+#include "Config.h" // For MAZE_MAX_DIMENSION
+#include "Random.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Cells per region side: a region of cells plus the walls between them fills one tile,
+    // with the tile's first row and column left as the border shared with the previous region
+    const int REGION_CELLS = Maze::TILE_SIZE / 2;
+    const int WORDS_PER_ROW = Maze::TILE_SIZE / 8;
+
+    // xorshift64* stream; cheap enough to draw once per carved cell
+    class RegionRandom {
+    public:
+        RegionRandom(std::uint64_t seed, std::uint64_t stream) {
+            std::uint64_t mix = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+            state = Random::splitMix64(mix) | 1;
+        }
+
+        std::uint32_t next() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return static_cast<std::uint32_t>((state * 0x2545F4914F6CDD1DULL) >> 32);
+        }
+
+        // Uniform in [0, n)
+        int below(int n) { return static_cast<int>((static_cast<std::uint64_t>(next()) * static_cast<std::uint32_t>(n)) >> 32); }
+
+        bool chance(float p) { return next() < static_cast<double>(p) * 4294967296.0; }
+
+    private:
+        std::uint64_t state;
+    };
+
+    // Tile-local cell access, same bit layout as Maze::isWall
+    void openTileCell(std::uint64_t* words, int row, int col) {
+        words[(row >> 3) * WORDS_PER_ROW + (col >> 3)] &= ~(std::uint64_t(1) << (((row & 7) << 3) | (col & 7)));
+    }
+
+    bool isTileCellOpen(const std::uint64_t* words, int row, int col) {
+        return !((words[(row >> 3) * WORDS_PER_ROW + (col >> 3)] >> (((row & 7) << 3) | (col & 7))) & 1u);
+    }
+
+    const int DIR_ROW[4] = { -1, 1, 0, 0 };
+    const int DIR_COL[4] = { 0, 0, -1, 1 };
+
+    // For a 4-bit direction mask: how many directions it holds, and the index of its n-th one
+    const std::uint8_t SET_BIT_COUNT[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    const std::uint8_t NTH_SET_BIT[16][4] = {
+        { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 },
+        { 2, 0, 0, 0 }, { 0, 2, 0, 0 }, { 1, 2, 0, 0 }, { 0, 1, 2, 0 },
+        { 3, 0, 0, 0 }, { 0, 3, 0, 0 }, { 1, 3, 0, 0 }, { 0, 1, 3, 0 },
+        { 2, 3, 0, 0 }, { 0, 2, 3, 0 }, { 1, 2, 3, 0 }, { 0, 1, 2, 3 },
+    };
+}
+
+MazeGenerator::MazeGenerator() : braid(0.0f), roomsPerRegion(0), maxRoomSize(4), generateMilliseconds(0.0) {}
+
+Maze MazeGenerator::generate(int width, int height, std::uint64_t seed, unsigned threadCount) {
+    TRACE_SCOPE("MazeGenerator::generate");
+    const auto startTime = std::chrono::steady_clock::now();
+    if (width < 3 || height < 3 || width > MAZE_MAX_DIMENSION || height > MAZE_MAX_DIMENSION) {
+        throw std::runtime_error("[MazeGenerator] Invalid maze size " + std::to_string(width) + "x" + std::to_string(height));
+    }
+
+    Maze maze(width, height, true);
+    const int cellsX = (width - 1) / 2;
+    const int cellsY = (height - 1) / 2;
+    const int regionsX = (cellsX + REGION_CELLS - 1) / REGION_CELLS;
+    const int regionsY = (cellsY + REGION_CELLS - 1) / REGION_CELLS;
+    const int regionCount = regionsX * regionsY;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, static_cast<unsigned>(regionCount));
+
+    // Each region owns exactly one tile, so workers never write the same words
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        std::uint64_t words[Maze::WORDS_PER_TILE];
+        for (;;) {
+            const int region = next.fetch_add(1);
+            if (region >= regionCount) break;
+            const int regionX = region % regionsX, regionY = region / regionsX;
+            carveRegion(regionX, regionY, cellsX, cellsY, seed, words);
+            maze.setTile(regionX, regionY, words);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker(); // The calling thread works too
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    stitchRegions(maze, cellsX, cellsY, seed);
+
+    RegionRandom placement(seed, static_cast<std::uint64_t>(regionCount) + 1);
+    maze.setStartPosition(1, 1);
+    maze.setEndPosition(2 * (cellsY - 1) + 1, 2 * (cellsX - 1) + 1);
+    maze.setKeyPosition(2 * placement.below(cellsY) + 1, 2 * placement.below(cellsX) + 1);
+
+    generateMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    return maze;
+}
+
+// Iterative randomized depth-first search over the region's cells, which yields a spanning
+// tree (a perfect maze). Braiding then opens some dead ends into a neighbour, and rooms are
+// cleared on top; neither can disconnect anything.
+void MazeGenerator::carveRegion(int regionX, int regionY, int cellsX, int cellsY, std::uint64_t seed,
+                                std::uint64_t* words) const {
+    std::fill(words, words + Maze::WORDS_PER_TILE, ~std::uint64_t(0));
+    const int rows = std::min(REGION_CELLS, cellsY - regionY * REGION_CELLS);
+    const int cols = std::min(REGION_CELLS, cellsX - regionX * REGION_CELLS);
+    RegionRandom random(seed, static_cast<std::uint64_t>(regionY) * ((cellsX + REGION_CELLS - 1) / REGION_CELLS) + regionX);
+
+    static_assert(REGION_CELLS <= 32, "visited rows are 32-bit masks");
+    std::uint32_t visited[REGION_CELLS] = {};
+    std::uint16_t stack[REGION_CELLS * REGION_CELLS];
+    int top = 0;
+
+    const int first = random.below(rows * cols);
+    stack[top++] = static_cast<std::uint16_t>(((first / cols) << 8) | (first % cols));
+    visited[first / cols] |= 1u << (first % cols);
+    openTileCell(words, 2 * (first / cols) + 1, 2 * (first % cols) + 1);
+
+    // Columns past the region edge count as visited, so the east test needs no width check
+    const std::uint32_t outside = cols < 32 ? ~((1u << cols) - 1) : 0u;
+    for (int r = 0; r < rows; ++r) {
+        visited[r] |= outside;
+    }
+    while (top > 0) {
+        const int r = stack[top - 1] >> 8, c = stack[top - 1] & 0xFF;
+        // Bit d set if the neighbour in direction d is unvisited
+        const unsigned open =
+            (r > 0 ? ((~visited[r - 1] >> c) & 1u) : 0u) |
+            (r + 1 < rows ? ((~visited[r + 1] >> c) & 1u) << 1 : 0u) |
+            (c > 0 ? ((~visited[r] >> (c - 1)) & 1u) << 2 : 0u) |
+            (c + 1 < 32 ? ((~visited[r] >> (c + 1)) & 1u) << 3 : 0u);
+        if (open == 0) {
+            --top;
+            continue;
+        }
+        const int d = NTH_SET_BIT[open][random.below(SET_BIT_COUNT[open])];
+        const int nr = r + DIR_ROW[d], nc = c + DIR_COL[d];
+        openTileCell(words, 2 * r + 1 + DIR_ROW[d], 2 * c + 1 + DIR_COL[d]);
+        openTileCell(words, 2 * nr + 1, 2 * nc + 1);
+        visited[nr] |= 1u << nc;
+        stack[top++] = static_cast<std::uint16_t>((nr << 8) | nc);
+    }
+
+    if (braid > 0.0f) {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                int closed[4];
+                int closedCount = 0, openCount = 0;
+                for (int d = 0; d < 4; ++d) {
+                    const int nr = r + DIR_ROW[d], nc = c + DIR_COL[d];
+                    if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+                    if (isTileCellOpen(words, 2 * r + 1 + DIR_ROW[d], 2 * c + 1 + DIR_COL[d])) {
+                        ++openCount;
+                    } else {
+                        closed[closedCount++] = d;
+                    }
+                }
+                if (openCount == 1 && closedCount > 0 && random.chance(braid)) {
+                    const int d = closed[random.below(closedCount)];
+                    openTileCell(words, 2 * r + 1 + DIR_ROW[d], 2 * c + 1 + DIR_COL[d]);
+                }
+            }
+        }
+    }
+
+    for (int room = 0; room < roomsPerRegion; ++room) {
+        const int roomRows = std::min(rows, 2 + random.below(std::max(1, maxRoomSize - 1)));
+        const int roomCols = std::min(cols, 2 + random.below(std::max(1, maxRoomSize - 1)));
+        if (roomRows < 2 || roomCols < 2) break;
+        const int r0 = random.below(rows - roomRows + 1), c0 = random.below(cols - roomCols + 1);
+        for (int r = 2 * r0 + 1; r <= 2 * (r0 + roomRows - 1) + 1; ++r) {
+            for (int c = 2 * c0 + 1; c <= 2 * (c0 + roomCols - 1) + 1; ++c) {
+                openTileCell(words, r, c);
+            }
+        }
+    }
+}
+
+void MazeGenerator::stitchRegions(Maze& maze, int cellsX, int cellsY, std::uint64_t seed) const {
+    const int regionsX = (cellsX + REGION_CELLS - 1) / REGION_CELLS;
+    const int regionsY = (cellsY + REGION_CELLS - 1) / REGION_CELLS;
+    const int regionCount = regionsX * regionsY;
+    RegionRandom random(seed, static_cast<std::uint64_t>(regionCount));
+
+    // Opens a passage on the shared border, to the east (d == 3) or south (d == 1) of a region
+    auto openBorder = [&](int regionX, int regionY, int d) {
+        if (d == 3) {
+            const int rows = std::min(REGION_CELLS, cellsY - regionY * REGION_CELLS);
+            const int row = regionY * REGION_CELLS + random.below(rows);
+            maze.setWall(2 * row + 1, (regionX + 1) * Maze::TILE_SIZE, false);
+        } else {
+            const int cols = std::min(REGION_CELLS, cellsX - regionX * REGION_CELLS);
+            const int col = regionX * REGION_CELLS + random.below(cols);
+            maze.setWall((regionY + 1) * Maze::TILE_SIZE, 2 * col + 1, false);
+        }
+    };
+
+    // Randomized depth-first spanning tree over the region grid; bit 0 marks the east
+    // border as joined, bit 1 the south border
+    std::vector<std::uint8_t> joined(regionCount, 0);
+    std::vector<char> visited(regionCount, 0);
+    std::vector<int> stack;
+    stack.reserve(regionCount);
+    stack.push_back(0);
+    visited[0] = 1;
+    while (!stack.empty()) {
+        const int region = stack.back();
+        const int rx = region % regionsX, ry = region / regionsX;
+        int candidates[4];
+        int candidateCount = 0;
+        for (int d = 0; d < 4; ++d) {
+            const int nx = rx + DIR_COL[d], ny = ry + DIR_ROW[d];
+            if (nx >= 0 && nx < regionsX && ny >= 0 && ny < regionsY && !visited[ny * regionsX + nx]) {
+                candidates[candidateCount++] = d;
+            }
+        }
+        if (candidateCount == 0) {
+            stack.pop_back();
+            continue;
+        }
+        const int d = candidates[random.below(candidateCount)];
+        const int neighbour = (ry + DIR_ROW[d]) * regionsX + (rx + DIR_COL[d]);
+        // Record the edge on whichever region sits west/north of the border
+        if (d == 3) joined[region] |= 1;
+        else if (d == 2) joined[neighbour] |= 1;
+        else if (d == 1) joined[region] |= 2;
+        else joined[neighbour] |= 2;
+        visited[neighbour] = 1;
+        stack.push_back(neighbour);
+    }
+
+    for (int ry = 0; ry < regionsY; ++ry) {
+        for (int rx = 0; rx < regionsX; ++rx) {
+            const std::uint8_t edges = joined[ry * regionsX + rx];
+            if (rx + 1 < regionsX && ((edges & 1) || random.chance(braid))) {
+                openBorder(rx, ry, 3);
+            }
+            if (ry + 1 < regionsY && ((edges & 2) || random.chance(braid))) {
+                openBorder(rx, ry, 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+class Maze; // Forward declaration
+
+// Seeded procedural maze generator. Cells sit on odd rows/columns with walls between them.
+// The cell grid is split into square regions of one maze tile each; regions are carved
+// independently (in parallel) into their own tile, then joined by a random spanning tree
+// of passages through the tile borders. Every region is seeded from (seed, region index)
+// alone, so the same seed gives the same maze whatever the thread count.
+class MazeGenerator {
+public:
+    MazeGenerator();
+
+    // Chance that a dead end, or a region border not needed for connectivity, gets opened.
+    // 0 produces a perfect maze (exactly one path between any two cells).
+    void setBraid(float fraction) { braid = fraction; }
+
+    // Rectangular rooms carved into each region, with sides of 2..maxSize cells
+    void setRooms(int roomsPerRegion, int maxSize) { this->roomsPerRegion = roomsPerRegion; maxRoomSize = maxSize; }
+
+    // Build a width x height maze; start is the top-left cell, exit the bottom-right one,
+    // and the key goes on a random cell. threadCount == 0 uses all hardware threads.
+    // Throws std::runtime_error if either dimension is outside [3, MAZE_MAX_DIMENSION].
+    Maze generate(int width, int height, std::uint64_t seed, unsigned threadCount = 0);
+
+    double getGenerateMilliseconds() const { return generateMilliseconds; }
+
+private:
+    float braid;
+    int roomsPerRegion;
+    int maxRoomSize;
+    double generateMilliseconds;
+
+    // Carve region (regionX, regionY) into a tile-sized word buffer
+    void carveRegion(int regionX, int regionY, int cellsX, int cellsY, std::uint64_t seed, std::uint64_t* words) const;
+
+    // Open passages between neighbouring regions: a spanning tree, plus braided extras
+    void stitchRegions(Maze& maze, int cellsX, int cellsY, std::uint64_t seed) const;
+};
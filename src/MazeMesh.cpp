@@ -0,0 +1,228 @@
+#include "MazeMesh.h"
+#include "Maze.h"
+#include "Config.h" // For WALL_HEIGHT
+#include <algorithm>
+#include <cstddef>  // For offsetof
+#include <iostream>
+
+const char* const MazeMesh::wallTextures[MazeMesh::WALL_VARIANTS] = { "wall", "brick", "stone" };
+
+int MazeMesh::wallVariant(int row, int col) {
+    return static_cast<int>(Maze::cellHash(row, col) % WALL_VARIANTS);
+}
+
+MazeMesh::MazeMesh() : vbo(0), quadCount(0), chunksX(0), chunksY(0) {}
+
+MazeMesh::~MazeMesh() {
+    release();
+}
+
+void MazeMesh::release() {
+    if (vbo != 0) {
+        glDeleteBuffers(1, &vbo);
+        vbo = 0;
+    }
+    ranges.clear();
+    quadCount = 0;
+    chunksX = chunksY = 0;
+}
+
+void MazeMesh::addQuad(std::vector<Vertex>& out, const Vertex& a, const Vertex& b,
+                       const Vertex& c, const Vertex& d) {
+    out.push_back(a); out.push_back(b); out.push_back(c);
+    out.push_back(a); out.push_back(c); out.push_back(d);
+}
+
+// Wall faces exist where a wall cell borders an open cell. Faces sharing a plane, facing
+// the same way and using the same texture are merged into one quad per run; the texture
+// repeats once per world unit so a merged quad looks identical to the faces it replaces.
+void MazeMesh::addWalls(const Maze& maze, ChunkedVertices (&out)[WALL_VARIANTS]) {
+    const int rows = maze.getHeight();
+    const int cols = maze.getWidth();
+    const float h = WALL_HEIGHT;
+
+    auto exposed = [&](int r, int c, int nr, int nc) {
+        return maze.isWall(r, c) && nr >= 0 && nr < rows && nc >= 0 && nc < cols && !maze.isWall(nr, nc);
+    };
+
+    // North (-Z) and south (+Z) faces: runs along each row
+    for (int r = 0; r < rows; ++r) {
+        for (int side = 0; side < 2; ++side) {
+            const int dr = side == 0 ? -1 : 1;
+            int c = 0;
+            while (c < cols) {
+                if (!exposed(r, c, r + dr, c)) { ++c; continue; }
+                const int chunkEnd = std::min(cols, (c / CHUNK_SIZE + 1) * CHUNK_SIZE);
+                const int variant = wallVariant(r, c);
+                int end = c;
+                while (end < chunkEnd && exposed(r, end, r + dr, end) && wallVariant(r, end) == variant) ++end;
+
+                std::vector<Vertex>& dst = out[variant][chunkIndex(r, c)];
+                const float x0 = static_cast<float>(c), x1 = static_cast<float>(end);
+                if (side == 0) {
+                    const float z = static_cast<float>(r);
+                    addQuad(dst, { x0, 0, z, 0, 0, -1, x0, 0 }, { x0, h, z, 0, 0, -1, x0, h },
+                                 { x1, h, z, 0, 0, -1, x1, h }, { x1, 0, z, 0, 0, -1, x1, 0 });
+                } else {
+                    const float z = static_cast<float>(r + 1);
+                    addQuad(dst, { x1, 0, z, 0, 0, 1, x1, 0 }, { x1, h, z, 0, 0, 1, x1, h },
+                                 { x0, h, z, 0, 0, 1, x0, h }, { x0, 0, z, 0, 0, 1, x0, 0 });
+                }
+                ++quadCount;
+                c = end;
+            }
+        }
+    }
+
+    // West (-X) and east (+X) faces: runs along each column
+    for (int c = 0; c < cols; ++c) {
+        for (int side = 0; side < 2; ++side) {
+            const int dc = side == 0 ? -1 : 1;
+            int r = 0;
+            while (r < rows) {
+                if (!exposed(r, c, r, c + dc)) { ++r; continue; }
+                const int chunkEnd = std::min(rows, (r / CHUNK_SIZE + 1) * CHUNK_SIZE);
+                const int variant = wallVariant(r, c);
+                int end = r;
+                while (end < chunkEnd && exposed(end, c, end, c + dc) && wallVariant(end, c) == variant) ++end;
+
+                std::vector<Vertex>& dst = out[variant][chunkIndex(r, c)];
+                const float z0 = static_cast<float>(r), z1 = static_cast<float>(end);
+                if (side == 0) {
+                    const float x = static_cast<float>(c);
+                    addQuad(dst, { x, 0, z1, -1, 0, 0, z1, 0 }, { x, h, z1, -1, 0, 0, z1, h },
+                                 { x, h, z0, -1, 0, 0, z0, h }, { x, 0, z0, -1, 0, 0, z0, 0 });
+                } else {
+                    const float x = static_cast<float>(c + 1);
+                    addQuad(dst, { x, 0, z0, 1, 0, 0, z0, 0 }, { x, h, z0, 1, 0, 0, z0, h },
+                                 { x, h, z1, 1, 0, 0, z1, h }, { x, 0, z1, 1, 0, 0, z1, 0 });
+                }
+                ++quadCount;
+                r = end;
+            }
+        }
+    }
+}
+
+// Floor and ceiling cover every open cell. Open cells are merged greedily into
+// rectangles: grow a run along the row, then extend it downwards while the whole run stays
+// open, both limited to the chunk the rectangle starts in.
+void MazeMesh::addFloorAndCeiling(const Maze& maze, ChunkedVertices& floorOut,
+                                  ChunkedVertices& ceilingOut) {
+    const int rows = maze.getHeight();
+    const int cols = maze.getWidth();
+    const float h = WALL_HEIGHT;
+    std::vector<char> covered(static_cast<size_t>(rows) * cols, 0);
+
+    auto isFree = [&](int r, int c) {
+        return !maze.isWall(r, c) && !covered[static_cast<size_t>(r) * cols + c];
+    };
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (!isFree(r, c)) continue;
+
+            const int chunkEndC = std::min(cols, (c / CHUNK_SIZE + 1) * CHUNK_SIZE);
+            const int chunkEndR = std::min(rows, (r / CHUNK_SIZE + 1) * CHUNK_SIZE);
+
+            int endC = c;
+            while (endC < chunkEndC && isFree(r, endC)) ++endC;
+
+            int endR = r + 1;
+            while (endR < chunkEndR) {
+                bool rowFree = true;
+                for (int k = c; k < endC && rowFree; ++k) rowFree = isFree(endR, k);
+                if (!rowFree) break;
+                ++endR;
+            }
+
+            for (int rr = r; rr < endR; ++rr) {
+                for (int cc = c; cc < endC; ++cc) covered[static_cast<size_t>(rr) * cols + cc] = 1;
+            }
+
+            const float x0 = static_cast<float>(c), x1 = static_cast<float>(endC);
+            const float z0 = static_cast<float>(r), z1 = static_cast<float>(endR);
+            const int chunk = chunkIndex(r, c);
+            addQuad(floorOut[chunk], { x0, 0, z0, 0, 1, 0, x0, z0 }, { x0, 0, z1, 0, 1, 0, x0, z1 },
+                                     { x1, 0, z1, 0, 1, 0, x1, z1 }, { x1, 0, z0, 0, 1, 0, x1, z0 });
+            addQuad(ceilingOut[chunk], { x0, h, z0, 0, -1, 0, x0, z0 }, { x1, h, z0, 0, -1, 0, x1, z0 },
+                                       { x1, h, z1, 0, -1, 0, x1, z1 }, { x0, h, z1, 0, -1, 0, x0, z1 });
+            quadCount += 2;
+            c = endC - 1;
+        }
+    }
+}
+
+void MazeMesh::build(const Maze& maze, const TextureManager& textures) {
+    release();
+
+    chunksX = (maze.getWidth() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksY = (maze.getHeight() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const size_t chunkCount = static_cast<size_t>(chunksX) * chunksY;
+
+    ChunkedVertices walls[WALL_VARIANTS], floor(chunkCount), ceiling(chunkCount);
+    for (ChunkedVertices& variant : walls) variant.resize(chunkCount);
+    addWalls(maze, walls);
+    addFloorAndCeiling(maze, floor, ceiling);
+
+    // Lay the buffer out texture-major, chunk-minor so each texture is one contiguous
+    // range and the visible chunks of a texture can go out in one glMultiDrawArrays call
+    std::vector<Vertex> vertices;
+    auto appendRange = [&](const std::string& textureName, const ChunkedVertices& src) {
+        int layer = textures.getLayer(textureName);
+        if (layer < 0) {
+            // Without an array the layer is never read; with one, show the checker rather than
+            // whichever image happens to sit in layer 0
+            layer = std::max(0, textures.getFallbackLayer());
+            if (textures.getFallbackLayer() >= 0 && missingLayers.insert(textureName).second) {
+                std::cerr << "[MazeMesh] Texture '" << textureName << "' is not in the texture array; using the fallback layer" << std::endl;
+            }
+        }
+        Range range;
+        range.textureName = textureName;
+        range.texture = textures.getHandle(textureName);
+        range.first = static_cast<GLint>(vertices.size());
+        range.chunkFirst.resize(chunkCount);
+        range.chunkCount.resize(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            range.chunkFirst[chunk] = static_cast<GLint>(vertices.size());
+            range.chunkCount[chunk] = static_cast<GLsizei>(src[chunk].size());
+            for (Vertex vertex : src[chunk]) {
+                vertex.layer = static_cast<float>(layer);
+                vertices.push_back(vertex);
+            }
+        }
+        range.count = static_cast<GLsizei>(vertices.size()) - range.first;
+        if (range.count > 0) ranges.push_back(std::move(range));
+    };
+    for (int variant = 0; variant < WALL_VARIANTS; ++variant) {
+        appendRange(wallTextures[variant], walls[variant]);
+    }
+    appendRange("floor", floor);
+    appendRange("ceiling", ceiling);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::cout << "[MazeMesh] Built " << quadCount << " quads (" << vertices.size()
+              << " vertices, " << ranges.size() << " texture ranges, " << chunkCount << " chunks)" << std::endl;
+}
+
+void MazeMesh::bind() const {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, x)));
+    glNormalPointer(GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, nx)));
+    glTexCoordPointer(3, GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, u)));
+}
+
+void MazeMesh::unbind() const {
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "TextureManager.h" // For TextureHandle
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class Maze; // Forward declaration
+
+// Static GPU geometry for the maze walls, floor and ceiling.
+// Built once per maze layout: neighbouring coplanar faces are merged into single quads
+// (never across a chunk border, so chunks can be culled independently) and the vertex
+// buffer is sorted by texture, then by chunk. Each vertex also carries its texture's layer
+// in the scene texture array, so the whole mesh can be drawn with a single bind.
+class MazeMesh {
+public:
+    // Square block of cells whose geometry is drawn or culled together
+    static const int CHUNK_SIZE = 8;
+
+    // All vertices drawn with one texture; chunk c owns [chunkFirst[c], chunkFirst[c] + chunkCount[c])
+    struct Range {
+        std::string textureName;
+        TextureHandle texture; // Resolved when the mesh is built
+        GLint first;    // First vertex in the buffer
+        GLsizei count;  // Number of vertices (triangles, 6 per quad)
+        std::vector<GLint> chunkFirst;
+        std::vector<GLsizei> chunkCount;
+    };
+
+    MazeMesh();
+    ~MazeMesh();
+
+    MazeMesh(const MazeMesh&) = delete;
+    MazeMesh& operator=(const MazeMesh&) = delete;
+
+    // Build the geometry from the maze layout and upload it to a vertex buffer.
+    // Handles and layers are resolved through the TextureManager; a texture missing from the
+    // array gets its fallback layer, reported once per texture name.
+    void build(const Maze& maze, const TextureManager& textures);
+
+    // Delete the GPU buffer and clear all ranges
+    void release();
+
+    // Bind the vertex buffer and point the fixed-function arrays at it (texcoord = u, v, layer)
+    void bind() const;
+
+    // Restore client state after drawing
+    void unbind() const;
+
+    bool isBuilt() const { return vbo != 0; }
+    const std::vector<Range>& getRanges() const { return ranges; }
+    size_t getQuadCount() const { return quadCount; }
+    int getChunksX() const { return chunksX; }
+    int getChunksY() const { return chunksY; }
+    int getChunkCount() const { return chunksX * chunksY; }
+
+private:
+    // Interleaved vertex layout uploaded to the GPU
+    struct Vertex {
+        float x, y, z;
+        float nx, ny, nz;
+        float u, v;
+        float layer = 0.0f; // Filled in per texture range when the buffer is assembled
+    };
+
+    GLuint vbo;
+    std::vector<Range> ranges;
+    size_t quadCount;
+    int chunksX, chunksY;
+    std::unordered_set<std::string> missingLayers; // Already reported, so rebuilds do not repeat it
+
+    // Vertices of one texture, bucketed per chunk until the buffer is assembled
+    typedef std::vector<std::vector<Vertex>> ChunkedVertices;
+
+    int chunkIndex(int row, int col) const { return (row / CHUNK_SIZE) * chunksX + col / CHUNK_SIZE; }
+
+    // Wall textures, picked per wall cell so corridors are not one repeated surface
+    static const int WALL_VARIANTS = 3;
+    static const char* const wallTextures[WALL_VARIANTS];
+    static int wallVariant(int row, int col);
+
+    // Append one quad (corners in counter-clockwise order seen from the front) as two triangles
+    static void addQuad(std::vector<Vertex>& out, const Vertex& a, const Vertex& b,
+                        const Vertex& c, const Vertex& d);
+
+    void addWalls(const Maze& maze, ChunkedVertices (&out)[WALL_VARIANTS]);
+    void addFloorAndCeiling(const Maze& maze, ChunkedVertices& floorOut, ChunkedVertices& ceilingOut);
+};
@@ -0,0 +1,219 @@
+#include "MazePVS.h"
+#include "Maze.h"
+#include "Config.h" // For PVS_MAX_MEMORY_MB
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+MazePVS::MazePVS()
+    : width(0), height(0), radius(0), windowSize(0), wordsPerCell(0), buildMilliseconds(0.0) {}
+
+void MazePVS::clear() {
+    slot.clear();
+    bits.clear();
+    width = height = radius = windowSize = wordsPerCell = 0;
+}
+
+bool MazePVS::build(const Maze& maze, float radiusCells, unsigned threadCount) {
+    TRACE_SCOPE("MazePVS::build");
+    clear();
+    const auto startTime = std::chrono::steady_clock::now();
+
+    width = maze.getWidth();
+    height = maze.getHeight();
+    radius = std::max(1, static_cast<int>(std::ceil(radiusCells)));
+    windowSize = 2 * radius + 1;
+    wordsPerCell = (windowSize * windowSize + 63) / 64;
+
+    // Only open cells get a bitset
+    slot.assign(static_cast<size_t>(width) * height, -1);
+    std::vector<int> openCells;
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            if (!maze.isWall(r, c)) {
+                slot[static_cast<size_t>(r) * width + c] = static_cast<std::int32_t>(openCells.size());
+                openCells.push_back(r * width + c);
+            }
+        }
+    }
+
+    const size_t bytesNeeded = openCells.size() * wordsPerCell * sizeof(std::uint64_t);
+    if (bytesNeeded > static_cast<size_t>(PVS_MAX_MEMORY_MB) * 1024 * 1024) {
+        std::cerr << "[MazePVS] Skipped: " << openCells.size() << " open cells would need "
+                  << bytesNeeded / (1024 * 1024) << " MB (budget " << PVS_MAX_MEMORY_MB << " MB)" << std::endl;
+        clear();
+        return false;
+    }
+    bits.assign(openCells.size() * wordsPerCell, 0);
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, std::max<size_t>(1, openCells.size())));
+
+    // Workers pull small batches of cells so uneven corridors/rooms balance out;
+    // each cell writes only its own bitset, so no further synchronisation is needed
+    const int batchSize = 64;
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            const size_t begin = next.fetch_add(batchSize);
+            if (begin >= openCells.size()) break;
+            const size_t end = std::min(openCells.size(), begin + batchSize);
+            for (size_t i = begin; i < end; ++i) {
+                buildCell(maze, openCells[i] / width, openCells[i] % width, &bits[i * wordsPerCell]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker(); // The calling thread works too
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+void MazePVS::rebuildAround(const Maze& maze, int row, int col) {
+    TRACE_SCOPE("MazePVS::rebuildAround");
+    if (!isBuilt() || maze.getWidth() != width || maze.getHeight() != height) return;
+
+    const int rowEnd = std::min(height - 1, row + radius), colEnd = std::min(width - 1, col + radius);
+    for (int r = std::max(0, row - radius); r <= rowEnd; ++r) {
+        for (int c = std::max(0, col - radius); c <= colEnd; ++c) {
+            std::int32_t& cellSlot = slot[static_cast<size_t>(r) * width + c];
+            if (maze.isWall(r, c)) {
+                cellSlot = -1; // Its old bitset is left unused
+                continue;
+            }
+            if (cellSlot < 0) {
+                cellSlot = static_cast<std::int32_t>(bits.size() / wordsPerCell);
+                bits.resize(bits.size() + wordsPerCell);
+            }
+            std::uint64_t* cellBits = &bits[static_cast<size_t>(cellSlot) * wordsPerCell];
+            std::fill(cellBits, cellBits + wordsPerCell, 0);
+            buildCell(maze, r, c, cellBits);
+        }
+    }
+}
+
+// Precise permissive field of view (after Jonathon Duerig's algorithm): a cell is visible if
+// a segment from any point of the source cell reaches it without crossing the inside of a wall
+// cell. A wall cell counts as visible when a segment reaches it, since its faces get drawn.
+//
+// Each quadrant is scanned in coordinates where the source cell is [0,1]x[0,1] and the
+// quadrant's cells have x, y >= 0, one anti-diagonal at a time. The sight lines still open are
+// kept as views, each between a shallow and a steep boundary line that pivot on the wall
+// corners (bumps) met so far. All corners are integers, so every test below is exact.
+void MazePVS::buildCell(const Maze& maze, int row, int col, std::uint64_t* cellBits) const {
+    struct Point { int x, y; };
+    struct Line {
+        Point from, to;
+        // > 0 left of from->to, < 0 right of it, 0 on it
+        int side(Point p) const { return (to.x - from.x) * (p.y - from.y) - (to.y - from.y) * (p.x - from.x); }
+    };
+    struct Bump { Point at; int parent; }; // parent: the bump added before it on that boundary, or -1
+    struct View { Line shallow, steep; int shallowBump, steepBump; };
+
+    std::vector<View> views;
+    std::vector<Bump> bumps;
+
+    auto mark = [&](int r, int c) {
+        const int bit = (r - row + radius) * windowSize + (c - col + radius);
+        cellBits[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+    };
+
+    // A wall below the shallow boundary: sight lines now pass over its top-left corner, and
+    // the boundary pivots on any steep bump it would otherwise cut through
+    auto addShallowBump = [&](View& view, Point corner) {
+        view.shallow.to = corner;
+        bumps.push_back({ corner, view.shallowBump });
+        view.shallowBump = static_cast<int>(bumps.size()) - 1;
+        for (int b = view.steepBump; b >= 0; b = bumps[b].parent) {
+            if (view.shallow.side(bumps[b].at) < 0) view.shallow.from = bumps[b].at;
+        }
+    };
+    auto addSteepBump = [&](View& view, Point corner) {
+        view.steep.to = corner;
+        bumps.push_back({ corner, view.steepBump });
+        view.steepBump = static_cast<int>(bumps.size()) - 1;
+        for (int b = view.shallowBump; b >= 0; b = bumps[b].parent) {
+            if (view.steep.side(bumps[b].at) > 0) view.steep.from = bumps[b].at;
+        }
+    };
+    // Both boundaries on one line through a corner of the source cell: nothing left to see
+    auto isClosed = [](const View& view) {
+        return view.shallow.side(view.steep.from) == 0 && view.shallow.side(view.steep.to) == 0 &&
+               (view.shallow.side({ 0, 1 }) == 0 || view.shallow.side({ 1, 0 }) == 0);
+    };
+
+    mark(row, col);
+    for (int dirRow = -1; dirRow <= 1; dirRow += 2) {
+        for (int dirCol = -1; dirCol <= 1; dirCol += 2) {
+            views.assign(1, View{ { { 0, 1 }, { radius, 0 } }, { { 1, 0 }, { 0, radius } }, -1, -1 });
+            bumps.clear();
+            for (int i = 1; i <= 2 * radius && !views.empty(); ++i) {
+                size_t v = 0; // Views are ordered shallow to steep, like the cells of a diagonal
+                for (int y = std::max(0, i - radius); y <= std::min(i, radius); ++y) {
+                    const int x = i - y;
+                    const Point topLeft{ x, y + 1 }, bottomRight{ x + 1, y };
+                    while (v < views.size() && views[v].steep.side(bottomRight) >= 0) ++v;
+                    if (v == views.size()) break;
+                    if (views[v].shallow.side(topLeft) <= 0) continue; // Between two views
+
+                    // Cells outside the maze block sight but are not part of the PVS
+                    const int r = row + dirRow * y, c = col + dirCol * x;
+                    const bool inside = r >= 0 && r < height && c >= 0 && c < width;
+                    if (inside) mark(r, c);
+                    if (inside && !maze.isWall(r, c)) continue;
+
+                    const bool belowShallow = views[v].shallow.side(bottomRight) < 0;
+                    const bool aboveSteep = views[v].steep.side(topLeft) > 0;
+                    if (belowShallow && aboveSteep) {
+                        views.erase(views.begin() + v);
+                    } else if (belowShallow) {
+                        addShallowBump(views[v], topLeft);
+                        if (isClosed(views[v])) views.erase(views.begin() + v);
+                    } else if (aboveSteep) {
+                        addSteepBump(views[v], bottomRight);
+                        if (isClosed(views[v])) views.erase(views.begin() + v);
+                    } else {
+                        // The wall splits the view into the sight lines passing below and above it
+                        const View split = views[v];
+                        views.insert(views.begin() + v, split);
+                        addSteepBump(views[v], bottomRight);
+                        addShallowBump(views[v + 1], topLeft);
+                        if (isClosed(views[v + 1])) views.erase(views.begin() + v + 1);
+                        if (isClosed(views[v])) {
+                            views.erase(views.begin() + v);
+                        } else {
+                            ++v;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool MazePVS::hasCell(int row, int col) const {
+    if (bits.empty() || row < 0 || row >= height || col < 0 || col >= width) return false;
+    return slot[static_cast<size_t>(row) * width + col] >= 0;
+}
+
+bool MazePVS::isVisible(int fromRow, int fromCol, int toRow, int toCol) const {
+    const int lr = toRow - fromRow + radius, lc = toCol - fromCol + radius;
+    if (lr < 0 || lr >= windowSize || lc < 0 || lc >= windowSize) return false;
+    const std::int32_t s = slot[static_cast<size_t>(fromRow) * width + fromCol];
+    const int bit = lr * windowSize + lc;
+    return (bits[static_cast<size_t>(s) * wordsPerCell + (bit >> 6)] >> (bit & 63)) & 1;
+}
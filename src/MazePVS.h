@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Maze; // Forward declaration
+
+// Potentially visible set: for every open maze cell, the cells that can be seen from it.
+// Built once per maze with a permissive field of view from each cell, so a cell is in the
+// set if any point of it can be seen from any point of the source cell.
+// Each cell stores a bitset over the square window of cells within `radius`, since
+// anything further away is hidden by the fog anyway.
+class MazePVS {
+public:
+    MazePVS();
+
+    // Compute the PVS for every open cell. threadCount == 0 uses all hardware threads.
+    // Returns false (and leaves the PVS empty) if the result would exceed the memory budget.
+    bool build(const Maze& maze, float radius, unsigned threadCount = 0);
+
+    // The wall at (row, col) changed: rebuild every open cell within `radius` of it, the only
+    // cells whose view can pass through it. A cell that opened gets a new bitset.
+    // Does nothing if no PVS is built.
+    void rebuildAround(const Maze& maze, int row, int col);
+
+    void clear();
+
+    // True if a PVS was computed for the cell (open cells of a built PVS)
+    bool hasCell(int row, int col) const;
+
+    // Can `to` be seen from anywhere inside `from`? Requires hasCell(fromRow, fromCol).
+    // Cells outside the window are reported as not visible.
+    bool isVisible(int fromRow, int fromCol, int toRow, int toCol) const;
+
+    bool isBuilt() const { return !bits.empty(); }
+    int getRadius() const { return radius; }
+    double getBuildMilliseconds() const { return buildMilliseconds; }
+    size_t getMemoryBytes() const { return bits.size() * sizeof(std::uint64_t) + slot.size() * sizeof(std::int32_t); }
+
+private:
+    int width, height;
+    int radius;          // Window half-size in cells
+    int windowSize;      // 2 * radius + 1
+    int wordsPerCell;    // 64-bit words per window bitset
+
+    std::vector<std::int32_t> slot;   // Cell index -> bitset slot, -1 for wall cells
+    std::vector<std::uint64_t> bits;  // Bitsets, wordsPerCell words per slot
+    double buildMilliseconds;
+
+    // Scan the window around one source cell into its bitset
+    void buildCell(const Maze& maze, int row, int col, std::uint64_t* cellBits) const;
+};
@@ -0,0 +1,491 @@
+#include "Pathfinder.h"
+#include "Maze.h"
+#include "HierarchicalPathfinder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+    // Jump directions; START expands all four
+    const std::uint8_t UP = 0, DOWN = 1, LEFT = 2, RIGHT = 3, START = 4;
+
+    // Cells scanned between clock reads while time-slicing (a few microseconds of work)
+    const std::uint64_t CELLS_PER_CHECK = 4096;
+    // Abstract nodes expanded between clock reads (each relaxes one cluster's entrances)
+    const int HIERARCHY_EXPANSIONS_PER_CHECK = 16;
+
+    int manhattan(int rowA, int colA, int rowB, int colB) {
+        return std::abs(rowA - rowB) + std::abs(colA - colB);
+    }
+}
+
+Pathfinder::Pathfinder(const Maze& mazeRef, size_t maxNodeCount)
+    : maze(mazeRef), maxNodes(std::max<size_t>(maxNodeCount, 16)), hierarchy(nullptr),
+      state(SearchState::Idle), activeRequest(-1), hierarchySearch(false), searchVersion(0),
+      startRow(0), startCol(0), goalRow(0), goalCol(0), goalNode(-1),
+      lookupGeneration(0), lookupMask(0),
+      pendingCount(0), nextTicket(1),
+      cache(PATH_CACHE_SIZE), cacheVersion(0), cacheClock(0),
+      expandedNodes(0), cacheHits(0), searchCount(0), scannedCells(0) {
+    nodes.reserve(maxNodes);
+    openList.reserve(maxNodes * 2);
+    size_t lookupSize = 1;
+    while (lookupSize < maxNodes * 2) lookupSize <<= 1;
+    lookupNode.assign(lookupSize, -1);
+    lookupStamp.assign(lookupSize, 0);
+    lookupMask = lookupSize - 1;
+
+    parked = ParkedSearch{ SearchState::Idle, -1, 0, 0, 0, 0, 0, -1, {}, {}, {}, {}, 0 };
+    parked.nodes.reserve(maxNodes);
+    parked.openList.reserve(maxNodes * 2);
+    parked.lookupNode.assign(lookupSize, -1);
+    parked.lookupStamp.assign(lookupSize, 0);
+}
+
+bool Pathfinder::isBlocked(int row, int col) const {
+    return static_cast<unsigned>(row) >= static_cast<unsigned>(maze.getHeight()) ||
+           static_cast<unsigned>(col) >= static_cast<unsigned>(maze.getWidth()) ||
+           maze.isWall(row, col);
+}
+
+// --- Requests ---
+
+Pathfinder::Ticket Pathfinder::requestPath(int fromRow, int fromCol, int toRow, int toCol) {
+    Request* slot = nullptr;
+    for (Request& request : requests) {
+        if (request.ticket == INVALID_TICKET) {
+            slot = &request;
+            break;
+        }
+    }
+    if (!slot) {
+        requests.emplace_back();
+        slot = &requests.back();
+    }
+
+    slot->ticket = nextTicket++;
+    if (nextTicket == INVALID_TICKET) nextTicket = 1;
+    slot->startRow = fromRow;
+    slot->startCol = fromCol;
+    slot->goalRow = toRow;
+    slot->goalCol = toCol;
+    slot->path.clear();
+
+    if (const CacheEntry* cached = findCached(fromRow, fromCol, toRow, toCol)) {
+        slot->path.assign(cached->path.begin(), cached->path.end());
+        slot->status = PathStatus::Found;
+        ++cacheHits;
+    } else {
+        slot->status = PathStatus::Pending;
+        ++pendingCount;
+    }
+    return slot->ticket;
+}
+
+Pathfinder::Request* Pathfinder::findRequest(Ticket ticket) {
+    if (ticket == INVALID_TICKET) return nullptr;
+    for (Request& request : requests) {
+        if (request.ticket == ticket) return &request;
+    }
+    return nullptr;
+}
+
+const Pathfinder::Request* Pathfinder::findRequest(Ticket ticket) const {
+    return const_cast<Pathfinder*>(this)->findRequest(ticket);
+}
+
+PathStatus Pathfinder::getStatus(Ticket ticket) const {
+    const Request* request = findRequest(ticket);
+    return request ? request->status : PathStatus::Invalid;
+}
+
+PathStatus Pathfinder::takePath(Ticket ticket, std::vector<PathCell>& path) {
+    Request* request = findRequest(ticket);
+    if (!request) return PathStatus::Invalid;
+    const PathStatus status = request->status;
+    if (status == PathStatus::Pending) return status;
+    path.assign(request->path.begin(), request->path.end());
+    request->ticket = INVALID_TICKET;
+    return status;
+}
+
+void Pathfinder::cancel(Ticket ticket) {
+    Request* request = findRequest(ticket);
+    if (!request) return;
+    if (request->status == PathStatus::Pending) {
+        --pendingCount;
+        if (activeRequest == static_cast<int>(request - requests.data())) {
+            state = SearchState::Idle;
+            activeRequest = -1;
+            hierarchySearch = false;
+        }
+    }
+    request->ticket = INVALID_TICKET;
+}
+
+void Pathfinder::update(double budgetMs) {
+    serveRequests(budgetMs, 0);
+}
+
+void Pathfinder::updateExpansions(int maxExpansions) {
+    serveRequests(0.0, maxExpansions > 0 ? maxExpansions : 1);
+}
+
+void Pathfinder::serveRequests(double budgetMs, int maxExpansions) {
+    const auto startTime = std::chrono::steady_clock::now();
+    // Grid and abstract expansions both count toward an expansion budget
+    const auto expansions = [&]() { return expandedNodes + (hierarchy ? hierarchy->getExpandedNodes() : 0); };
+    const std::uint64_t startExpanded = expansions();
+    const auto outOfBudget = [&]() {
+        if (maxExpansions > 0) {
+            return expansions() - startExpanded >= static_cast<std::uint64_t>(maxExpansions);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() >= budgetMs;
+    };
+    validateCache();
+
+    // A wall edit invalidates the half-finished search; start it over on the new layout. A
+    // query on a hierarchy that has gone stale continues as a grid search.
+    if (state == SearchState::Running &&
+        (hierarchySearch ? !hierarchy->isUpToDate() : searchVersion != maze.getVersion())) {
+        hierarchySearch = false;
+        beginSearch(startRow, startCol, goalRow, goalCol);
+    }
+
+    while (pendingCount > 0) {
+        if (state == SearchState::Idle) {
+            // Serve the oldest pending request first
+            int oldest = -1;
+            for (size_t i = 0; i < requests.size(); ++i) {
+                const Request& request = requests[i];
+                if (request.ticket != INVALID_TICKET && request.status == PathStatus::Pending &&
+                    (oldest < 0 || request.ticket < requests[oldest].ticket)) {
+                    oldest = static_cast<int>(i);
+                }
+            }
+            if (oldest < 0) {
+                pendingCount = 0;
+                break;
+            }
+            const Request& request = requests[oldest];
+            if (const CacheEntry* cached = findCached(request.startRow, request.startCol, request.goalRow, request.goalCol)) {
+                // An identical request finished earlier in the queue
+                requests[oldest].path.assign(cached->path.begin(), cached->path.end());
+                requests[oldest].status = PathStatus::Found;
+                --pendingCount;
+                ++cacheHits;
+                continue;
+            }
+            activeRequest = oldest;
+            if (hierarchy && hierarchy->isUpToDate() &&
+                manhattan(request.startRow, request.startCol, request.goalRow, request.goalCol) >= HPA_MIN_DISTANCE) {
+                // Long routes: an abstract search on the cluster graph, sliced like a grid search
+                startRow = request.startRow;
+                startCol = request.startCol;
+                goalRow = request.goalRow;
+                goalCol = request.goalCol;
+                searchVersion = maze.getVersion();
+                ++searchCount;
+                hierarchySearch = true;
+                const HierarchicalPathfinder::QueryState begun =
+                    hierarchy->beginQuery(request.startRow, request.startCol, request.goalRow, request.goalCol);
+                state = begun == HierarchicalPathfinder::QueryState::Running ? SearchState::Running : SearchState::NotFound;
+            } else {
+                hierarchySearch = false;
+                beginSearch(request.startRow, request.startCol, request.goalRow, request.goalCol);
+            }
+        }
+
+        const SearchState result = hierarchySearch ? stepHierarchy() : runSearch(CELLS_PER_CHECK);
+        if (result != SearchState::Running) {
+            finishActiveRequest();
+        }
+        if (outOfBudget()) break;
+    }
+}
+
+Pathfinder::SearchState Pathfinder::stepHierarchy() {
+    switch (hierarchy->stepQuery(HIERARCHY_EXPANSIONS_PER_CHECK)) {
+    case HierarchicalPathfinder::QueryState::Running: state = SearchState::Running; break;
+    case HierarchicalPathfinder::QueryState::Found: state = SearchState::Found; break;
+    default: state = SearchState::NotFound; break;
+    }
+    return state;
+}
+
+void Pathfinder::finishActiveRequest() {
+    Request& request = requests[activeRequest];
+    if (hierarchySearch) {
+        hierarchy->takeWaypoints(request.path); // Empty unless the query found a route
+    } else if (state == SearchState::Found) {
+        buildPath(request.path);
+    } else {
+        request.path.clear();
+    }
+    request.status = state == SearchState::Found ? PathStatus::Found : PathStatus::NotFound;
+    if (state == SearchState::Found) {
+        storeCached(request);
+    }
+    --pendingCount;
+    activeRequest = -1;
+    hierarchySearch = false;
+    state = SearchState::Idle;
+}
+
+bool Pathfinder::findPath(int fromRow, int fromCol, int toRow, int toCol, std::vector<PathCell>& path) {
+    const bool park = state == SearchState::Running && activeRequest >= 0;
+    if (park) {
+        swapParkedSearch();
+    }
+    beginSearch(fromRow, fromCol, toRow, toCol);
+    while (runSearch(std::numeric_limits<std::uint64_t>::max()) == SearchState::Running) {}
+    const bool found = state == SearchState::Found;
+    if (found) {
+        buildPath(path);
+    } else {
+        path.clear();
+    }
+    state = SearchState::Idle;
+    activeRequest = -1;
+    if (park) {
+        swapParkedSearch();
+    }
+    return found;
+}
+
+void Pathfinder::swapParkedSearch() {
+    std::swap(state, parked.state);
+    std::swap(activeRequest, parked.activeRequest);
+    std::swap(searchVersion, parked.searchVersion);
+    std::swap(startRow, parked.startRow);
+    std::swap(startCol, parked.startCol);
+    std::swap(goalRow, parked.goalRow);
+    std::swap(goalCol, parked.goalCol);
+    std::swap(goalNode, parked.goalNode);
+    nodes.swap(parked.nodes);
+    openList.swap(parked.openList);
+    lookupNode.swap(parked.lookupNode);
+    lookupStamp.swap(parked.lookupStamp);
+    std::swap(lookupGeneration, parked.lookupGeneration);
+}
+
+bool Pathfinder::refineSegment(const PathCell& from, const PathCell& to, std::vector<PathCell>& cells) {
+    cells.clear();
+    if (manhattan(from.row, from.col, to.row, to.col) <= 1) {
+        if (from.row != to.row || from.col != to.col) cells.push_back(to);
+        return !isBlocked(to.row, to.col);
+    }
+    // Bounded by one cluster; anything else would be an unbudgeted grid search on the caller's frame
+    return hierarchy && hierarchy->isUpToDate() && hierarchy->refineSegment(from, to, cells);
+}
+
+// --- Cache ---
+
+void Pathfinder::validateCache() {
+    if (cacheVersion == maze.getVersion()) return;
+    for (CacheEntry& entry : cache) {
+        entry.lastUsed = 0;
+    }
+    cacheVersion = maze.getVersion();
+}
+
+const Pathfinder::CacheEntry* Pathfinder::findCached(int fromRow, int fromCol, int toRow, int toCol) {
+    validateCache();
+    for (CacheEntry& entry : cache) {
+        if (entry.lastUsed != 0 && entry.startRow == fromRow && entry.startCol == fromCol &&
+            entry.goalRow == toRow && entry.goalCol == toCol) {
+            entry.lastUsed = ++cacheClock;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void Pathfinder::storeCached(const Request& request) {
+    if (cache.empty() || searchVersion != cacheVersion) return;
+    // Replace the least recently used (or an empty) entry
+    CacheEntry* victim = &cache[0];
+    for (CacheEntry& entry : cache) {
+        if (entry.lastUsed < victim->lastUsed) victim = &entry;
+    }
+    victim->startRow = request.startRow;
+    victim->startCol = request.startCol;
+    victim->goalRow = request.goalRow;
+    victim->goalCol = request.goalCol;
+    victim->path.assign(request.path.begin(), request.path.end());
+    victim->lastUsed = ++cacheClock;
+}
+
+// --- Search ---
+
+void Pathfinder::beginSearch(int fromRow, int fromCol, int toRow, int toCol) {
+    startRow = fromRow;
+    startCol = fromCol;
+    goalRow = toRow;
+    goalCol = toCol;
+    searchVersion = maze.getVersion();
+    goalNode = -1;
+    nodes.clear();
+    openList.clear();
+    if (++lookupGeneration == 0) {
+        std::fill(lookupStamp.begin(), lookupStamp.end(), 0);
+        lookupGeneration = 1;
+    }
+    ++searchCount;
+
+    if (isBlocked(fromRow, fromCol) || isBlocked(toRow, toCol)) {
+        state = SearchState::NotFound;
+        return;
+    }
+    bool added;
+    const int start = findOrAddNode(fromRow, fromCol, added);
+    nodes[start].cost = 0;
+    nodes[start].parent = -1;
+    nodes[start].direction = START;
+    pushOpen(start);
+    state = SearchState::Running;
+}
+
+Pathfinder::SearchState Pathfinder::runSearch(std::uint64_t maxScannedCells) {
+    const std::uint64_t startScanned = scannedCells;
+    while (state == SearchState::Running) {
+        if (openList.empty()) {
+            state = SearchState::NotFound;
+            break;
+        }
+        std::pop_heap(openList.begin(), openList.end(), openListAfter);
+        const HeapEntry entry = openList.back();
+        openList.pop_back();
+        Node& node = nodes[entry.node];
+        if (node.closed || entry.cost != node.cost) continue; // Stale duplicate
+        node.closed = true;
+        if (node.row == goalRow && node.col == goalCol) {
+            goalNode = entry.node;
+            state = SearchState::Found;
+            break;
+        }
+        ++expandedNodes;
+        expand(entry.node);
+        if (nodes.size() >= maxNodes) {
+            state = SearchState::NotFound; // Too far; give up rather than grow the pool
+        }
+        if (scannedCells - startScanned >= maxScannedCells) break;
+    }
+    return state;
+}
+
+void Pathfinder::expand(int nodeIndex) {
+    const Node node = nodes[nodeIndex];
+    const int row = node.row, col = node.col;
+    int jump;
+
+    const bool horizontal = node.direction == LEFT || node.direction == RIGHT;
+    if (node.direction == START || horizontal) {
+        // Horizontal arrivals keep going and may turn up or down freely
+        if (node.direction != RIGHT && jumpHorizontal(row, col, -1, jump)) addSuccessor(nodeIndex, row, jump, LEFT);
+        if (node.direction != LEFT && jumpHorizontal(row, col, 1, jump)) addSuccessor(nodeIndex, row, jump, RIGHT);
+        if (jumpVertical(row, col, -1, jump)) addSuccessor(nodeIndex, jump, col, UP);
+        if (jumpVertical(row, col, 1, jump)) addSuccessor(nodeIndex, jump, col, DOWN);
+        return;
+    }
+
+    // Vertical arrivals continue straight and only turn sideways where the cell beside the
+    // previous one is blocked (otherwise turning earlier is the canonical path)
+    const int dRow = node.direction == UP ? -1 : 1;
+    if (jumpVertical(row, col, dRow, jump)) addSuccessor(nodeIndex, jump, col, node.direction);
+    for (int dCol = -1; dCol <= 1; dCol += 2) {
+        if (!isBlocked(row, col + dCol) && isBlocked(row - dRow, col + dCol) &&
+            jumpHorizontal(row, col, dCol, jump)) {
+            addSuccessor(nodeIndex, row, jump, dCol < 0 ? LEFT : RIGHT);
+        }
+    }
+}
+
+// Walk along the row; stop at the goal or at any cell whose vertical scans find a jump point
+bool Pathfinder::jumpHorizontal(int row, int col, int dCol, int& outCol) {
+    int ignored;
+    for (;;) {
+        col += dCol;
+        ++scannedCells;
+        if (isBlocked(row, col)) return false;
+        if ((row == goalRow && col == goalCol) ||
+            jumpVertical(row, col, -1, ignored) || jumpVertical(row, col, 1, ignored)) {
+            outCol = col;
+            return true;
+        }
+    }
+}
+
+// Walk along the column; stop at the goal or where a side opens next to a blocked cell
+bool Pathfinder::jumpVertical(int row, int col, int dRow, int& outRow) {
+    for (;;) {
+        row += dRow;
+        ++scannedCells;
+        if (isBlocked(row, col)) return false;
+        if ((row == goalRow && col == goalCol) ||
+            (!isBlocked(row, col - 1) && isBlocked(row - dRow, col - 1)) ||
+            (!isBlocked(row, col + 1) && isBlocked(row - dRow, col + 1))) {
+            outRow = row;
+            return true;
+        }
+    }
+}
+
+void Pathfinder::addSuccessor(int parentIndex, int row, int col, std::uint8_t direction) {
+    if (nodes.size() >= maxNodes) return;
+    const int cost = nodes[parentIndex].cost + manhattan(row, col, nodes[parentIndex].row, nodes[parentIndex].col);
+    bool added;
+    const int index = findOrAddNode(row, col, added);
+    Node& node = nodes[index];
+    if (!added && (node.closed || node.cost <= cost)) return;
+    node.cost = cost;
+    node.parent = parentIndex;
+    node.direction = direction;
+    pushOpen(index);
+}
+
+int Pathfinder::findOrAddNode(int row, int col, bool& added) {
+    const std::uint64_t key = static_cast<std::uint64_t>(row) * static_cast<std::uint64_t>(maze.getWidth()) + col;
+    size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & lookupMask;
+    for (;;) {
+        if (lookupStamp[slot] != lookupGeneration) {
+            lookupStamp[slot] = lookupGeneration;
+            lookupNode[slot] = static_cast<std::int32_t>(nodes.size());
+            nodes.push_back(Node{ row, col, 0, -1, START, false });
+            added = true;
+            return lookupNode[slot];
+        }
+        const Node& node = nodes[lookupNode[slot]];
+        if (node.row == row && node.col == col) {
+            added = false;
+            return lookupNode[slot];
+        }
+        slot = (slot + 1) & lookupMask;
+    }
+}
+
+void Pathfinder::pushOpen(int nodeIndex) {
+    const Node& node = nodes[nodeIndex];
+    openList.push_back(HeapEntry{ node.cost + manhattan(node.row, node.col, goalRow, goalCol), node.cost, nodeIndex });
+    std::push_heap(openList.begin(), openList.end(), openListAfter);
+}
+
+// Jump points are joined by straight runs; fill in every cell between them
+void Pathfinder::buildPath(std::vector<PathCell>& path) const {
+    path.clear();
+    for (int index = goalNode; index >= 0; index = nodes[index].parent) {
+        const Node& node = nodes[index];
+        if (node.parent < 0) {
+            path.push_back(PathCell{ node.row, node.col });
+            break;
+        }
+        const Node& parent = nodes[node.parent];
+        const int dRow = (parent.row > node.row) - (parent.row < node.row);
+        const int dCol = (parent.col > node.col) - (parent.col < node.col);
+        for (int r = node.row, c = node.col; r != parent.row || c != parent.col; r += dRow, c += dCol) {
+            path.push_back(PathCell{ r, c });
+        }
+    }
+    std::reverse(path.begin(), path.end());
+}
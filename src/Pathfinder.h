@@ -0,0 +1,183 @@
+#pragma once
+
+#include "Config.h" // For PATHFINDER_MAX_NODES, PATH_CACHE_SIZE
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Maze; // Forward declaration
+class HierarchicalPathfinder;
+
+struct PathCell {
+    int row, col;
+};
+
+enum class PathStatus {
+    Pending,  // Queued or being searched
+    Found,    // Path ready to take
+    NotFound, // No route, or the search ran out of nodes
+    Invalid   // Unknown or already taken ticket
+};
+
+// Grid pathfinding service over Maze::isWall for 4-connected movement.
+// Searches use Jump Point Search (the 4-connected variant: straight horizontal jumps scan
+// vertically at every step, vertical jumps stop at forced side openings), so only turning
+// points enter the open list. Callers queue requests and poll tickets; update() spends at
+// most a fixed time budget per frame and resumes an unfinished search on the next call.
+// The clock is read every few thousand scanned cells, not every few jump points, since one
+// jump on an open map can scan whole rows and columns.
+// The node pool, node lookup table and open list are sized once, so queries never allocate
+// (beyond growing a result path); recent paths are cached until the maze version changes.
+class Pathfinder {
+public:
+    typedef std::uint32_t Ticket;
+    static const Ticket INVALID_TICKET = 0;
+
+    // maxNodes bounds the jump points one search may create; longer searches fail
+    explicit Pathfinder(const Maze& maze, size_t maxNodes = PATHFINDER_MAX_NODES);
+
+    // Queue a search from start to goal. Cached routes are answered immediately.
+    Ticket requestPath(int startRow, int startCol, int goalRow, int goalCol);
+
+    // Work on queued searches until budgetMs has been spent or the queue is empty
+    void update(double budgetMs);
+
+    // Same, but stop after expanding about maxExpansions jump points instead of after a time.
+    // Results then land on the same frame on every machine, which replays rely on.
+    void updateExpansions(int maxExpansions);
+
+    PathStatus getStatus(Ticket ticket) const;
+
+    // If the search finished, copy the route (start to goal, inclusive) into path and release
+    // the ticket. Returns the status either way. Routes from the hierarchy are waypoints;
+    // expand each leg with refineSegment() as it is reached.
+    PathStatus takePath(Ticket ticket, std::vector<PathCell>& path);
+
+    // Every cell after `from` up to and including `to`, for consecutive route entries. Only
+    // answers what costs no grid search: adjacent cells, or a leg inside one cluster of an
+    // up-to-date hierarchy. Returns false otherwise; plan the rest through requestPath().
+    bool refineSegment(const PathCell& from, const PathCell& to, std::vector<PathCell>& cells);
+
+    // Answer requests at least HPA_MIN_DISTANCE apart on this hierarchy while it is up to date
+    void setHierarchy(HierarchicalPathfinder* hierarchy) { this->hierarchy = hierarchy; }
+
+    // Drop a request, finished or not
+    void cancel(Ticket ticket);
+
+    // Run one search to completion right away, bypassing the queue and the budget. A queued
+    // search in progress is set aside and continues where it was on the next update().
+    bool findPath(int startRow, int startCol, int goalRow, int goalCol, std::vector<PathCell>& path);
+
+    size_t getPendingCount() const { return pendingCount; }
+    std::uint64_t getExpandedNodes() const { return expandedNodes; }
+    std::uint64_t getCacheHits() const { return cacheHits; }
+    std::uint64_t getSearchCount() const { return searchCount; }
+    std::uint64_t getScannedCells() const { return scannedCells; }
+
+private:
+    enum class SearchState { Idle, Running, Found, NotFound };
+
+    struct Node {
+        int row, col;
+        int cost;         // Path length from the start
+        int parent;       // Node index, -1 for the start
+        std::uint8_t direction; // Direction of the jump that reached the node
+        bool closed;
+    };
+
+    struct HeapEntry {
+        int estimate;     // cost + heuristic
+        int cost;         // Node cost when pushed; stale if the node improved since
+        int node;
+    };
+
+    // Min-heap order for std::push_heap/pop_heap: lowest estimate first, deeper node on ties
+    static bool openListAfter(const HeapEntry& a, const HeapEntry& b) {
+        return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+    }
+
+    struct Request {
+        Ticket ticket;
+        int startRow, startCol, goalRow, goalCol;
+        PathStatus status;
+        std::vector<PathCell> path;
+    };
+
+    struct CacheEntry {
+        int startRow, startCol, goalRow, goalCol;
+        std::uint64_t lastUsed; // 0 if the entry is empty
+        std::vector<PathCell> path;
+    };
+
+    const Maze& maze;
+    size_t maxNodes;
+    HierarchicalPathfinder* hierarchy;
+
+    // Search state, kept between update() calls
+    SearchState state;
+    int activeRequest;        // Index into requests, -1 when searching for findPath
+    bool hierarchySearch;     // The active request is a sliced query on the hierarchy
+    std::uint64_t searchVersion;
+    int startRow, startCol, goalRow, goalCol;
+    int goalNode;             // Node index of the goal once found
+    std::vector<Node> nodes;
+    std::vector<HeapEntry> openList;       // Binary min-heap on estimate
+    std::vector<std::int32_t> lookupNode;  // Open-addressed cell -> node table
+    std::vector<std::uint32_t> lookupStamp;
+    std::uint32_t lookupGeneration;
+    size_t lookupMask;
+
+    // A time-sliced search set aside while findPath() runs. Swapping with it keeps the open
+    // list and both searches' allocations.
+    struct ParkedSearch {
+        SearchState state;
+        int activeRequest;
+        std::uint64_t searchVersion;
+        int startRow, startCol, goalRow, goalCol;
+        int goalNode;
+        std::vector<Node> nodes;
+        std::vector<HeapEntry> openList;
+        std::vector<std::int32_t> lookupNode;
+        std::vector<std::uint32_t> lookupStamp;
+        std::uint32_t lookupGeneration;
+    };
+    ParkedSearch parked;
+    void swapParkedSearch();
+
+    std::vector<Request> requests;
+    size_t pendingCount;
+    Ticket nextTicket;
+
+    std::vector<CacheEntry> cache;
+    std::uint64_t cacheVersion;
+    std::uint64_t cacheClock;
+
+    std::uint64_t expandedNodes;
+    std::uint64_t cacheHits;
+    std::uint64_t searchCount;
+    std::uint64_t scannedCells; // Cells visited by jumps, the unit of search work
+
+    // update() and updateExpansions(): a time budget, or an expansion budget if maxExpansions > 0
+    void serveRequests(double budgetMs, int maxExpansions);
+    bool isBlocked(int row, int col) const;
+    void beginSearch(int fromRow, int fromCol, int toRow, int toCol);
+    // Expand nodes until maxScannedCells cells have been scanned (at least one node);
+    // returns the resulting state
+    SearchState runSearch(std::uint64_t maxScannedCells);
+    // One slice of the active hierarchy query
+    SearchState stepHierarchy();
+    void expand(int nodeIndex);
+    bool jumpHorizontal(int row, int col, int dCol, int& outCol);
+    bool jumpVertical(int row, int col, int dRow, int& outRow);
+    void addSuccessor(int parentIndex, int row, int col, std::uint8_t direction);
+    int findOrAddNode(int row, int col, bool& added);
+    void pushOpen(int nodeIndex);
+    void buildPath(std::vector<PathCell>& path) const;
+
+    Request* findRequest(Ticket ticket);
+    const Request* findRequest(Ticket ticket) const;
+    void finishActiveRequest();
+    void validateCache();
+    const CacheEntry* findCached(int fromRow, int fromCol, int toRow, int toCol);
+    void storeCached(const Request& request);
+};
@@ -0,0 +1,291 @@
+#include "PropRenderer.h"
+#include "MazeCuller.h"
+#include "SceneUniforms.h"
+#include "Config.h" // For shader paths
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    // Texture and default material of each prop type, indexed by PropType
+    struct PropStyle {
+        const char* texture;
+        float specular;
+        float shininess;
+        float tint[4];
+    };
+
+    const PropStyle PROP_STYLES[PropRenderer::PROP_TYPE_COUNT] = {
+        { "table", 0.2f, 16.0f, { 0.9f, 0.85f, 0.8f, 1.0f } },
+        { "chair", 0.1f, 8.0f, { 0.8f, 0.8f, 0.8f, 1.0f } },
+        { "mannequin_skin", 0.4f, 32.0f, { 1.0f, 0.95f, 0.9f, 1.0f } },
+        { "mirror", 0.9f, 96.0f, { 0.9f, 0.95f, 1.0f, 1.0f } },
+    };
+
+    const float RADIANS_TO_DEGREES = 57.2957795f;
+}
+
+PropRenderer::PropRenderer()
+    : meshBuffer(0), instanceBuffer(0), meshes(), placementAttrib(-1), materialAttrib(-1), tintAttrib(-1) {}
+
+PropRenderer::~PropRenderer() {
+    release();
+}
+
+void PropRenderer::release() {
+    if (meshBuffer != 0) {
+        glDeleteBuffers(1, &meshBuffer);
+        meshBuffer = 0;
+    }
+    if (instanceBuffer != 0) {
+        glDeleteBuffers(1, &instanceBuffer);
+        instanceBuffer = 0;
+    }
+    instanceShader.release();
+}
+
+void PropRenderer::initialize(const TextureManager& textures, const SceneUniforms& sceneUniforms) {
+    release();
+
+    // Meshes are modelled in metres around their footprint centre, standing on y = 0, facing +Z
+    std::vector<Vertex> vertices;
+    void (*const builders[PROP_TYPE_COUNT])(std::vector<Vertex>&) = {
+        buildTable, buildChair, buildMannequin, buildMirror,
+    };
+    for (int type = 0; type < PROP_TYPE_COUNT; ++type) {
+        const size_t first = vertices.size();
+        builders[type](vertices);
+        meshes[type].first = static_cast<GLint>(first);
+        meshes[type].count = static_cast<GLsizei>(vertices.size() - first);
+        meshes[type].texture = textures.getHandle(PROP_STYLES[type].texture);
+    }
+
+    glGenBuffers(1, &meshBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!GLEW_VERSION_3_3 || !sceneUniforms.isReady()) {
+        std::cout << "[PropRenderer] Instancing unsupported; props are drawn one call each." << std::endl;
+        return;
+    }
+
+    try {
+        instanceShader.loadFromFiles(SHADER_PROP_INSTANCED_VERT, SHADER_PROP_INSTANCED_FRAG);
+        if (!sceneUniforms.attach(instanceShader)) {
+            throw std::runtime_error("prop shader has no SceneBlock");
+        }
+        placementAttrib = glGetAttribLocation(instanceShader.getProgram(), "instancePlacement");
+        materialAttrib = glGetAttribLocation(instanceShader.getProgram(), "instanceMaterial");
+        tintAttrib = glGetAttribLocation(instanceShader.getProgram(), "instanceTint");
+        if (placementAttrib < 0 || materialAttrib < 0 || tintAttrib < 0) {
+            throw std::runtime_error("instance attributes missing from the prop shader");
+        }
+        instanceShader.use();
+        glUniform1i(instanceShader.getUniform("propTexture"), 0);
+        ShaderProgram::unbind();
+        glGenBuffers(1, &instanceBuffer);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[PropRenderer] Instanced props disabled: " << e.what() << std::endl;
+        instanceShader.release();
+    }
+}
+
+void PropRenderer::clear() {
+    for (auto& list : instances) {
+        list.clear();
+    }
+}
+
+void PropRenderer::add(PropType type, float x, float z, float yaw) {
+    const PropStyle& style = PROP_STYLES[static_cast<int>(type)];
+    Instance instance;
+    instance.x = x;
+    instance.y = 0.0f;
+    instance.z = z;
+    instance.yaw = yaw;
+    instance.scale = 1.0f;
+    instance.specular = style.specular;
+    instance.shininess = style.shininess;
+    instance.unused = 0.0f;
+    instance.r = style.tint[0];
+    instance.g = style.tint[1];
+    instance.b = style.tint[2];
+    instance.a = style.tint[3];
+    instances[static_cast<int>(type)].push_back(instance);
+}
+
+size_t PropRenderer::getInstanceCount() const {
+    size_t total = 0;
+    for (const auto& list : instances) {
+        total += list.size();
+    }
+    return total;
+}
+
+void PropRenderer::draw(const MazeCuller& culler, TextureManager& textures, int& submitted, int& culled) {
+    if (meshBuffer == 0) return;
+
+    // Gather the visible props, grouped by type, into one contiguous array
+    visibleInstances.clear();
+    GLsizei visibleCounts[PROP_TYPE_COUNT] = {};
+    for (int type = 0; type < PROP_TYPE_COUNT; ++type) {
+        for (const Instance& instance : instances[type]) {
+            if (!culler.isPointVisible(instance.x, instance.z)) {
+                ++culled;
+                continue;
+            }
+            visibleInstances.push_back(instance);
+            ++visibleCounts[type];
+        }
+    }
+    submitted += static_cast<int>(visibleInstances.size());
+    if (visibleInstances.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, x)));
+    glNormalPointer(GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, nx)));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, u)));
+
+    if (isInstanced()) {
+        drawInstanced(visibleCounts, textures);
+    } else {
+        drawEach(visibleCounts, textures);
+    }
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PropRenderer::drawInstanced(const GLsizei (&visibleCounts)[PROP_TYPE_COUNT], TextureManager& textures) {
+    // One upload per frame for every type; orphaning keeps it from stalling on last frame's draws
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, visibleInstances.size() * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, visibleInstances.size() * sizeof(Instance), visibleInstances.data());
+
+    instanceShader.use();
+
+    const GLint attribs[3] = { placementAttrib, materialAttrib, tintAttrib };
+    for (GLint attrib : attribs) {
+        glEnableVertexAttribArray(static_cast<GLuint>(attrib));
+        glVertexAttribDivisor(static_cast<GLuint>(attrib), 1);
+    }
+
+    size_t base = 0;
+    for (int type = 0; type < PROP_TYPE_COUNT; ++type) {
+        if (visibleCounts[type] == 0) continue;
+
+        // No base-instance draws in GL 3.3, so point the attributes at this type's block instead
+        const size_t offset = base * sizeof(Instance);
+        glVertexAttribPointer(static_cast<GLuint>(placementAttrib), 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<const void*>(offset + offsetof(Instance, x)));
+        glVertexAttribPointer(static_cast<GLuint>(materialAttrib), 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<const void*>(offset + offsetof(Instance, scale)));
+        glVertexAttribPointer(static_cast<GLuint>(tintAttrib), 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<const void*>(offset + offsetof(Instance, r)));
+
+        textures.bind(meshes[type].texture);
+        glDrawArraysInstanced(GL_TRIANGLES, meshes[type].first, meshes[type].count, visibleCounts[type]);
+        base += static_cast<size_t>(visibleCounts[type]);
+    }
+
+    for (GLint attrib : attribs) {
+        glVertexAttribDivisor(static_cast<GLuint>(attrib), 0);
+        glDisableVertexAttribArray(static_cast<GLuint>(attrib));
+    }
+    ShaderProgram::unbind();
+    glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+}
+
+void PropRenderer::drawEach(const GLsizei (&visibleCounts)[PROP_TYPE_COUNT], TextureManager& textures) {
+    size_t index = 0;
+    for (int type = 0; type < PROP_TYPE_COUNT; ++type) {
+        if (visibleCounts[type] == 0) continue;
+        textures.bind(meshes[type].texture);
+
+        for (GLsizei i = 0; i < visibleCounts[type]; ++i, ++index) {
+            const Instance& instance = visibleInstances[index];
+            const GLfloat specular[] = { instance.specular, instance.specular, instance.specular, 1.0f };
+            glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
+            glMaterialf(GL_FRONT, GL_SHININESS, instance.shininess);
+            glColor4f(instance.r, instance.g, instance.b, instance.a); // GL_COLOR_MATERIAL drives diffuse
+
+            glPushMatrix();
+            glTranslatef(instance.x, instance.y, instance.z);
+            glRotatef(instance.yaw * RADIANS_TO_DEGREES, 0.0f, 1.0f, 0.0f);
+            glScalef(instance.scale, instance.scale, instance.scale);
+            glDrawArrays(GL_TRIANGLES, meshes[type].first, meshes[type].count);
+            glPopMatrix();
+        }
+    }
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void PropRenderer::addBox(std::vector<Vertex>& out, float x0, float y0, float z0, float x1, float y1, float z1) {
+    // Texture coordinates follow the face size so every face shows the texture at the same scale
+    auto quad = [&out](const float (&p)[4][3], float nx, float ny, float nz, float du, float dv) {
+        const float uv[4][2] = { { 0.0f, 0.0f }, { du, 0.0f }, { du, dv }, { 0.0f, dv } };
+        const int order[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i : order) {
+            out.push_back({ p[i][0], p[i][1], p[i][2], nx, ny, nz, uv[i][0], uv[i][1] });
+        }
+    };
+
+    const float sx = x1 - x0, sy = y1 - y0, sz = z1 - z0;
+    const float front[4][3]  = { { x0, y0, z1 }, { x1, y0, z1 }, { x1, y1, z1 }, { x0, y1, z1 } };
+    const float back[4][3]   = { { x1, y0, z0 }, { x0, y0, z0 }, { x0, y1, z0 }, { x1, y1, z0 } };
+    const float left[4][3]   = { { x0, y0, z0 }, { x0, y0, z1 }, { x0, y1, z1 }, { x0, y1, z0 } };
+    const float right[4][3]  = { { x1, y0, z1 }, { x1, y0, z0 }, { x1, y1, z0 }, { x1, y1, z1 } };
+    const float top[4][3]    = { { x0, y1, z1 }, { x1, y1, z1 }, { x1, y1, z0 }, { x0, y1, z0 } };
+    const float bottom[4][3] = { { x0, y0, z0 }, { x1, y0, z0 }, { x1, y0, z1 }, { x0, y0, z1 } };
+    quad(front, 0.0f, 0.0f, 1.0f, sx, sy);
+    quad(back, 0.0f, 0.0f, -1.0f, sx, sy);
+    quad(left, -1.0f, 0.0f, 0.0f, sz, sy);
+    quad(right, 1.0f, 0.0f, 0.0f, sz, sy);
+    quad(top, 0.0f, 1.0f, 0.0f, sx, sz);
+    quad(bottom, 0.0f, -1.0f, 0.0f, sx, sz);
+}
+
+void PropRenderer::buildTable(std::vector<Vertex>& out) {
+    addBox(out, -0.40f, 0.70f, -0.25f, 0.40f, 0.75f, 0.25f); // Top
+    const float legX = 0.35f, legZ = 0.20f, leg = 0.025f;
+    for (float sx : { -1.0f, 1.0f }) {
+        for (float sz : { -1.0f, 1.0f }) {
+            addBox(out, sx * legX - leg, 0.0f, sz * legZ - leg, sx * legX + leg, 0.70f, sz * legZ + leg);
+        }
+    }
+}
+
+void PropRenderer::buildChair(std::vector<Vertex>& out) {
+    addBox(out, -0.20f, 0.42f, -0.20f, 0.20f, 0.47f, 0.20f);  // Seat
+    addBox(out, -0.20f, 0.47f, -0.20f, 0.20f, 0.97f, -0.16f); // Back
+    const float legOffset = 0.17f, leg = 0.02f;
+    for (float sx : { -1.0f, 1.0f }) {
+        for (float sz : { -1.0f, 1.0f }) {
+            addBox(out, sx * legOffset - leg, 0.0f, sz * legOffset - leg, sx * legOffset + leg, 0.42f, sz * legOffset + leg);
+        }
+    }
+}
+
+void PropRenderer::buildMannequin(std::vector<Vertex>& out) {
+    addBox(out, -0.15f, 0.00f, -0.08f, 0.15f, 0.03f, 0.08f);  // Stand base
+    addBox(out, -0.13f, 0.03f, -0.06f, -0.02f, 0.85f, 0.06f); // Legs
+    addBox(out, 0.02f, 0.03f, -0.06f, 0.13f, 0.85f, 0.06f);
+    addBox(out, -0.18f, 0.85f, -0.10f, 0.18f, 1.45f, 0.10f);  // Torso
+    addBox(out, -0.26f, 0.90f, -0.05f, -0.18f, 1.42f, 0.05f); // Arms
+    addBox(out, 0.18f, 0.90f, -0.05f, 0.26f, 1.42f, 0.05f);
+    addBox(out, -0.04f, 1.45f, -0.04f, 0.04f, 1.52f, 0.04f);  // Neck
+    addBox(out, -0.10f, 1.52f, -0.11f, 0.10f, 1.74f, 0.10f);  // Head
+}
+
+void PropRenderer::buildMirror(std::vector<Vertex>& out) {
+    addBox(out, -0.25f, 0.00f, -0.15f, 0.25f, 0.04f, 0.15f);  // Foot
+    addBox(out, -0.35f, 0.04f, -0.03f, 0.35f, 1.80f, 0.03f);  // Frame
+    addBox(out, -0.30f, 0.10f, 0.03f, 0.30f, 1.74f, 0.035f);  // Glass, proud of the frame
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "TextureManager.h" // For TextureHandle
+#include "ShaderProgram.h"
+#include <vector>
+
+class MazeCuller;    // Forward declaration
+class SceneUniforms; // Forward declaration
+
+// Furniture kinds drawn by PropRenderer
+enum class PropType {
+    Table,
+    Chair,
+    Mannequin,
+    Mirror,
+};
+
+// Furniture props drawn from meshes baked once at startup.
+// Every placed prop is one entry in a per-frame instance buffer (position, yaw, scale,
+// material and tint); each prop type is then drawn with a single instanced call.
+// Without GL 3.3 instancing the same meshes are drawn once per instance instead.
+class PropRenderer {
+public:
+    static const int PROP_TYPE_COUNT = 4;
+
+    // Per-instance data, uploaded as-is to the instance buffer
+    struct Instance {
+        float x, y, z;
+        float yaw;        // Radians around +Y
+        float scale;
+        float specular;   // Specular strength
+        float shininess;  // Specular exponent
+        float unused;
+        float r, g, b, a; // Tint multiplied with the texture
+    };
+
+    PropRenderer();
+    ~PropRenderer();
+
+    PropRenderer(const PropRenderer&) = delete;
+    PropRenderer& operator=(const PropRenderer&) = delete;
+
+    // Bake the prop meshes, resolve their textures and load the instancing shader.
+    // Call once the GL context exists; the shader needs the SceneBlock uniform buffer and is
+    // optional: if it cannot be used the props fall back to one draw call each.
+    void initialize(const TextureManager& textures, const SceneUniforms& sceneUniforms);
+
+    // Delete the GPU buffers and the shader
+    void release();
+
+    // Remove every placed prop
+    void clear();
+
+    // Place a prop standing on the floor at (x, z), turned yaw radians, with the type's default material
+    void add(PropType type, float x, float z, float yaw);
+
+    // Draw every prop whose cell the culler marked visible.
+    // Adds the number of drawn and culled props to submitted / culled.
+    void draw(const MazeCuller& culler, TextureManager& textures, int& submitted, int& culled);
+
+    size_t getInstanceCount() const;
+    bool isInstanced() const { return instanceShader.isLoaded(); }
+
+private:
+    // Interleaved mesh vertex, the same layout the fixed-function arrays read
+    struct Vertex {
+        float x, y, z;
+        float nx, ny, nz;
+        float u, v;
+    };
+
+    // Slice of the mesh buffer holding one prop type
+    struct MeshRange {
+        GLint first;
+        GLsizei count;
+        TextureHandle texture;
+    };
+
+    GLuint meshBuffer;
+    GLuint instanceBuffer;
+    MeshRange meshes[PROP_TYPE_COUNT];
+    std::vector<Instance> instances[PROP_TYPE_COUNT];
+    std::vector<Instance> visibleInstances; // Scratch: visible props of every type, grouped by type
+
+    ShaderProgram instanceShader;
+    GLint placementAttrib;
+    GLint materialAttrib;
+    GLint tintAttrib;
+
+    // Axis-aligned box from (x0, y0, z0) to (x1, y1, z1) as 12 triangles
+    static void addBox(std::vector<Vertex>& out, float x0, float y0, float z0, float x1, float y1, float z1);
+    static void buildTable(std::vector<Vertex>& out);
+    static void buildChair(std::vector<Vertex>& out);
+    static void buildMannequin(std::vector<Vertex>& out);
+    static void buildMirror(std::vector<Vertex>& out);
+
+    void drawInstanced(const GLsizei (&visibleCounts)[PROP_TYPE_COUNT], TextureManager& textures);
+    void drawEach(const GLsizei (&visibleCounts)[PROP_TYPE_COUNT], TextureManager& textures);
+};
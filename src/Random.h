@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Seeded xoshiro256** generator. Each subsystem owns one, seeded from the game seed plus a
+// stream number of its own, so extra draws in one subsystem never shift another's sequence
+// and a recorded seed reproduces every random decision of a run. Unlike rand() there is no
+// hidden global state, and the sequence is the same on every platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed = 0, std::uint64_t stream = 0) { reseed(seed, stream); }
+
+    void reseed(std::uint64_t seed, std::uint64_t stream = 0) {
+        std::uint64_t mix = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+        for (std::uint64_t& word : state) {
+            word = splitMix64(mix);
+        }
+    }
+
+    std::uint64_t next64() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    std::uint32_t next() { return static_cast<std::uint32_t>(next64() >> 32); }
+
+    // Uniform in [0, n)
+    int below(int n) { return static_cast<int>((static_cast<std::uint64_t>(next()) * static_cast<std::uint32_t>(n)) >> 32); }
+
+    // Uniform in [low, high]
+    int between(int low, int high) { return low + below(high - low + 1); }
+
+    bool chance(float p) { return next() < static_cast<double>(p) * 4294967296.0; }
+
+    // One step of SplitMix64: spreads consecutive or low-entropy seeds over the whole
+    // 64-bit range. Used to derive generator states from a seed and a stream number.
+    static std::uint64_t splitMix64(std::uint64_t& mix) {
+        std::uint64_t z = (mix += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+};
@@ -1,174 +1,597 @@
-// Renderer_Refactored.cpp
-// Refactored version with improved structure and maintainability.
-
-#include "Renderer.h"
-#include "TextureManager.h"
-#include "Camera.h"
-#include "Maze.h"
-#include "Ghost.h"
-#include "Config.h"
-#include <stdexcept>
-#include <iostream>
-#include <cmath>
-
-// === HELPER FUNCTIONS ===
-namespace {
-    void computeNormal(float x1, float y1, float z1, float x2, float y2, float z2,
-                       float& nx, float& ny, float& nz) {
-        float ux = x2 - x1;
-        float uy = y2 - y1;
-        float uz = z2 - z1;
-        float vx = 0.0f, vy = 1.0f, vz = 0.0f; // vertical vector
-
-        nx = uy * vz - uz * vy;
-        ny = uz * vx - ux * vz;
-        nz = ux * vy - uy * vx;
-
-        float len = std::sqrt(nx * nx + ny * ny + nz * nz);
-        if (len > 0.0f) {
-            nx /= len;
-            ny /= len;
-            nz /= len;
-        }
-    }
-
-    void safeBindTexture(TextureManager& tm, const std::string& name) {
-        try {
-            tm.bindTexture(name);
-        } catch (...) {
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
-    }
-
-    void setMaterial(const GLfloat* amb_diff, const GLfloat* spec, GLfloat shine) {
-        glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, amb_diff);
-        glMaterialfv(GL_FRONT, GL_SPECULAR, spec);
-        glMaterialf(GL_FRONT, GL_SHININESS, shine);
-    }
-}
-
-// === CLASS IMPLEMENTATION ===
-Renderer::Renderer(TextureManager& texManager)
-    : textureManager(texManager),
-      windowWidth(WINDOW_WIDTH),
-      windowHeight(WINDOW_HEIGHT),
-      lightOn(true),
-      lightIntensity(1.0f),
-      fogEnabled(true) {}
-
-Renderer::~Renderer() {
-    textureManager.releaseAllTextures();
-}
-
-bool Renderer::initialize() {
-    glewExperimental = GL_TRUE;
-    GLenum err = glewInit();
-    if (GLEW_OK != err) {
-        std::cerr << "Error initializing GLEW: " << glewGetErrorString(err) << std::endl;
-        return false;
-    }
-
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glShadeModel(GL_SMOOTH);
-
-    try {
-        textureManager.loadAll();
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Texture loading failed: " << e.what() << std::endl;
-    }
-
-    setupLighting();
-    setupFog();
-    initializeBloodstains();
-
-    return true;
-}
-
-void Renderer::reshape(int width, int height) {
-    windowWidth = width ? width : 1;
-    windowHeight = height ? height : 1;
-
-    glViewport(0, 0, windowWidth, windowHeight);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluPerspective(45.0f, (GLfloat)windowWidth / windowHeight, 0.1f, 100.0f);
-    glMatrixMode(GL_MODELVIEW);
-}
-
-void Renderer::beginFrame(const Camera& camera) {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    camera.applyViewMatrix();
-
-    GLfloat lightPos[] = { camera.getX(), camera.getY() + 1.0f, camera.getZ(), 1.0f };
-    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
-
-    lightOn ? glEnable(GL_LIGHTING) : glDisable(GL_LIGHTING);
-    lightOn ? glEnable(GL_LIGHT0) : glDisable(GL_LIGHT0);
-    fogEnabled ? glEnable(GL_FOG) : glDisable(GL_FOG);
-}
-
-void Renderer::endFrame() {
-    glutSwapBuffers();
-}
-
-void Renderer::setLight(bool on, float intensity) {
-    lightOn = on;
-    lightIntensity = intensity;
-
-    GLfloat ambient[] = { 0.1f * intensity, 0.1f * intensity, 0.1f * intensity, 1.0f };
-    GLfloat diffuse[] = { 0.6f * intensity, 0.6f * intensity, 0.6f * intensity, 1.0f };
-    GLfloat specular[] = { 0.3f * intensity, 0.3f * intensity, 0.3f * intensity, 1.0f };
-
-    glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, specular);
-}
-
-void Renderer::setupLighting() {
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_COLOR_MATERIAL);
-    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
-    setLight(lightOn, lightIntensity);
-
-    GLfloat globalAmbient[] = { 0.1f, 0.1f, 0.1f, 1.0f };
-    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globalAmbient);
-
-    glLightf(GL_LIGHT0, GL_CONSTANT_ATTENUATION, 1.0);
-    glLightf(GL_LIGHT0, GL_LINEAR_ATTENUATION, 0.05);
-    glLightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, 0.01);
-
-    GLfloat spec[] = { 0.8f, 0.8f, 0.8f, 1.0f };
-    glMaterialfv(GL_FRONT, GL_SPECULAR, spec);
-    glMateriali(GL_FRONT, GL_SHININESS, 50);
-}
-
-void Renderer::setupFog() {
-    GLfloat fogColor[] = { 0.05f, 0.05f, 0.05f, 1.0f };
-    glFogi(GL_FOG_MODE, GL_EXP2);
-    glFogfv(GL_FOG_COLOR, fogColor);
-    glFogf(GL_FOG_DENSITY, 0.15f);
-    glHint(GL_FOG_HINT, GL_NICEST);
-    glFogf(GL_FOG_START, 1.0f);
-    glFogf(GL_FOG_END, 15.0f);
-
-    if (fogEnabled) glEnable(GL_FOG);
-}
-
-// Additional draw functions should be refactored similarly with helpers and cleanups
-// For brevity, they are not all included here but follow the same cleanup strategy.
-
-// Example stub:
-void Renderer::drawWall(...) {
-    // Use computeNormal() for normals
-    // Use safeBindTexture() instead of try/catch everywhere
-    // Replace glBegin/glEnd with VBOs eventually
-}
-
-// ... Other drawing and utility methods
+// Renderer_Refactored.cpp
+// Refactored version with improved structure and maintainability.
+
+#include "Renderer.h"
+#include "TextureManager.h"
+#include "Camera.h"
+#include "Maze.h"
+#include "Ghost.h"
+#include "GhostSystem.h"
+#include "Config.h"
+#include "MathUtil.h"
+#include "Trace.h"
+#include <stdexcept>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+
+// === HELPER FUNCTIONS ===
+namespace {
+    void computeNormal(float x1, float y1, float z1, float x2, float y2, float z2,
+                       float& nx, float& ny, float& nz) {
+        float ux = x2 - x1;
+        float uy = y2 - y1;
+        float uz = z2 - z1;
+        float vx = 0.0f, vy = 1.0f, vz = 0.0f; // vertical vector
+
+        nx = uy * vz - uz * vy;
+        ny = uz * vx - ux * vz;
+        nz = ux * vy - uy * vx;
+
+        float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        if (len > 0.0f) {
+            nx /= len;
+            ny /= len;
+            nz /= len;
+        }
+    }
+
+    // Light and fog parameters, shared by the SceneBlock shaders and the fixed-function draws
+    const GLfloat LIGHT_AMBIENT[] = { 0.1f, 0.1f, 0.1f, 1.0f };
+    const GLfloat LIGHT_DIFFUSE[] = { 0.6f, 0.6f, 0.6f, 1.0f };
+    const GLfloat LIGHT_SPECULAR[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+    const GLfloat GLOBAL_AMBIENT[] = { 0.1f, 0.1f, 0.1f, 1.0f };
+    const GLfloat LIGHT_ATTENUATION[] = { 1.0f, 0.05f, 0.01f, 0.0f }; // Constant, linear, quadratic
+    const GLfloat FOG_COLOR[] = { 0.05f, 0.05f, 0.05f, 1.0f };
+
+    void copyVec4(float* out, const GLfloat* in) {
+        for (int i = 0; i < 4; ++i) out[i] = in[i];
+    }
+
+    void setMaterial(const GLfloat* amb_diff, const GLfloat* spec, GLfloat shine) {
+        glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, amb_diff);
+        glMaterialfv(GL_FRONT, GL_SPECULAR, spec);
+        glMaterialf(GL_FRONT, GL_SHININESS, shine);
+    }
+}
+
+// === CLASS IMPLEMENTATION ===
+Renderer::Renderer(TextureManager& texManager)
+    : textureManager(texManager),
+      windowWidth(WINDOW_WIDTH),
+      windowHeight(WINDOW_HEIGHT),
+      lightOn(true),
+      lightIntensity(1.0f),
+      fogEnabled(true),
+      fieldOfView(CAMERA_FOV),
+      nearPlane(CAMERA_NEAR),
+      farPlane(CAMERA_FAR),
+      mazeMeshVersion(0),
+      sceneArrayTexture(INVALID_TEXTURE_HANDLE),
+      sceneArrayReady(false),
+      legacyLightDirty(true),
+      bloodTexture(INVALID_TEXTURE_HANDLE),
+      cullStats(),
+      visibilitySet(nullptr),
+      eyeX(0.0f),
+      eyeZ(0.0f),
+      sceneCulled(false) {}
+
+Renderer::~Renderer() {
+    mazeMesh.release();
+    mazeArrayShader.release();
+    props.release();
+    sceneUniforms.release();
+    profiler.release();
+    textureManager.releaseAllTextures();
+}
+
+bool Renderer::initialize() {
+    TRACE_SCOPE("Renderer::initialize");
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+    if (GLEW_OK != err) {
+        std::cerr << "Error initializing GLEW: " << glewGetErrorString(err) << std::endl;
+        return false;
+    }
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glShadeModel(GL_SMOOTH);
+    profiler.initialize();
+
+    // Lighting and fog feed both the scene shaders (through the SceneBlock buffer) and the
+    // few objects still drawn with the fixed-function pipeline
+    if (!sceneUniforms.initialize()) {
+        std::cout << "Uniform buffers unsupported; scene uses fixed-function lighting and fog." << std::endl;
+    }
+    setupLighting();
+    setupFog();
+
+    // Textures decode in the background and stream in from beginFrame; until then
+    // their handles draw a fallback texture. The scene array is declared first so it
+    // fills from the same decodes.
+    initializeSceneArray();
+    textureManager.beginLoadAll();
+    bloodTexture = textureManager.getHandle("blood");
+    props.initialize(textureManager, sceneUniforms);
+
+    return true;
+}
+
+void Renderer::reshape(int width, int height) {
+    windowWidth = width ? width : 1;
+    windowHeight = height ? height : 1;
+
+    glViewport(0, 0, windowWidth, windowHeight);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(fieldOfView, (GLfloat)windowWidth / windowHeight, nearPlane, farPlane);
+    glMatrixMode(GL_MODELVIEW);
+}
+
+void Renderer::beginFrame(const Camera& camera) {
+    TRACE_SCOPE("Renderer::beginFrame");
+    profiler.beginFrame();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    camera.applyViewMatrix();
+
+    // Fixed-function state, used only by the draws that have not moved to shaders
+    GLfloat lightPos[] = { camera.getX(), camera.getY() + 1.0f, camera.getZ(), 1.0f };
+    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    if (legacyLightDirty) {
+        applyLegacyLight();
+    }
+
+    lightOn ? glEnable(GL_LIGHTING) : glDisable(GL_LIGHTING);
+    lightOn ? glEnable(GL_LIGHT0) : glDisable(GL_LIGHT0);
+    fogEnabled ? glEnable(GL_FOG) : glDisable(GL_FOG);
+
+    // Everything the scene shaders need for the frame, in one upload
+    if (sceneUniforms.isReady()) {
+        SceneUniforms::Block& block = sceneUniforms.data();
+        camera.getViewMatrix(block.view);
+        MathUtil::perspective(block.projection, fieldOfView, static_cast<float>(windowWidth) / windowHeight,
+                              nearPlane, farPlane);
+        block.cameraPosition[0] = camera.getX();
+        block.cameraPosition[1] = camera.getY();
+        block.cameraPosition[2] = camera.getZ();
+        block.cameraPosition[3] = 1.0f;
+        copyVec4(block.lightPosition, lightPos);
+        block.lightIntensity = lightIntensity;
+        block.lightingEnabled = lightOn ? 1 : 0;
+        block.fogEnabled = fogEnabled ? 1 : 0;
+        sceneUniforms.upload();
+    }
+
+    eyeX = camera.getX();
+    eyeZ = camera.getZ();
+    frustum.setFromCamera(camera.getX(), camera.getY(), camera.getZ(),
+                          camera.getAngleY(), camera.getAngleX(),
+                          fieldOfView, static_cast<float>(windowWidth) / windowHeight,
+                          nearPlane, farPlane);
+    cullStats = CullStats();
+    sceneCulled = false;
+    textureManager.resetBindCounters();
+    if (textureManager.isLoading()) {
+        textureManager.pumpUploads(TEXTURE_UPLOAD_BUDGET_MS);
+    }
+}
+
+void Renderer::endFrame() {
+    TRACE_SCOPE("Renderer::endFrame");
+    {
+        FrameProfiler::Scope pass(profiler, FramePass::Swap);
+        glutSwapBuffers();
+    }
+    profiler.endFrame();
+}
+
+void Renderer::setLight(bool on, float intensity) {
+    lightOn = on;
+    lightIntensity = intensity;
+
+    // A flicker is one uniform write; the fixed-function copy catches up once in the next beginFrame
+    sceneUniforms.setLightIntensity(intensity);
+    legacyLightDirty = true;
+}
+
+void Renderer::applyLegacyLight() {
+    GLfloat ambient[4], diffuse[4], specular[4];
+    for (int i = 0; i < 3; ++i) {
+        ambient[i] = LIGHT_AMBIENT[i] * lightIntensity;
+        diffuse[i] = LIGHT_DIFFUSE[i] * lightIntensity;
+        specular[i] = LIGHT_SPECULAR[i] * lightIntensity;
+    }
+    ambient[3] = diffuse[3] = specular[3] = 1.0f;
+
+    glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+    glLightfv(GL_LIGHT0, GL_SPECULAR, specular);
+    legacyLightDirty = false;
+}
+
+void Renderer::setupLighting() {
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+    applyLegacyLight();
+
+    glLightModelfv(GL_LIGHT_MODEL_AMBIENT, GLOBAL_AMBIENT);
+
+    glLightf(GL_LIGHT0, GL_CONSTANT_ATTENUATION, LIGHT_ATTENUATION[0]);
+    glLightf(GL_LIGHT0, GL_LINEAR_ATTENUATION, LIGHT_ATTENUATION[1]);
+    glLightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, LIGHT_ATTENUATION[2]);
+
+    SceneUniforms::Block& block = sceneUniforms.data();
+    copyVec4(block.lightAmbient, LIGHT_AMBIENT);
+    copyVec4(block.lightDiffuse, LIGHT_DIFFUSE);
+    copyVec4(block.lightSpecular, LIGHT_SPECULAR);
+    copyVec4(block.globalAmbient, GLOBAL_AMBIENT);
+    copyVec4(block.attenuation, LIGHT_ATTENUATION);
+    block.lightIntensity = lightIntensity;
+
+    GLfloat spec[] = { 0.8f, 0.8f, 0.8f, 1.0f };
+    glMaterialfv(GL_FRONT, GL_SPECULAR, spec);
+    glMateriali(GL_FRONT, GL_SHININESS, 50);
+}
+
+void Renderer::setupFog() {
+    glFogi(GL_FOG_MODE, GL_EXP2);
+    glFogfv(GL_FOG_COLOR, FOG_COLOR);
+    glFogf(GL_FOG_DENSITY, FOG_DENSITY);
+    glHint(GL_FOG_HINT, GL_NICEST);
+    glFogf(GL_FOG_START, 1.0f);
+    glFogf(GL_FOG_END, 15.0f);
+
+    if (fogEnabled) glEnable(GL_FOG);
+
+    // The shaders evaluate the same EXP2 fog per pixel from the SceneBlock
+    SceneUniforms::Block& block = sceneUniforms.data();
+    copyVec4(block.fogColor, FOG_COLOR);
+    block.fogColor[3] = FOG_DENSITY;
+}
+
+void Renderer::initializeSceneArray() {
+    sceneArrayReady = false;
+    if (!TextureManager::supportsTextureArrays() || !sceneUniforms.isReady()) {
+        std::cout << "Texture arrays or uniform buffers unsupported; maze uses per-texture binds." << std::endl;
+        return;
+    }
+
+    try {
+        // Same-sized static scene textures; MazeMesh stores each one's layer in its vertices
+        textureManager.loadTextureArray("scene", { "wall", "brick", "stone", "floor", "ceiling" });
+        sceneArrayTexture = textureManager.getHandle("scene");
+        mazeArrayShader.loadFromFiles(SHADER_MAZE_ARRAY_VERT, SHADER_MAZE_ARRAY_FRAG);
+        if (!sceneUniforms.attach(mazeArrayShader)) {
+            throw std::runtime_error("maze shader has no SceneBlock");
+        }
+        mazeArrayShader.use();
+        glUniform1i(mazeArrayShader.getUniform("sceneTextures"), 0);
+        ShaderProgram::unbind();
+        sceneArrayReady = true;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Scene texture array disabled: " << e.what() << std::endl;
+        mazeArrayShader.release();
+    }
+}
+
+void Renderer::buildMazeMesh(const Maze& maze) {
+    TRACE_SCOPE("Renderer::buildMazeMesh");
+    mazeMesh.build(maze, textureManager);
+    mazeMeshVersion = maze.getVersion();
+    initializeBloodstains(maze);
+}
+
+void Renderer::initializeBloodstains(const Maze& maze) {
+    // Same cell hash as the wall variants, so a maze always gets the same stains. Each chosen
+    // open cell picks one of its sides; the stain is placed only if that side is a wall.
+    static const int dRow[4] = { -1, 0, 1, 0 };
+    static const int dCol[4] = { 0, -1, 0, 1 };
+    bloodstains.clear();
+    for (int row = 0; row < maze.getHeight(); ++row) {
+        for (int col = 0; col < maze.getWidth(); ++col) {
+            const unsigned int hash = Maze::cellHash(row, col);
+            if (maze.isWall(row, col) || hash % BLOODSTAIN_ONE_IN != 0) continue;
+            const int side = static_cast<int>((hash >> 8) & 3);
+            if (!maze.isWall(row + dRow[side], col + dCol[side])) continue;
+
+            // Just off the wall face, inside the open cell, so culling finds the stain in this cell.
+            // The sides are ordered so that side is also wallIndex, which turns the decal's +Z
+            // normal into the cell: north wall +Z, west +X, south -Z, east -X.
+            Bloodstain stain;
+            stain.x = col + 0.5f + dCol[side] * 0.49f;
+            stain.z = row + 0.5f + dRow[side] * 0.49f;
+            stain.y = 0.6f + ((hash >> 10) & 0xff) / 255.0f * 1.2f;
+            stain.size = 0.4f + ((hash >> 18) & 0x3f) / 63.0f * 0.4f;
+            stain.angle = static_cast<float>((hash >> 24) % 360);
+            stain.wallIndex = side;
+            bloodstains.push_back(stain);
+        }
+    }
+    std::cout << "Placed " << bloodstains.size() << " bloodstains" << std::endl;
+}
+
+float Renderer::getCullDistance() const {
+    if (!fogEnabled) return farPlane;
+    // GL_EXP2 fog factor exp(-(density * d)^2) drops below 1/255 at sqrt(ln 255) / density
+    return std::min(farPlane, std::sqrt(std::log(255.0f)) / FOG_DENSITY);
+}
+
+void Renderer::cullScene(const Maze& maze) {
+    TRACE_SCOPE("Renderer::cullScene");
+    culler.cull(maze, frustum, eyeX, eyeZ, getCullDistance(), visibilitySet);
+    cullStats.cellsTested = culler.getCellsTested();
+    cullStats.cellsOccluded = culler.getCellsOccluded();
+    cullStats.cellsVisible = static_cast<int>(culler.getVisibleCells().size());
+    sceneCulled = true;
+}
+
+void Renderer::drawMaze(const Maze& maze) {
+    TRACE_SCOPE("Renderer::drawMaze");
+    if (!mazeMesh.isBuilt() || mazeMeshVersion != maze.getVersion()) {
+        buildMazeMesh(maze);
+    }
+
+    // Mark every chunk that holds at least one visible cell
+    const int chunkCount = mazeMesh.getChunkCount();
+    chunkVisible.assign(chunkCount, sceneCulled ? 0 : 1);
+    if (sceneCulled) {
+        const int width = maze.getWidth();
+        for (int cell : culler.getVisibleCells()) {
+            const int row = cell / width, col = cell % width;
+            chunkVisible[(row / MazeMesh::CHUNK_SIZE) * mazeMesh.getChunksX() + col / MazeMesh::CHUNK_SIZE] = 1;
+        }
+    }
+    for (unsigned char visible : chunkVisible) {
+        visible ? ++cullStats.chunksSubmitted : ++cullStats.chunksCulled;
+    }
+
+    static const GLfloat white[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const GLfloat lowSpec[] = { 0.1f, 0.1f, 0.1f, 1.0f };
+    setMaterial(white, lowSpec, 10.0f);
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    // Gather the visible chunks of one texture range into the multi-draw scratch arrays
+    auto gatherVisible = [&](const MazeMesh::Range& range) {
+        for (int chunk = 0; chunk < chunkCount; ++chunk) {
+            if (!chunkVisible[chunk] || range.chunkCount[chunk] == 0) continue;
+            drawFirsts.push_back(range.chunkFirst[chunk]);
+            drawCounts.push_back(range.chunkCount[chunk]);
+        }
+    };
+
+    mazeMesh.bind();
+    if (sceneArrayReady) {
+        // Every surface samples its own layer, so one bind and one call draw the whole maze
+        drawFirsts.clear();
+        drawCounts.clear();
+        for (const MazeMesh::Range& range : mazeMesh.getRanges()) {
+            gatherVisible(range);
+        }
+        if (!drawFirsts.empty()) {
+            mazeArrayShader.use();
+            textureManager.bind(sceneArrayTexture);
+            glMultiDrawArrays(GL_TRIANGLES, drawFirsts.data(), drawCounts.data(),
+                              static_cast<GLsizei>(drawFirsts.size()));
+            ShaderProgram::unbind();
+        }
+    } else {
+        for (const MazeMesh::Range& range : mazeMesh.getRanges()) {
+            drawFirsts.clear();
+            drawCounts.clear();
+            gatherVisible(range);
+            if (drawFirsts.empty()) continue;
+
+            textureManager.bind(range.texture);
+            glMultiDrawArrays(GL_TRIANGLES, drawFirsts.data(), drawCounts.data(),
+                              static_cast<GLsizei>(drawFirsts.size()));
+        }
+    }
+    mazeMesh.unbind();
+}
+
+void Renderer::drawFurniture() {
+    TRACE_SCOPE("Renderer::drawFurniture");
+    props.draw(culler, textureManager, cullStats.propsSubmitted, cullStats.propsCulled);
+}
+
+void Renderer::drawDecorations() {
+    TRACE_SCOPE("Renderer::drawDecorations");
+    drawBloodstains();
+}
+
+void Renderer::drawBloodstains() {
+    TRACE_SCOPE("Renderer::drawBloodstains");
+    textureManager.bind(bloodTexture);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f); // Keep decals in front of the wall they sit on
+    glDepthMask(GL_FALSE);
+
+    for (const Bloodstain& stain : bloodstains) {
+        if (!culler.isPointVisible(stain.x, stain.z)) {
+            ++cullStats.decalsCulled;
+            continue;
+        }
+        ++cullStats.decalsSubmitted;
+
+        const float half = stain.size * 0.5f;
+        glPushMatrix();
+        glTranslatef(stain.x, stain.y, stain.z);
+        glRotatef(90.0f * stain.wallIndex, 0.0f, 1.0f, 0.0f); // wallIndex: which way the wall faces
+        glRotatef(stain.angle, 0.0f, 0.0f, 1.0f);
+        glBegin(GL_QUADS);
+        glNormal3f(0.0f, 0.0f, 1.0f);
+        glTexCoord2f(0.0f, 0.0f); glVertex3f(-half, -half, 0.0f);
+        glTexCoord2f(1.0f, 0.0f); glVertex3f(half, -half, 0.0f);
+        glTexCoord2f(1.0f, 1.0f); glVertex3f(half, half, 0.0f);
+        glTexCoord2f(0.0f, 1.0f); glVertex3f(-half, half, 0.0f);
+        glEnd();
+        glPopMatrix();
+    }
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+}
+
+void Renderer::beginGhostPass() {
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_LIGHTING); // Ghosts glow faintly rather than take the torch light
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE); // Translucent: walls behind still show through
+    glColor4f(0.85f, 0.9f, 1.0f, 0.45f);
+}
+
+void Renderer::endGhostPass() {
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    if (lightOn) glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+}
+
+void Renderer::drawGhostFigure(float x, float z) {
+    glPushMatrix();
+    glTranslatef(x, 0.0f, z);
+    glPushMatrix();
+    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f); // Cone axis from +z to +y, apex up
+    glutSolidCone(0.25, WALL_HEIGHT * 0.6, 12, 1);
+    glPopMatrix();
+    glTranslatef(0.0f, WALL_HEIGHT * 0.6f, 0.0f);
+    glutSolidSphere(0.15, 12, 8);
+    glPopMatrix();
+}
+
+void Renderer::drawGhost(const Ghost& ghost, float alpha) {
+    TRACE_SCOPE("Renderer::drawGhost");
+    if (!ghost.isVisible()) return;
+    const float x = ghost.getInterpolatedX(alpha), z = ghost.getInterpolatedZ(alpha);
+    if (!culler.isPointVisible(x, z)) return;
+    beginGhostPass();
+    drawGhostFigure(x, z);
+    endGhostPass();
+}
+
+void Renderer::drawGhostSwarm(const GhostSystem& swarm, float alpha) {
+    TRACE_SCOPE("Renderer::drawGhostSwarm");
+    if (swarm.getVisibleCount() == 0) return;
+    beginGhostPass();
+    for (int i = 0; i < swarm.getCount(); ++i) {
+        if (!swarm.isVisible(i)) continue;
+        const float x = swarm.getInterpolatedX(i, alpha), z = swarm.getInterpolatedZ(i, alpha);
+        if (culler.isPointVisible(x, z)) {
+            drawGhostFigure(x, z);
+        }
+    }
+    endGhostPass();
+}
+
+void Renderer::drawKey(float x, float z) {
+    TRACE_SCOPE("Renderer::drawKey");
+    if (!culler.isPointVisible(x, z)) return;
+    glPushMatrix();
+    glTranslatef(x, 0.3f, z); // Slightly above the floor
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_LIGHTING); // Bright whatever the torch does
+    glColor3f(1.0f, 1.0f, 0.0f);
+    glutSolidCube(0.15f);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    if (lightOn) glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glPopMatrix();
+}
+
+void Renderer::renderText(float x, float y, const std::string& text, void* font) {
+    glRasterPos2f(x, y);
+    for (char ch : text) {
+        glutBitmapCharacter(font, ch);
+    }
+}
+
+void Renderer::drawUI(bool gameWon, bool hasKey) {
+    TRACE_SCOPE("Renderer::drawUI");
+    // Switch to a pixel-space orthographic projection for the overlay
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, windowWidth, 0, windowHeight);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_FOG);
+
+    glColor3f(0.8f, 0.1f, 0.1f);
+    if (gameWon) {
+        renderText(windowWidth / 2.0f - 80.0f, windowHeight / 2.0f, "You escaped!");
+    } else {
+        renderText(20.0f, windowHeight - 30.0f, hasKey ? "Key: found - find the exit" : "Key: missing");
+    }
+
+    CullStats& s = cullStats;
+    s.textureBinds = textureManager.getBindsIssued();
+    s.textureBindsAvoided = textureManager.getBindsAvoided();
+    glColor3f(0.6f, 0.6f, 0.6f);
+    renderText(20.0f, 40.0f,
+               "Cells " + std::to_string(s.cellsVisible) + "/" + std::to_string(s.cellsTested) +
+               " (" + std::to_string(s.cellsOccluded) + " hidden by PVS)" +
+               "  Chunks " + std::to_string(s.chunksSubmitted) + " drawn " + std::to_string(s.chunksCulled) + " culled",
+               GLUT_BITMAP_HELVETICA_12);
+    renderText(20.0f, 24.0f,
+               "Props " + std::to_string(s.propsSubmitted) + " drawn " + std::to_string(s.propsCulled) + " culled" +
+               "  Decals " + std::to_string(s.decalsSubmitted) + " drawn " + std::to_string(s.decalsCulled) + " culled" +
+               "  Binds " + std::to_string(s.textureBinds) + " issued " + std::to_string(s.textureBindsAvoided) + " skipped",
+               GLUT_BITMAP_HELVETICA_12);
+    if (profiler.isOverlayVisible()) {
+        drawProfilerOverlay();
+    }
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    if (lightOn) glEnable(GL_LIGHTING);
+    if (fogEnabled) glEnable(GL_FOG);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+}
+
+// Called from drawUI with the pixel-space projection already set up
+void Renderer::drawProfilerOverlay() {
+    TRACE_SCOPE("Renderer::drawProfilerOverlay");
+    const float left = windowWidth - 360.0f;
+    float y = windowHeight - 30.0f;
+    char line[128];
+
+    glColor3f(0.9f, 0.9f, 0.5f);
+    renderText(left, y, profiler.hasGpuTimers() ? "Pass         CPU avg / p99 ms   GPU avg / p99 ms"
+                                                : "Pass         CPU avg / p99 ms   (no GPU timers)",
+               GLUT_BITMAP_HELVETICA_12);
+    for (int index = 0; index < FrameProfiler::PASS_COUNT; ++index) {
+        const FramePass pass = static_cast<FramePass>(index);
+        const FrameProfiler::PassStats s = profiler.getStats(pass);
+        std::snprintf(line, sizeof(line), "%-12s %6.2f / %6.2f      %6.2f / %6.2f", FrameProfiler::getPassName(pass),
+                      s.cpuAvg, s.cpuP99, s.gpuAvg, s.gpuP99);
+        y -= 16.0f;
+        renderText(left, y, line, GLUT_BITMAP_HELVETICA_12);
+    }
+}
+
+// Additional draw functions should be refactored similarly with helpers and cleanups
+// For brevity, they are not all included here but follow the same cleanup strategy.
+
+// ... Other drawing and utility methods
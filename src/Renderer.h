@@ -1,71 +1,164 @@
-// Renderer.h (Refactored)
-#pragma once
-
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-#include <vector>
-#include <string>
-
-// Forward declarations
-class TextureManager;
-class Camera;
-class Maze;
-class Ghost;
-
-class Renderer {
-public:
-    explicit Renderer(TextureManager& texManager);
-    ~Renderer();
-
-    bool initialize();
-    void reshape(int width, int height);
-    void beginFrame(const Camera& camera);
-    void endFrame();
-
-    void drawRoom();
-    void drawMaze(const Maze& maze);
-    void drawFurniture(float x, float y, float z);
-    void drawGhost(const Ghost& ghost);
-    void drawDecorations();
-    void drawUI(bool gameWon, bool hasKey);
-
-    void setLight(bool on, float intensity);
-
-private:
-    TextureManager& textureManager;
-    int windowWidth;
-    int windowHeight;
-    bool lightOn;
-    float lightIntensity;
-    bool fogEnabled;
-
-    struct Bloodstain {
-        float x, y, z;
-        float size;
-        float angle;
-        int wallIndex;
-    };
-
-    std::vector<Bloodstain> bloodstains;
-
-    void initializeBloodstains();
-    void drawBloodstains();
-
-    void drawWall(float x1, float y1, float z1,
-                  float x2, float y2, float z2,
-                  const std::string& textureName,
-                  float texScaleX = 1.0f, float texScaleY = 1.0f);
-
-    void drawFloor();
-    void drawCeiling();
-    void drawDoor(float x, float z, int orientation);
-    void drawMannequin(float x, float y, float z, float rotation);
-    void drawTable(float x, float y, float z);
-    void drawChair(float x, float y, float z);
-    void drawMirror(float x, float y, float z);
-
-    void renderText(float x, float y, const std::string& text, void* font = GLUT_BITMAP_HELVETICA_18);
-
-    void setupLighting();
-    void setupFog();
+// Renderer.h (Refactored)
+#pragma once
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "TextureManager.h"
+#include "MazeMesh.h"
+#include "Frustum.h"
+#include "MazeCuller.h"
+#include "ShaderProgram.h"
+#include "PropRenderer.h"
+#include "SceneUniforms.h"
+#include "FrameProfiler.h"
+
+// Forward declarations
+class Camera;
+class Maze;
+class Ghost;
+class GhostSystem;
+class MazePVS;
+
+class Renderer {
+public:
+    explicit Renderer(TextureManager& texManager);
+    ~Renderer();
+
+    bool initialize();
+    void reshape(int width, int height);
+    void beginFrame(const Camera& camera);
+    void endFrame();
+
+    // Culling stage: find the maze cells in view for this frame. Call after beginFrame and
+    // before drawMaze/drawFurniture/drawDecorations, which only emit geometry for those cells.
+    void cullScene(const Maze& maze);
+
+    // Use a precomputed potentially visible set to reject hidden cells during culling (nullptr disables)
+    void setVisibilitySet(const MazePVS* pvs) { visibilitySet = pvs; }
+
+    // Distance beyond which the fog hides everything
+    float getCullDistance() const;
+
+    void drawRoom();
+
+    // Rebuild the retained maze geometry now rather than in the next drawMaze, which rebuilds
+    // it whenever the maze's version differs from the one it was built from
+    void buildMazeMesh(const Maze& maze);
+    void drawMaze(const Maze& maze);
+    void drawFurniture();
+
+    // Furniture placement; props are kept until clearProps() and drawn by drawFurniture()
+    void clearProps() { props.clear(); }
+    void addProp(PropType type, float x, float z, float yaw) { props.add(type, x, z, yaw); }
+    // Ghosts are drawn where they were alpha of the way between their last two simulation steps
+    void drawGhost(const Ghost& ghost, float alpha);
+    void drawGhostSwarm(const GhostSystem& swarm, float alpha);
+    // Unlit yellow cube marking the key lying at (x, z)
+    void drawKey(float x, float z);
+    // Bloodstain decals on the walls of the visible cells
+    void drawDecorations();
+    void drawUI(bool gameWon, bool hasKey);
+
+    void setLight(bool on, float intensity);
+
+    // Per-frame counts of what the culling stage kept and rejected, shown in the HUD
+    struct CullStats {
+        int cellsTested;
+        int cellsOccluded;
+        int cellsVisible;
+        int chunksSubmitted;
+        int chunksCulled;
+        int propsSubmitted;
+        int propsCulled;
+        int decalsSubmitted;
+        int decalsCulled;
+        unsigned long textureBinds;        // Binds that reached GL this frame
+        unsigned long textureBindsAvoided; // Redundant binds skipped by TextureManager
+    };
+
+    const CullStats& getCullStats() const { return cullStats; }
+
+    // Per-pass CPU/GPU timings; frames are bracketed by beginFrame/endFrame, passes by the caller
+    FrameProfiler& getProfiler() { return profiler; }
+
+private:
+    TextureManager& textureManager;
+    int windowWidth;
+    int windowHeight;
+    bool lightOn;
+    float lightIntensity;
+    bool fogEnabled;
+
+    // Projection parameters set in reshape(), reused to build the culling frustum
+    float fieldOfView;
+    float nearPlane;
+    float farPlane;
+
+    struct Bloodstain {
+        float x, y, z;
+        float size;
+        float angle;
+        int wallIndex;
+    };
+
+    std::vector<Bloodstain> bloodstains;
+
+    // Static walls/floor/ceiling geometry and the Maze::getVersion() it was built from
+    MazeMesh mazeMesh;
+    std::uint64_t mazeMeshVersion;
+
+    // Single-bind path: maze textures packed in one array, sampled by a small shader.
+    // Falls back to per-texture binds when arrays or shaders are unavailable.
+    ShaderProgram mazeArrayShader;
+    TextureHandle sceneArrayTexture;
+    bool sceneArrayReady;
+
+    // Camera, light and fog for the scene shaders, uploaded once per frame
+    SceneUniforms sceneUniforms;
+
+    // Fixed-function light colours are out of date with lightIntensity
+    bool legacyLightDirty;
+    void applyLegacyLight();
+
+    // Baked furniture meshes and their placed instances
+    PropRenderer props;
+
+    // Texture handles resolved once after loading
+    TextureHandle bloodTexture;
+    void initializeSceneArray();
+
+    FrameProfiler profiler;
+    void drawProfilerOverlay();
+
+    // Culling state for the current frame
+    Frustum frustum;
+    MazeCuller culler;
+    CullStats cullStats;
+    const MazePVS* visibilitySet;
+    float eyeX, eyeZ;
+    bool sceneCulled;                   // cullScene() ran since the last beginFrame()
+    std::vector<unsigned char> chunkVisible;
+    std::vector<GLint> drawFirsts;      // Scratch arrays for glMultiDrawArrays, reused every frame
+    std::vector<GLsizei> drawCounts;
+
+    // Scatters the bloodstain decals over the walls of maze; rerun whenever the maze mesh is rebuilt
+    void initializeBloodstains(const Maze& maze);
+    void drawBloodstains();
+
+    void drawFloor();
+    void drawCeiling();
+    void drawDoor(float x, float z, int orientation);
+
+    // Translucent ghost shape standing at (x, z); state is set up by the ghost passes
+    void drawGhostFigure(float x, float z);
+    void beginGhostPass();
+    void endGhostPass();
+
+    void renderText(float x, float y, const std::string& text, void* font = GLUT_BITMAP_HELVETICA_18);
+
+    void setupLighting();
+    void setupFog();
 };
\ No newline at end of file
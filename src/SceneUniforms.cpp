@@ -0,0 +1,61 @@
+#include "SceneUniforms.h"
+#include "ShaderProgram.h"
+#include <cstddef>
+
+static_assert(sizeof(SceneUniforms::Block) == 272, "SceneUniforms::Block must match the std140 SceneBlock");
+static_assert(offsetof(SceneUniforms::Block, lightIntensity) == 256, "SceneBlock scalars start at offset 256");
+
+SceneUniforms::SceneUniforms() : buffer(0), block() {}
+
+SceneUniforms::~SceneUniforms() {
+    release();
+}
+
+bool SceneUniforms::isSupported() {
+    return GLEW_VERSION_3_1 || GLEW_ARB_uniform_buffer_object;
+}
+
+bool SceneUniforms::initialize() {
+    release();
+    if (!isSupported()) {
+        return false;
+    }
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &block, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, buffer);
+    return true;
+}
+
+void SceneUniforms::release() {
+    if (buffer != 0) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+bool SceneUniforms::attach(const ShaderProgram& program) const {
+    const GLuint index = glGetUniformBlockIndex(program.getProgram(), "SceneBlock");
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+    glUniformBlockBinding(program.getProgram(), index, BINDING_POINT);
+    return true;
+}
+
+void SceneUniforms::upload() {
+    if (buffer == 0) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SceneUniforms::setLightIntensity(float intensity) {
+    block.lightIntensity = intensity;
+    if (buffer == 0) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, lightIntensity), sizeof(float), &block.lightIntensity);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <GL/glew.h>
+
+class ShaderProgram; // Forward declaration
+
+// Per-frame camera, light and fog state shared by every scene shader through one
+// uniform buffer (the SceneBlock uniform block). Filled and uploaded once per frame;
+// the light flicker only rewrites the intensity field.
+class SceneUniforms {
+public:
+    // CPU copy of the std140 SceneBlock; every member starts on a 16-byte boundary
+    // except the trailing scalars, which share the last vec4 slot
+    struct Block {
+        float view[16];          // World -> eye
+        float projection[16];
+        float cameraPosition[4]; // World space
+        float lightPosition[4];  // World space point light
+        float lightAmbient[4];   // Light colours at full intensity
+        float lightDiffuse[4];
+        float lightSpecular[4];
+        float globalAmbient[4];
+        float attenuation[4];    // Constant, linear, quadratic
+        float fogColor[4];       // rgb, a = GL_EXP2 density
+        float lightIntensity;    // Scales the light colours (flicker)
+        int lightingEnabled;
+        int fogEnabled;
+        int padding;
+    };
+
+    // Uniform buffer binding point every scene shader's SceneBlock is attached to
+    static const GLuint BINDING_POINT = 0;
+
+    SceneUniforms();
+    ~SceneUniforms();
+
+    SceneUniforms(const SceneUniforms&) = delete;
+    SceneUniforms& operator=(const SceneUniforms&) = delete;
+
+    // True if the driver has uniform buffer objects (GL 3.1 or ARB_uniform_buffer_object)
+    static bool isSupported();
+
+    // Create the buffer and bind it to BINDING_POINT; returns false if unsupported
+    bool initialize();
+    void release();
+    bool isReady() const { return buffer != 0; }
+
+    // Attach a program's SceneBlock to BINDING_POINT; returns false if it has none
+    bool attach(const ShaderProgram& program) const;
+
+    Block& data() { return block; }
+    const Block& data() const { return block; }
+
+    // Upload the whole block; call once per frame after filling data()
+    void upload();
+
+    // Rewrite only the light intensity
+    void setLightIntensity(float intensity);
+
+private:
+    GLuint buffer;
+    Block block;
+};
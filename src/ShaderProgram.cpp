@@ -0,0 +1,80 @@
+#include "ShaderProgram.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+ShaderProgram::ShaderProgram() : program(0) {}
+
+ShaderProgram::~ShaderProgram() {
+    release();
+}
+
+void ShaderProgram::release() {
+    if (program != 0) {
+        glDeleteProgram(program);
+        program = 0;
+    }
+}
+
+GLuint ShaderProgram::compile(GLenum type, const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Shader file not found: " + path);
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+    const std::string text = source.str();
+    const char* textPtr = text.c_str();
+
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &textPtr, nullptr);
+    glCompileShader(shader);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(logLength > 1 ? logLength : 1, '\0');
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        glDeleteShader(shader);
+        throw std::runtime_error("Failed to compile shader " + path + ":\n" + log.data());
+    }
+    return shader;
+}
+
+void ShaderProgram::loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
+    release();
+
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexPath);
+    GLuint fragmentShader = 0;
+    try {
+        fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentPath);
+    } catch (...) {
+        glDeleteShader(vertexShader);
+        throw;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);   // Flagged for deletion, freed with the program
+    glDeleteShader(fragmentShader);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        GLint logLength = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> log(logLength > 1 ? logLength : 1, '\0');
+        glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        release();
+        throw std::runtime_error("Failed to link " + vertexPath + " + " + fragmentPath + ":\n" + log.data());
+    }
+
+    std::cout << "[ShaderProgram] Linked " << vertexPath << " + " << fragmentPath
+              << " (ID: " << program << ")" << std::endl;
+}
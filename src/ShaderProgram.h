@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+
+// Owns one linked GLSL program built from a vertex and a fragment shader file
+class ShaderProgram {
+public:
+    ShaderProgram();
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // Compiles and links the two shader files
+    // Throws std::runtime_error with the GLSL info log if a file is missing or fails to build
+    void loadFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // Deletes the GL program
+    void release();
+
+    void use() const { glUseProgram(program); }
+    static void unbind() { glUseProgram(0); }
+
+    bool isLoaded() const { return program != 0; }
+    GLuint getProgram() const { return program; }
+
+    // Uniform location by name (-1 if the uniform is missing or optimised out)
+    GLint getUniform(const char* name) const { return glGetUniformLocation(program, name); }
+
+private:
+    GLuint program;
+
+    static GLuint compile(GLenum type, const std::string& path);
+};
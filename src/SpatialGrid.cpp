@@ -0,0 +1,74 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(int bucketShift)
+    : bucketShift(std::max(0, std::min(bucketShift, 16))), bucketsX(0), bucketsY(0), freeList(-1), count(0) {
+    reset(1, 1);
+}
+
+void SpatialGrid::reset(int widthCells, int heightCells) {
+    const int bucketSide = 1 << bucketShift;
+    bucketsX = std::max(1, (widthCells + bucketSide - 1) / bucketSide);
+    bucketsY = std::max(1, (heightCells + bucketSide - 1) / bucketSide);
+    heads.assign(static_cast<size_t>(bucketsX) * bucketsY, -1);
+    entities.clear();
+    freeList = -1;
+    count = 0;
+}
+
+int SpatialGrid::insert(float x, float z, std::uint32_t tag) {
+    int id;
+    if (freeList >= 0) {
+        id = freeList;
+        freeList = entities[id].next;
+    } else {
+        id = static_cast<int>(entities.size());
+        entities.push_back(Entity{ 0.0f, 0.0f, 0, -1, -1, -1 });
+    }
+    Entity& entity = entities[id];
+    entity.x = x;
+    entity.z = z;
+    entity.tag = tag;
+    link(id, bucketOf(x, z));
+    ++count;
+    return id;
+}
+
+void SpatialGrid::move(int id, float x, float z) {
+    Entity& entity = entities[id];
+    entity.x = x;
+    entity.z = z;
+    const int bucket = bucketOf(x, z);
+    if (bucket != entity.bucket) {
+        unlink(id);
+        link(id, bucket);
+    }
+}
+
+void SpatialGrid::remove(int id) {
+    if (!contains(id)) return;
+    unlink(id);
+    entities[id].bucket = -1;
+    entities[id].next = freeList;
+    freeList = id;
+    --count;
+}
+
+void SpatialGrid::link(int id, int bucket) {
+    Entity& entity = entities[id];
+    entity.bucket = bucket;
+    entity.prev = -1;
+    entity.next = heads[bucket];
+    if (entity.next >= 0) entities[entity.next].prev = id;
+    heads[bucket] = id;
+}
+
+void SpatialGrid::unlink(int id) {
+    const Entity& entity = entities[id];
+    if (entity.prev >= 0) {
+        entities[entity.prev].next = entity.next;
+    } else {
+        heads[entity.bucket] = entity.next;
+    }
+    if (entity.next >= 0) entities[entity.next].prev = entity.prev;
+}
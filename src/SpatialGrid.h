@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Config.h" // For SPATIAL_GRID_BUCKET_SHIFT
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid of entity points (keys, triggers, ghosts) over the maze's cell grid, for
+// "what is near here" queries. Buckets are square blocks of maze cells, 1 << bucketShift on a
+// side, and each holds an intrusive doubly linked list threaded through the entity table, so
+// moving an entity only relinks it when it crosses into another bucket and nothing allocates
+// after the tables have grown. Queries visit the buckets overlapping the query area, which
+// costs O(nearby entities) rather than O(all entities).
+class SpatialGrid {
+public:
+    explicit SpatialGrid(int bucketShift = SPATIAL_GRID_BUCKET_SHIFT);
+
+    // Cover a maze of widthCells x heightCells cells and drop every entity. Points outside
+    // the maze are kept in the edge buckets, so they are still found.
+    void reset(int widthCells, int heightCells);
+
+    // Register a point at world (x, z) with a caller-defined tag. Returns its id.
+    int insert(float x, float z, std::uint32_t tag);
+    void move(int id, float x, float z);
+    void remove(int id);
+
+    bool contains(int id) const { return id >= 0 && id < static_cast<int>(entities.size()) && entities[id].bucket >= 0; }
+    float getX(int id) const { return entities[id].x; }
+    float getZ(int id) const { return entities[id].z; }
+    std::uint32_t getTag(int id) const { return entities[id].tag; }
+    int getCount() const { return count; }
+
+    // Call visit(id) for every entity within radius of (x, z). visit must not insert, move or
+    // remove entities; collect ids and act after the query instead.
+    template <typename Fn>
+    void forEachInRadius(float x, float z, float radius, Fn&& visit) const {
+        const float radiusSquared = radius * radius;
+        forEachInBuckets(bucketColumn(x - radius), bucketRow(z - radius), bucketColumn(x + radius), bucketRow(z + radius),
+                         [&](int id) {
+                             const float dx = entities[id].x - x, dz = entities[id].z - z;
+                             if (dx * dx + dz * dz <= radiusSquared) visit(id);
+                         });
+    }
+
+    // Call visit(id) for every entity whose maze cell is at most cellRadius rows and columns
+    // from (row, col). Same rule for visit as forEachInRadius.
+    template <typename Fn>
+    void forEachInCells(int row, int col, int cellRadius, Fn&& visit) const {
+        forEachInBuckets(clampColumn((col - cellRadius) >> bucketShift), clampRow((row - cellRadius) >> bucketShift),
+                         clampColumn((col + cellRadius) >> bucketShift), clampRow((row + cellRadius) >> bucketShift),
+                         [&](int id) {
+                             const int entityRow = cellOf(entities[id].z), entityCol = cellOf(entities[id].x);
+                             if (entityRow >= row - cellRadius && entityRow <= row + cellRadius &&
+                                 entityCol >= col - cellRadius && entityCol <= col + cellRadius) {
+                                 visit(id);
+                             }
+                         });
+    }
+
+private:
+    struct Entity {
+        float x, z;
+        std::uint32_t tag;
+        int bucket; // -1 while the slot is free
+        int next;   // Next in the bucket list, or in the free list while free
+        int prev;
+    };
+
+    int bucketShift;
+    int bucketsX, bucketsY;
+    std::vector<int> heads;      // First entity of each bucket, -1 if empty
+    std::vector<Entity> entities;
+    int freeList;
+    int count;
+
+    static int cellOf(float coordinate) { return static_cast<int>(std::floor(coordinate)); }
+    int clampColumn(int bucketX) const { return bucketX < 0 ? 0 : (bucketX >= bucketsX ? bucketsX - 1 : bucketX); }
+    int clampRow(int bucketY) const { return bucketY < 0 ? 0 : (bucketY >= bucketsY ? bucketsY - 1 : bucketY); }
+    int bucketColumn(float x) const { return clampColumn(cellOf(x) >> bucketShift); }
+    int bucketRow(float z) const { return clampRow(cellOf(z) >> bucketShift); }
+    int bucketOf(float x, float z) const { return bucketRow(z) * bucketsX + bucketColumn(x); }
+
+    void link(int id, int bucket);
+    void unlink(int id);
+
+    template <typename Fn>
+    void forEachInBuckets(int x0, int y0, int x1, int y1, Fn&& visit) const {
+        for (int by = y0; by <= y1; ++by) {
+            for (int bx = x0; bx <= x1; ++bx) {
+                for (int id = heads[by * bucketsX + bx]; id >= 0; id = entities[id].next) {
+                    visit(id);
+                }
+            }
+        }
+    }
+};
@@ -1,65 +1,839 @@
-#include "TextureManager.h"
-#include "Config.h"
-#include <SOIL/SOIL.h>
-#include <iostream>
-#include <stdexcept>
-
-TextureManager::TextureManager() {}
-
-TextureManager::~TextureManager() {
-    releaseAllTextures();
-}
-
-GLuint TextureManager::loadTexture(const std::string& name, const std::string& filename) {
-    GLuint textureID = SOIL_load_OGL_texture(
-        filename.c_str(),
-        SOIL_LOAD_AUTO,
-        SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-    );
-
-    if (textureID == 0) {
-        std::cerr << "[TextureManager] Failed to load texture '" << name
-                  << "' from file: " << filename << "\nSOIL Error: " << SOIL_last_result() << std::endl;
-        throw std::runtime_error("Failed to load texture: " + filename);
-    }
-
-    textures[name] = textureID;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    std::cout << "[TextureManager] Loaded texture '" << name << "' (ID: " << textureID << ") from " << filename << std::endl;
-    return textureID;
-}
-
-GLuint TextureManager::getTexture(const std::string& name) const {
-    auto it = textures.find(name);
-    if (it == textures.end()) {
-        std::cerr << "[TextureManager] Texture '" << name << "' not found." << std::endl;
-        throw std::out_of_range("Texture not found: " + name);
-    }
-    return it->second;
-}
-
-void TextureManager::bindTexture(const std::string& name, GLenum textureUnit) const {
-    try {
-        glActiveTexture(textureUnit);
-        glBindTexture(GL_TEXTURE_2D, getTexture(name));
-    } catch (const std::out_of_range&) {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        std::cerr << "[TextureManager] Warning: Attempted to bind missing texture '" << name << "'. Bound default instead.\n";
-    }
-}
-
-void TextureManager::releaseAllTextures() {
-    for (const auto& [name, id] : textures) {
-        glDeleteTextures(1, &id);
-    }
-    textures.clear();
-    std::cout << "[TextureManager] Released all textures." << std::endl;
-}
+#include "TextureManager.h"
+#include "Config.h"
+#include "Trace.h"
+#include <SOIL/SOIL.h>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+// stb_image keeps no global state apart from a thread-local failure reason, so the decoder
+// threads call it without a lock. STB_IMAGE_STATIC keeps its symbols from clashing with the
+// copy of stb_image built into SOIL.
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#include <stb_image.h>
+
+namespace {
+    // Textures loaded by loadAll()/beginLoadAll() and baked by bakeTextureCache()
+    const std::pair<const char*, const char*> TEXTURE_MANIFEST[] = {
+        { "wall", TEX_WALL },
+        { "floor", TEX_FLOOR },
+        { "ceiling", TEX_CEILING },
+        { "brick", TEX_BRICK },
+        { "stone", TEX_STONE },
+        { "door", TEX_DOOR },
+        { "blood", TEX_BLOOD },
+        { "mirror", TEX_MIRROR },
+        { "table", TEX_TABLE },
+        { "chair", TEX_CHAIR },
+        { "mannequin_skin", TEX_MANNEQUIN_SKIN },
+        { "mannequin_cloth", TEX_MANNEQUIN_CLOTH },
+        { "mannequin_eye", TEX_MANNEQUIN_EYE },
+    };
+
+    // Texture cache file layout (native little-endian):
+    //   TextureCacheHeader, TextureCacheLevel[mipCount], then the compressed level data
+    const char TEXTURE_CACHE_MAGIC[4] = { 'A', 'H', 'T', 'X' };
+    const std::uint32_t TEXTURE_CACHE_VERSION = 1;
+    const std::uint32_t TEXTURE_CACHE_MAX_DIMENSION = 16384; // Larger than any GL_MAX_TEXTURE_SIZE we target
+
+    struct TextureCacheHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t sourceHash; // FNV-1a of the source image file
+        std::uint32_t internalFormat;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t mipCount;
+    };
+
+    struct TextureCacheLevel {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint64_t offset; // From the start of the file
+        std::uint64_t size;
+    };
+
+    static_assert(sizeof(TextureCacheHeader) == 32, "TextureCacheHeader must stay packed");
+    static_assert(sizeof(TextureCacheLevel) == 24, "TextureCacheLevel must stay packed");
+
+    std::uint64_t hashBytes(const unsigned char* data, size_t size) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Dim checker of 4-pixel squares (larger for big images), dark enough to pass for shadow in the fog
+    void fillFallbackPixels(unsigned char* pixels, int width, int height) {
+        const int square = std::max(4, width / 8);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const unsigned char shade = ((x / square + y / square) & 1) ? 48 : 32;
+                unsigned char* p = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                p[0] = p[1] = p[2] = shade;
+                p[3] = 255;
+            }
+        }
+    }
+
+    // The same checker as DXT5 blocks, one flat 4x4 block per shade; exact whenever the
+    // squares are a multiple of 4 pixels, as they are for every size we pack
+    void fillFallbackBlocks(unsigned char* blocks, int width, int height) {
+        const int square = std::max(4, width / 8);
+        const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                const unsigned shade = ((bx * 4 / square + by * 4 / square) & 1) ? 48 : 32;
+                const unsigned rgb565 = ((shade >> 3) << 11) | ((shade >> 2) << 5) | (shade >> 3);
+                unsigned char* b = blocks + (static_cast<size_t>(by) * blocksX + bx) * 16;
+                std::memset(b, 0, 16); // Every index selects the first endpoint
+                b[0] = b[1] = 255;     // Alpha endpoints
+                b[8] = b[10] = static_cast<unsigned char>(rgb565 & 0xff);
+                b[9] = b[11] = static_cast<unsigned char>(rgb565 >> 8);
+            }
+        }
+    }
+}
+
+TextureManager::TextureManager()
+    : fallbackLayer(-1), activeUnit(0), bindsIssued(0), bindsAvoided(0), fallbackTexture(0),
+      nextToDecode(0), cancelLoading(false), uploadsRemaining(0), uploadBuffer(0) {
+    slots.push_back({ 0, GL_TEXTURE_2D }); // INVALID_TEXTURE_HANDLE
+    invalidateBindingCache();
+}
+
+TextureHandle TextureManager::registerTexture(const std::string& name, GLuint id, GLenum target) {
+    const TextureHandle existing = handles.find(name);
+    if (existing != INVALID_TEXTURE_HANDLE) {
+        TextureSlot& slot = slots[existing];
+        if (slot.id != 0 && slot.id != id && slot.id != fallbackTexture) {
+            glDeleteTextures(1, &slot.id);
+        }
+        slot = { id, target };
+        return existing;
+    }
+
+    const TextureHandle handle = static_cast<TextureHandle>(slots.size());
+    slots.push_back({ id, target });
+    handles.add(name, handle);
+    return handle;
+}
+
+TextureManager::~TextureManager() {
+    releaseAllTextures();
+}
+
+GLuint TextureManager::loadTexture(const std::string& name, const std::string& filename) {
+    TRACE_SCOPE("TextureManager::loadTexture");
+    GLuint textureID = SOIL_load_OGL_texture(
+        filename.c_str(),
+        SOIL_LOAD_AUTO,
+        SOIL_CREATE_NEW_ID,
+        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
+    );
+
+    if (textureID == 0) {
+        std::cerr << "[TextureManager] Failed to load texture '" << name
+                  << "' from file: " << filename << "\nSOIL Error: " << SOIL_last_result() << std::endl;
+        throw std::runtime_error("Failed to load texture: " + filename);
+    }
+
+    registerTexture(name, textureID, GL_TEXTURE_2D);
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    invalidateBindingCache(); // SOIL and the calls above changed the binding behind our back
+
+    std::cout << "[TextureManager] Loaded texture '" << name << "' (ID: " << textureID << ") from " << filename << std::endl;
+    return textureID;
+}
+
+void TextureManager::loadAll() {
+    TRACE_SCOPE("TextureManager::loadAll");
+    beginLoadAll();
+    finishLoading();
+}
+
+void TextureManager::beginLoadAll(unsigned threadCount) {
+    TRACE_SCOPE("TextureManager::beginLoadAll");
+    stopLoaderThreads();
+    if (fallbackTexture == 0) {
+        createFallbackTexture();
+    }
+    if (uploadBuffer == 0 && (GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)) {
+        glGenBuffers(1, &uploadBuffer);
+    }
+
+    loadQueue.clear();
+    failedFiles.clear();
+    for (const auto& [name, filename] : TEXTURE_MANIFEST) {
+        const TextureHandle handle = registerTexture(name, fallbackTexture, GL_TEXTURE_2D);
+        loadQueue.push_back({ handle, name, filename, nullptr, 0, 0 });
+    }
+    uploadsRemaining = loadQueue.size();
+    nextToDecode = 0;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, loadQueue.size()));
+
+    loadStartTime = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threadCount; ++t) {
+        loaderThreads.emplace_back([this, t]() {
+            TRACE_THREAD_NAME("Texture decoder " + std::to_string(t));
+            while (!cancelLoading) {
+                const size_t index = nextToDecode.fetch_add(1);
+                if (index >= loadQueue.size()) break;
+                DecodedImage image = loadQueue[index];
+                if (!openCachedImage(image)) {
+                    decodeImage(image);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(loaderMutex);
+                    decodedImages.push_back(image);
+                }
+                decodedReady.notify_one();
+            }
+        });
+    }
+    std::cout << "[TextureManager] Decoding " << loadQueue.size() << " textures on "
+              << threadCount << " threads" << std::endl;
+}
+
+bool TextureManager::pumpUploads(double budgetMs) {
+    TRACE_SCOPE("TextureManager::pumpUploads");
+    const auto start = std::chrono::steady_clock::now();
+    while (uploadsRemaining > 0) {
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(loaderMutex);
+            if (decodedImages.empty()) break;
+            image = decodedImages.front();
+            decodedImages.pop_front();
+        }
+        uploadDecoded(image);
+        if (!takeArrayLayer(image) && image.pixels) {
+            stbi_image_free(image.pixels);
+        }
+        --uploadsRemaining;
+
+        const double spentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (spentMs >= budgetMs) break;
+    }
+
+    if (uploadsRemaining > 0) {
+        return false;
+    }
+
+    if (!loaderThreads.empty()) {
+        // Every image has been handed over, so the decoders have already left their loop
+        for (std::thread& thread : loaderThreads) {
+            thread.join();
+        }
+        loaderThreads.clear();
+        if (uploadBuffer != 0) {
+            glDeleteBuffers(1, &uploadBuffer);
+            uploadBuffer = 0;
+        }
+        const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count();
+        std::cout << "[TextureManager] Streamed " << loadQueue.size() << " textures in " << totalMs << " ms"
+                  << (failedFiles.empty() ? "" : " (some failed: " + failedFiles + ")") << std::endl;
+    }
+    return true;
+}
+
+void TextureManager::finishLoading() {
+    TRACE_SCOPE("TextureManager::finishLoading");
+    while (uploadsRemaining > 0) {
+        {
+            std::unique_lock<std::mutex> lock(loaderMutex);
+            decodedReady.wait(lock, [this]() { return !decodedImages.empty(); });
+        }
+        pumpUploads(1e9);
+    }
+    pumpUploads(0.0); // Joins the decoders if the last upload happened elsewhere
+
+    if (!failedFiles.empty()) {
+        throw std::runtime_error("Failed to load textures: " + failedFiles);
+    }
+}
+
+// Runs on the decoder threads, any number at once
+void TextureManager::decodeImage(DecodedImage& image) {
+    TRACE_SCOPE("TextureManager::decodeImage");
+    int channels = 0;
+    image.pixels = stbi_load(image.filename.c_str(), &image.width, &image.height, &channels, STBI_rgb_alpha);
+    if (!image.pixels) {
+        image.error = stbi_failure_reason();
+        return;
+    }
+
+    // Flip rows to match SOIL_FLAG_INVERT_Y
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    std::vector<unsigned char> rowTemp(rowBytes);
+    for (int y = 0; y < image.height / 2; ++y) {
+        unsigned char* top = image.pixels + y * rowBytes;
+        unsigned char* bottom = image.pixels + (image.height - 1 - y) * rowBytes;
+        std::copy(top, top + rowBytes, rowTemp.begin());
+        std::copy(bottom, bottom + rowBytes, top);
+        std::copy(rowTemp.begin(), rowTemp.end(), bottom);
+    }
+
+    // Same range compression as SOIL_FLAG_NTSC_SAFE_RGB: colour channels into [16, 235]
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        unsigned char* p = image.pixels + i * 4;
+        for (int c = 0; c < 3; ++c) {
+            p[c] = static_cast<unsigned char>(16 + p[c] * 219 / 255);
+        }
+    }
+}
+
+// GL thread only. The pixels go through a pixel buffer object when available so the
+// driver can copy them to the GPU asynchronously, and mipmaps are generated on the GPU.
+void TextureManager::uploadDecoded(const DecodedImage& image) {
+    TRACE_SCOPE("TextureManager::uploadDecoded");
+    if (image.cache) {
+        const GLuint textureID = uploadCached(image);
+        registerTexture(image.name, textureID, GL_TEXTURE_2D);
+        std::cout << "[TextureManager] Loaded texture '" << image.name << "' (ID: " << textureID << ") from "
+                  << image.filename << TEXTURE_CACHE_EXTENSION << std::endl;
+        return;
+    }
+
+    if (!image.pixels) {
+        std::cerr << "[TextureManager] Failed to load texture '" << image.name
+                  << "' from file: " << image.filename << "\nDecoder error: " << image.error << std::endl;
+        failedFiles += failedFiles.empty() ? image.filename : ", " + image.filename;
+        return; // The handle keeps showing the fallback texture
+    }
+
+    // Uncompressed on purpose: asking for an S3TC internal format here would make the driver
+    // compress every level on this thread. Compressed textures come from the baked cache
+    // (--bake-textures), which uploadCached() hands over as ready-made blocks.
+    const GLenum internalFormat = GL_RGBA8;
+    const bool gpuMipmaps = GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object;
+    const size_t bytes = static_cast<size_t>(image.width) * image.height * 4;
+
+    GLuint textureID = 0;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    if (!gpuMipmaps) {
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+    }
+
+    const void* source = image.pixels;
+    if (uploadBuffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+        // Orphan the previous upload's storage instead of waiting for it
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+        if (void* mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY)) {
+            std::memcpy(mapped, image.pixels, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            source = nullptr; // Offset 0 into the bound buffer
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, source);
+    if (source == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (gpuMipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    invalidateBindingCache();
+
+    registerTexture(image.name, textureID, GL_TEXTURE_2D);
+    std::cout << "[TextureManager] Loaded texture '" << image.name << "' (ID: " << textureID << ") from "
+              << image.filename << std::endl;
+}
+
+// Runs on the decoder threads. Accepts the cache only if it is complete, in a format this
+// driver can upload, and was baked from the current contents of the source file.
+bool TextureManager::openCachedImage(DecodedImage& image) {
+    TRACE_SCOPE("TextureManager::openCachedImage");
+    auto cache = std::make_shared<MappedFile>();
+    if (!cache->open(image.filename + TEXTURE_CACHE_EXTENSION) || cache->size() < sizeof(TextureCacheHeader)) {
+        return false;
+    }
+
+    TextureCacheHeader header;
+    std::memcpy(&header, cache->data(), sizeof(header));
+    if (std::memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TEXTURE_CACHE_VERSION ||
+        header.internalFormat != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT || !GLEW_EXT_texture_compression_s3tc ||
+        header.width == 0 || header.height == 0 ||
+        header.width > TEXTURE_CACHE_MAX_DIMENSION || header.height > TEXTURE_CACHE_MAX_DIMENSION) {
+        return false;
+    }
+    std::uint32_t fullChain = 1;
+    while ((std::max(header.width, header.height) >> fullChain) > 0) {
+        ++fullChain;
+    }
+    if (header.mipCount == 0 || header.mipCount > fullChain) {
+        return false;
+    }
+
+    // Every level must have the size bake() gives it and lie inside the mapping, so the
+    // upload never reads past the file or hands GL a size that does not match its dimensions
+    const size_t tableEnd = sizeof(TextureCacheHeader) + header.mipCount * sizeof(TextureCacheLevel);
+    if (cache->size() < tableEnd) {
+        return false;
+    }
+    for (std::uint32_t level = 0; level < header.mipCount; ++level) {
+        TextureCacheLevel entry;
+        std::memcpy(&entry, cache->data() + sizeof(TextureCacheHeader) + level * sizeof(TextureCacheLevel), sizeof(entry));
+        const std::uint32_t levelWidth = std::max(1u, header.width >> level);
+        const std::uint32_t levelHeight = std::max(1u, header.height >> level);
+        const std::uint64_t dxt5Bytes = std::uint64_t((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * 16;
+        if (entry.width != levelWidth || entry.height != levelHeight || entry.size != dxt5Bytes ||
+            entry.offset < tableEnd || entry.offset > cache->size() || entry.size > cache->size() - entry.offset) {
+            return false;
+        }
+    }
+
+    MappedFile source;
+    if (!source.open(image.filename) || hashBytes(source.data(), source.size()) != header.sourceHash) {
+        return false; // Source image changed (or vanished) since the bake
+    }
+
+    image.width = static_cast<int>(header.width);
+    image.height = static_cast<int>(header.height);
+    image.cache = cache;
+    return true;
+}
+
+// GL thread only. Uploads every level straight from the mapping; no decode, no mip generation
+GLuint TextureManager::uploadCached(const DecodedImage& image) {
+    const unsigned char* base = image.cache->data();
+    TextureCacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    GLuint textureID = 0;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    for (std::uint32_t level = 0; level < header.mipCount; ++level) {
+        TextureCacheLevel entry;
+        std::memcpy(&entry, base + sizeof(TextureCacheHeader) + level * sizeof(TextureCacheLevel), sizeof(entry));
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), header.internalFormat,
+                               static_cast<GLsizei>(entry.width), static_cast<GLsizei>(entry.height), 0,
+                               static_cast<GLsizei>(entry.size), base + entry.offset);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(header.mipCount - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    invalidateBindingCache();
+    return textureID;
+}
+
+int TextureManager::bakeTextureCache() {
+    TRACE_SCOPE("TextureManager::bakeTextureCache");
+    if (!GLEW_EXT_texture_compression_s3tc) {
+        throw std::runtime_error("Cannot bake the texture cache: S3TC compression is unsupported");
+    }
+
+    int written = 0;
+    for (const auto& [name, filename] : TEXTURE_MANIFEST) {
+        MappedFile source;
+        DecodedImage image{ INVALID_TEXTURE_HANDLE, name, filename, nullptr, 0, 0 };
+        if (source.open(filename)) {
+            decodeImage(image);
+        }
+        if (!image.pixels) {
+            std::cerr << "[TextureManager] Not baking '" << name << "': cannot read " << filename << std::endl;
+            continue;
+        }
+
+        // Let the driver compress and mip the image, then read every level back
+        GLuint textureID = 0;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, image.width, image.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+        stbi_image_free(image.pixels);
+
+        TextureCacheHeader header;
+        std::memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+        header.version = TEXTURE_CACHE_VERSION;
+        header.sourceHash = hashBytes(source.data(), source.size());
+        header.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        header.width = static_cast<std::uint32_t>(image.width);
+        header.height = static_cast<std::uint32_t>(image.height);
+        header.mipCount = 1;
+        while ((std::max(image.width, image.height) >> header.mipCount) > 0) {
+            ++header.mipCount;
+        }
+
+        std::vector<TextureCacheLevel> levels(header.mipCount);
+        std::vector<std::vector<unsigned char>> levelData(header.mipCount);
+        std::uint64_t offset = sizeof(TextureCacheHeader) + header.mipCount * sizeof(TextureCacheLevel);
+        for (std::uint32_t level = 0; level < header.mipCount; ++level) {
+            GLint compressedSize = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, static_cast<GLint>(level), GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+            levelData[level].resize(static_cast<size_t>(std::max(compressedSize, 0)));
+            glGetCompressedTexImage(GL_TEXTURE_2D, static_cast<GLint>(level), levelData[level].data());
+            levels[level] = { std::max(1u, header.width >> level), std::max(1u, header.height >> level),
+                              offset, levelData[level].size() };
+            offset += levelData[level].size();
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDeleteTextures(1, &textureID);
+        invalidateBindingCache();
+
+        const std::string cachePath = filename + std::string(TEXTURE_CACHE_EXTENSION);
+        std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(TextureCacheLevel));
+        for (const auto& data : levelData) {
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        }
+        if (!out) {
+            std::cerr << "[TextureManager] Failed to write texture cache " << cachePath << std::endl;
+            continue;
+        }
+
+        std::cout << "[TextureManager] Baked " << cachePath << " (" << header.mipCount << " levels, "
+                  << offset / 1024 << " KB)" << std::endl;
+        ++written;
+    }
+    return written;
+}
+
+void TextureManager::stopLoaderThreads() {
+    cancelLoading = true;
+    for (std::thread& thread : loaderThreads) {
+        thread.join();
+    }
+    loaderThreads.clear();
+    cancelLoading = false;
+
+    for (DecodedImage& image : decodedImages) {
+        if (image.pixels) {
+            stbi_image_free(image.pixels);
+        }
+    }
+    decodedImages.clear();
+    uploadsRemaining = 0;
+
+    // Declared arrays stay declared; the next load fills them from scratch
+    for (StreamedArray& array : streamedArrays) {
+        for (DecodedImage& image : array.images) {
+            if (image.pixels) {
+                stbi_image_free(image.pixels);
+            }
+            image = DecodedImage{ INVALID_TEXTURE_HANDLE, "", "", nullptr, 0, 0 };
+        }
+        array.arrived = 0;
+    }
+}
+
+void TextureManager::createFallbackTexture() {
+    // 8x8 checker shown while the real texture streams in
+    unsigned char pixels[8 * 8 * 4];
+    fillFallbackPixels(pixels, 8, 8);
+
+    glGenTextures(1, &fallbackTexture);
+    glBindTexture(GL_TEXTURE_2D, fallbackTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 8, 8, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    invalidateBindingCache();
+}
+
+GLuint TextureManager::getTexture(const std::string& name) const {
+    const TextureHandle handle = handles.find(name);
+    if (handle == INVALID_TEXTURE_HANDLE) {
+        std::cerr << "[TextureManager] Texture '" << name << "' not found." << std::endl;
+        throw std::out_of_range("Texture not found: " + name);
+    }
+    return slots[handle].id;
+}
+
+TextureHandle TextureManager::getHandle(const std::string& name) const {
+    return handles.find(name);
+}
+
+void TextureManager::bind(TextureHandle handle, GLenum textureUnit) {
+    const TextureSlot& slot = handle < slots.size() ? slots[handle] : slots[INVALID_TEXTURE_HANDLE];
+    const int unit = static_cast<int>(textureUnit - GL_TEXTURE0);
+    const int targetIndex = slot.target == GL_TEXTURE_2D_ARRAY ? 1 : 0;
+
+    if (unit < 0 || unit >= MAX_TEXTURE_UNITS) {
+        // Not tracked; always forward to GL
+        glActiveTexture(textureUnit);
+        glBindTexture(slot.target, slot.id);
+        activeUnit = textureUnit;
+        ++bindsIssued;
+        return;
+    }
+
+    if (boundTextures[unit][targetIndex] == slot.id) {
+        ++bindsAvoided;
+        return;
+    }
+
+    if (activeUnit != textureUnit) {
+        glActiveTexture(textureUnit);
+        activeUnit = textureUnit;
+    }
+    glBindTexture(slot.target, slot.id);
+    boundTextures[unit][targetIndex] = slot.id;
+    ++bindsIssued;
+}
+
+void TextureManager::bindTexture(const std::string& name, GLenum textureUnit) {
+    const TextureHandle handle = handles.find(name);
+    if (handle == INVALID_TEXTURE_HANDLE) {
+        std::cerr << "[TextureManager] Warning: Attempted to bind missing texture '" << name << "'. Bound default instead.\n";
+        bind(INVALID_TEXTURE_HANDLE, textureUnit);
+        return;
+    }
+    bind(handle, textureUnit);
+}
+
+void TextureManager::invalidateBindingCache() {
+    for (auto& unit : boundTextures) {
+        unit[0] = unit[1] = UNKNOWN_BINDING;
+    }
+    activeUnit = 0;
+}
+
+bool TextureManager::supportsTextureArrays() {
+    return GLEW_VERSION_3_0 || GLEW_EXT_texture_array;
+}
+
+GLuint TextureManager::loadTextureArray(const std::string& arrayName, const std::vector<std::string>& layerNames) {
+    TRACE_SCOPE("TextureManager::loadTextureArray");
+    if (!supportsTextureArrays()) {
+        throw std::runtime_error("Texture arrays are not supported by this driver");
+    }
+    if (isLoading()) {
+        throw std::runtime_error("Texture array '" + arrayName + "' declared while textures are already loading");
+    }
+    for (const std::string& name : layerNames) {
+        const bool streamed = std::any_of(std::begin(TEXTURE_MANIFEST), std::end(TEXTURE_MANIFEST),
+                                          [&name](const auto& entry) { return name == entry.first; });
+        if (!streamed) {
+            throw std::runtime_error("Texture array layer '" + name + "' is not a streamed texture");
+        }
+    }
+
+    // Placeholder of checker layers so the array can be bound before its images arrive.
+    // One extra layer after the images holds the fallback checker for names that are not packed.
+    const GLsizei layerCount = static_cast<GLsizei>(layerNames.size() + 1);
+    std::vector<unsigned char> pixels(static_cast<size_t>(8 * 8 * 4) * layerCount);
+    for (GLsizei layer = 0; layer < layerCount; ++layer) {
+        fillFallbackPixels(&pixels[static_cast<size_t>(layer) * 8 * 8 * 4], 8, 8);
+    }
+    GLuint arrayID = 0;
+    glGenTextures(1, &arrayID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 8, 8, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    invalidateBindingCache();
+    registerTexture(arrayName, arrayID, GL_TEXTURE_2D_ARRAY);
+
+    for (size_t layer = 0; layer < layerNames.size(); ++layer) {
+        layers[layerNames[layer]] = static_cast<int>(layer);
+    }
+    fallbackLayer = static_cast<int>(layerNames.size());
+
+    streamedArrays.erase(std::remove_if(streamedArrays.begin(), streamedArrays.end(),
+                                        [&arrayName](const StreamedArray& array) { return array.name == arrayName; }),
+                         streamedArrays.end());
+    streamedArrays.push_back({ arrayName, layerNames,
+                               std::vector<DecodedImage>(layerNames.size(), { INVALID_TEXTURE_HANDLE, "", "", nullptr, 0, 0 }),
+                               0 });
+    return arrayID;
+}
+
+bool TextureManager::takeArrayLayer(const DecodedImage& image) {
+    for (StreamedArray& array : streamedArrays) {
+        auto it = std::find(array.layerNames.begin(), array.layerNames.end(), image.name);
+        if (it == array.layerNames.end()) continue;
+
+        array.images[it - array.layerNames.begin()] = image;
+        if (++array.arrived == array.layerNames.size()) {
+            buildTextureArray(array);
+        }
+        return true;
+    }
+    return false;
+}
+
+// GL thread only. Allocates the array once at its final size, uploads every layer and frees
+// the pixels; the placeholder from loadTextureArray() is deleted when the new array replaces it.
+void TextureManager::buildTextureArray(StreamedArray& array) {
+    TRACE_SCOPE("TextureManager::buildTextureArray");
+    // DXT5 and RGBA8 layers cannot share an array, so the baked caches are used only when
+    // every layer that loaded has one
+    bool anyCached = false, anyDecoded = false;
+    for (const DecodedImage& image : array.images) {
+        anyCached = anyCached || image.cache;
+        anyDecoded = anyDecoded || image.pixels;
+    }
+    const bool compressed = anyCached && !anyDecoded;
+
+    int width = 0, height = 0;
+    std::uint32_t mipCount = 1;
+    std::vector<bool> usable(array.images.size(), false);
+    int usableCount = 0;
+    for (size_t layer = 0; layer < array.images.size(); ++layer) {
+        DecodedImage& image = array.images[layer];
+        if (!compressed && image.cache && !image.pixels) {
+            std::cout << "[TextureManager] Decoding array layer '" << image.name << "' on the GL thread: other layers"
+                      << " of '" << array.name << "' have no current cache (rerun with --bake-textures)" << std::endl;
+            decodeImage(image);
+        }
+        if (compressed ? !image.cache : !image.pixels) {
+            std::cerr << "[TextureManager] Skipping array layer '" << image.name << "' from " << image.filename
+                      << ": " << image.error << std::endl;
+            continue;
+        }
+        std::uint32_t layerMips = 1;
+        if (compressed) {
+            TextureCacheHeader header;
+            std::memcpy(&header, image.cache->data(), sizeof(header));
+            layerMips = header.mipCount;
+        }
+        if (usableCount == 0) {
+            width = image.width;
+            height = image.height;
+            mipCount = layerMips;
+        } else if (image.width != width || image.height != height || layerMips != mipCount) {
+            std::cerr << "[TextureManager] Skipping array layer '" << image.name << "': " << image.width << "x"
+                      << image.height << " (" << layerMips << " levels) does not match " << width << "x" << height
+                      << " (" << mipCount << " levels)" << std::endl;
+            continue;
+        }
+        usable[layer] = true;
+        ++usableCount;
+    }
+
+    if (usableCount == 0) {
+        std::cerr << "[TextureManager] No layer of texture array '" << array.name
+                  << "' loaded; it keeps the fallback checker" << std::endl;
+        return;
+    }
+
+    // Layers never bleed into each other, so mipmaps need no padding or border handling.
+    // Layers that were skipped get the checker, like the last one.
+    const GLsizei layerCount = static_cast<GLsizei>(array.images.size() + 1);
+    GLuint arrayID = 0;
+    glGenTextures(1, &arrayID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+    if (compressed) {
+        // Every level straight from the validated mappings, as uploadCached() does for 2D textures
+        std::vector<unsigned char> fallbackBlocks;
+        for (std::uint32_t level = 0; level < mipCount; ++level) {
+            const GLsizei levelWidth = std::max(1, width >> level);
+            const GLsizei levelHeight = std::max(1, height >> level);
+            const GLsizei levelBytes = ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * 16;
+            fallbackBlocks.resize(static_cast<size_t>(levelBytes));
+            fillFallbackBlocks(fallbackBlocks.data(), levelWidth, levelHeight);
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                                   levelWidth, levelHeight, layerCount, 0, levelBytes * layerCount, nullptr);
+            for (GLsizei layer = 0; layer < layerCount; ++layer) {
+                const unsigned char* data = fallbackBlocks.data();
+                if (layer < static_cast<GLsizei>(usable.size()) && usable[layer]) {
+                    const unsigned char* base = array.images[layer].cache->data();
+                    TextureCacheLevel entry;
+                    std::memcpy(&entry, base + sizeof(TextureCacheHeader) + level * sizeof(TextureCacheLevel), sizeof(entry));
+                    data = base + entry.offset; // entry.size == levelBytes, checked by openCachedImage()
+                }
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, layer,
+                                          levelWidth, levelHeight, 1, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, levelBytes, data);
+            }
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(mipCount - 1));
+    } else {
+        // Uncompressed for the same reason as uploadDecoded(): an S3TC internal format would
+        // make the driver compress every layer and level on this thread
+        std::vector<unsigned char> fallbackPixels(static_cast<size_t>(width) * height * 4);
+        fillFallbackPixels(fallbackPixels.data(), width, height);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (GLsizei layer = 0; layer < layerCount; ++layer) {
+            const bool packed = layer < static_cast<GLsizei>(usable.size()) && usable[layer];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                            packed ? array.images[layer].pixels : fallbackPixels.data());
+        }
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    invalidateBindingCache();
+
+    for (DecodedImage& image : array.images) {
+        if (image.pixels) {
+            stbi_image_free(image.pixels);
+            image.pixels = nullptr;
+        }
+        image.cache.reset();
+    }
+
+    registerTexture(array.name, arrayID, GL_TEXTURE_2D_ARRAY);
+    std::cout << "[TextureManager] Loaded texture array '" << array.name << "' (ID: " << arrayID << ", "
+              << usableCount << " of " << array.images.size() << " layers of " << width << "x" << height << ")"
+              << (compressed ? " from the texture cache" : "") << std::endl;
+}
+
+int TextureManager::getLayer(const std::string& name) const {
+    auto it = layers.find(name);
+    return it != layers.end() ? it->second : -1;
+}
+
+void TextureManager::releaseAllTextures() {
+    stopLoaderThreads();
+    for (size_t handle = 1; handle < slots.size(); ++handle) {
+        if (slots[handle].id != fallbackTexture) {
+            glDeleteTextures(1, &slots[handle].id);
+        }
+    }
+    if (fallbackTexture != 0) {
+        glDeleteTextures(1, &fallbackTexture);
+        fallbackTexture = 0;
+    }
+    if (uploadBuffer != 0) {
+        glDeleteBuffers(1, &uploadBuffer);
+        uploadBuffer = 0;
+    }
+    slots.resize(1); // Keep INVALID_TEXTURE_HANDLE
+    handles.clear();
+    layers.clear();
+    streamedArrays.clear();
+    fallbackLayer = -1;
+    invalidateBindingCache();
+    std::cout << "[TextureManager] Released all textures." << std::endl;
+}
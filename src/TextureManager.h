@@ -1,33 +1,178 @@
-#pragma once
-
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-#include <SOIL/SOIL.h>
-#include <string>
-#include <unordered_map>
-#include <stdexcept>
-#include <iostream>
-
-// TextureManager handles loading, storing, and binding OpenGL textures by name
-class TextureManager {
-public:
-    TextureManager();
-    ~TextureManager();
-
-    // Loads a texture from a file and stores its OpenGL ID under a given name
-    // Throws std::runtime_error if loading fails
-    GLuint loadTexture(const std::string& name, const std::string& filename);
-
-    // Retrieves the OpenGL texture ID by name
-    // Throws std::out_of_range if the name is not found
-    GLuint getTexture(const std::string& name) const;
-
-    // Binds a texture by name to a specific texture unit (default is GL_TEXTURE0)
-    void bindTexture(const std::string& name, GLenum textureUnit = GL_TEXTURE0) const;
-
-    // Deletes all loaded textures and clears internal map
-    void releaseAllTextures();
-
-private:
-    std::unordered_map<std::string, GLuint> textures;
-};
+#pragma once
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <SOIL/SOIL.h>
+#include "MappedFile.h"
+#include "TextureNames.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+
+// TextureManager handles loading, storing, and binding OpenGL textures by name
+class TextureManager {
+public:
+    TextureManager();
+    ~TextureManager();
+
+    // Loads a texture from a file and stores its OpenGL ID under a given name
+    // Throws std::runtime_error if loading fails
+    GLuint loadTexture(const std::string& name, const std::string& filename);
+
+    // Loads every texture listed in Config.h under its short name ("wall", "floor", ...)
+    // Keeps going past individual failures, then throws std::runtime_error listing them
+    void loadAll();
+
+    // Starts decoding the Config.h textures on worker threads (0 = one per hardware thread).
+    // Every name gets its handle right away, bound to a fallback texture until its upload lands.
+    void beginLoadAll(unsigned threadCount = 0);
+
+    // Uploads decoded images on the GL thread until budgetMs is spent.
+    // Returns true once nothing is left in flight; failures are logged at that point.
+    bool pumpUploads(double budgetMs);
+
+    // Blocks until every queued texture is uploaded
+    // Throws std::runtime_error listing the files that failed
+    void finishLoading();
+
+    bool isLoading() const { return !loaderThreads.empty() || uploadsRemaining > 0; }
+
+    // Writes a GPU-ready cache file (TEXTURE_CACHE_EXTENSION) next to every Config.h texture:
+    // the full DXT5 mip chain read back from the driver, tagged with a hash of the source file.
+    // beginLoadAll() uploads straight from a memory-mapped cache whose hash still matches.
+    // Needs a GL context; throws std::runtime_error if S3TC compression is unavailable.
+    // Returns the number of cache files written.
+    int bakeTextureCache();
+
+    // Retrieves the OpenGL texture ID by name
+    // Throws std::out_of_range if the name is not found
+    GLuint getTexture(const std::string& name) const;
+
+    // Resolves a texture or texture array name to its handle (INVALID_TEXTURE_HANDLE if not loaded).
+    // Handles stay valid until releaseAllTextures(); reloading a name keeps its handle.
+    TextureHandle getHandle(const std::string& name) const;
+
+    // Fast path: binds by handle, skipping the GL calls if that texture is already bound on the unit
+    void bind(TextureHandle handle, GLenum textureUnit = GL_TEXTURE0);
+
+    // Slow path for tools and debugging: looks the name up on every call and binds texture 0
+    // with a warning if it is missing
+    void bindTexture(const std::string& name, GLenum textureUnit = GL_TEXTURE0);
+
+    // Forget the cached binding state; call after binding textures without going through bind()
+    void invalidateBindingCache();
+
+    // Bind calls that reached GL vs. those skipped as redundant since the last reset
+    unsigned long getBindsIssued() const { return bindsIssued; }
+    unsigned long getBindsAvoided() const { return bindsAvoided; }
+    void resetBindCounters() { bindsIssued = bindsAvoided = 0; }
+
+    // True if the driver supports GL_TEXTURE_2D_ARRAY (GL 3.0 or EXT_texture_array)
+    static bool supportsTextureArrays();
+
+    // Declares a GL_TEXTURE_2D_ARRAY stored under arrayName whose layers are streamed textures
+    // (Config.h names such as "wall"). Layer numbers are assigned right away (see getLayer), and
+    // the array is filled from the images beginLoadAll() decodes once the last of them arrives;
+    // until then every layer shows the fallback checker. Images that fail to load or differ in
+    // size from the first one keep the checker, as does a last layer for names that are not
+    // packed at all (see getFallbackLayer).
+    // Call before beginLoadAll(). Throws std::runtime_error if arrays are unsupported, a name
+    // is not a streamed texture, or textures are already loading.
+    GLuint loadTextureArray(const std::string& arrayName, const std::vector<std::string>& layerNames);
+
+    // Layer of a texture packed into an array, or -1 if it was not packed
+    int getLayer(const std::string& name) const;
+
+    // Fallback checker layer of the last array loaded, or -1 if no array was loaded
+    int getFallbackLayer() const { return fallbackLayer; }
+
+    // Deletes all loaded textures and clears internal map
+    void releaseAllTextures();
+
+private:
+    // GL object behind a handle
+    struct TextureSlot {
+        GLuint id;
+        GLenum target; // GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+    };
+
+    TextureNames handles;                                   // Name -> handle, resolved at load time
+    std::vector<TextureSlot> slots;                         // Handle -> GL object; slot 0 is the invalid handle
+    std::unordered_map<std::string, int> layers;            // Texture name -> layer in its array
+    int fallbackLayer;
+
+    // Shadow of the GL texture bindings so redundant binds can be skipped
+    static const int MAX_TEXTURE_UNITS = 8;
+    static const GLuint UNKNOWN_BINDING = ~0u;
+    GLuint boundTextures[MAX_TEXTURE_UNITS][2]; // [unit][0 = 2D, 1 = 2D array]
+    GLenum activeUnit;                          // 0 when unknown
+    unsigned long bindsIssued;
+    unsigned long bindsAvoided;
+
+    // Stores id under name, reusing (and freeing the old texture of) an existing handle
+    TextureHandle registerTexture(const std::string& name, GLuint id, GLenum target);
+
+    // Image prepared off the GL thread: either a validated cache mapping or RGBA8 pixels
+    // with rows already flipped like SOIL_FLAG_INVERT_Y
+    struct DecodedImage {
+        TextureHandle handle;
+        std::string name;
+        std::string filename;
+        unsigned char* pixels; // From stbi_load; nullptr if decoding failed or the cache is used
+        int width;
+        int height;
+        std::shared_ptr<MappedFile> cache = nullptr; // Set when the baked cache matches the source
+        std::string error = "";                       // stb_image's reason when decoding failed
+    };
+
+    static void decodeImage(DecodedImage& image);
+    static bool openCachedImage(DecodedImage& image);
+    void uploadDecoded(const DecodedImage& image);
+    GLuint uploadCached(const DecodedImage& image);
+    void stopLoaderThreads();
+
+    // Texture array filled from the streamed images named by its layers
+    struct StreamedArray {
+        std::string name;
+        std::vector<std::string> layerNames;
+        std::vector<DecodedImage> images; // Per layer; pixels are owned here once taken
+        size_t arrived;
+    };
+    std::vector<StreamedArray> streamedArrays;
+
+    // Keeps image for the array that has it as a layer, building the array once every layer
+    // has arrived: from the baked DXT5 caches when every layer has one, from pixels otherwise.
+    // Returns false (leaving the pixels to the caller) if no array wants it.
+    bool takeArrayLayer(const DecodedImage& image);
+    void buildTextureArray(StreamedArray& array);
+
+    // Shown through every handle whose real texture has not arrived yet
+    GLuint fallbackTexture;
+    void createFallbackTexture();
+
+    // Asynchronous loading state, shared with the decoder threads under loaderMutex
+    std::vector<DecodedImage> loadQueue;   // Written before the threads start, read-only after
+    std::atomic<size_t> nextToDecode;
+    std::atomic<bool> cancelLoading;
+    std::vector<std::thread> loaderThreads;
+    std::mutex loaderMutex;
+    std::condition_variable decodedReady;
+    std::deque<DecodedImage> decodedImages; // Waiting for upload on the GL thread
+    size_t uploadsRemaining;                 // GL thread only
+    std::string failedFiles;
+    std::chrono::steady_clock::time_point loadStartTime;
+
+    // Staging buffer for GL_PIXEL_UNPACK_BUFFER uploads (0 if PBOs are unsupported)
+    GLuint uploadBuffer;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Compact integer name for a loaded texture or texture array.
+// Resolve once with TextureManager::getHandle() and keep it; binding by handle does no hashing.
+typedef std::uint32_t TextureHandle;
+const TextureHandle INVALID_TEXTURE_HANDLE = 0; // Binds texture 0
+
+// Name -> handle table behind TextureManager's by-name calls. Needs no GL, so the bench can
+// time the lookups without a context.
+class TextureNames {
+public:
+    // Handle registered under name, or INVALID_TEXTURE_HANDLE
+    TextureHandle find(const std::string& name) const {
+        auto it = handles.find(name);
+        return it != handles.end() ? it->second : INVALID_TEXTURE_HANDLE;
+    }
+
+    void add(const std::string& name, TextureHandle handle) { handles[name] = handle; }
+    void clear() { handles.clear(); }
+
+private:
+    std::unordered_map<std::string, TextureHandle> handles;
+};
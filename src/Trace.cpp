@@ -0,0 +1,191 @@
+#include "Trace.h"
+#include "Config.h" // For TRACE_RING_EVENTS
+#include <iostream>
+
+#ifdef AIHH_ENABLE_TRACING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "TRACE_RING_EVENTS must be a power of two");
+
+    // Fields are atomics so a flush may read a slot while its owner overwrites it; a torn
+    // read is detected through the ring head and dropped
+    struct Event {
+        std::atomic<const char*> name;
+        std::atomic<long long> startNs;
+        std::atomic<long long> durationNs;
+    };
+
+    // Written only by its own thread. head counts every event ever recorded; the slot of
+    // event i is i % TRACE_RING_EVENTS.
+    struct ThreadBuffer {
+        int id;
+        std::string name; // Guarded by registryMutex
+        std::atomic<std::uint64_t> head{ 0 };
+        std::unique_ptr<Event[]> events{ new Event[TRACE_RING_EVENTS] };
+    };
+
+    // An event as copied out of a ring
+    struct Recorded {
+        const char* name;
+        long long startNs;
+        long long durationNs;
+    };
+
+    std::mutex registryMutex;
+    // Never freed: threads still running during static destruction may record
+    std::vector<ThreadBuffer*>* buffers = new std::vector<ThreadBuffer*>();
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+
+    long long nowNs() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    ThreadBuffer& currentBuffer() {
+        if (!threadBuffer) {
+            // Once per thread; later events touch only the thread's own ring
+            ThreadBuffer* buffer = new ThreadBuffer();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->id = static_cast<int>(buffers->size()) + 1;
+            buffer->name = "Thread " + std::to_string(buffer->id);
+            buffers->push_back(buffer);
+            threadBuffer = buffer;
+        }
+        return *threadBuffer;
+    }
+
+    void record(const char* name, long long startNs, long long durationNs) {
+        ThreadBuffer& buffer = currentBuffer();
+        const std::uint64_t index = buffer.head.load(std::memory_order_relaxed);
+        // Orders the head published for this slot's previous event before the overwrite, so a
+        // flush that reads the new data also sees a head that marks the slot as reused
+        std::atomic_thread_fence(std::memory_order_release);
+        Event& event = buffer.events[index & (TRACE_RING_EVENTS - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.startNs.store(startNs, std::memory_order_relaxed);
+        event.durationNs.store(durationNs, std::memory_order_relaxed);
+        buffer.head.store(index + 1, std::memory_order_release);
+    }
+
+    // Copy the events of one ring that were not overwritten during the copy
+    void copyEvents(const ThreadBuffer& buffer, std::vector<Recorded>& out) {
+        const std::uint64_t ring = TRACE_RING_EVENTS;
+        const std::uint64_t end = buffer.head.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > ring ? end - ring : 0;
+        const size_t first = out.size();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            const Event& event = buffer.events[i & (ring - 1)];
+            out.push_back({ event.name.load(std::memory_order_relaxed), event.startNs.load(std::memory_order_relaxed),
+                            event.durationNs.load(std::memory_order_relaxed) });
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The owner may be writing event `after` right now, which reuses the slot of after - ring
+        const std::uint64_t after = buffer.head.load(std::memory_order_relaxed);
+        const std::uint64_t valid = after >= ring ? after - ring + 1 : 0;
+        if (valid > begin) {
+            const size_t dropped = static_cast<size_t>(std::min(valid, end) - begin);
+            out.erase(out.begin() + first, out.begin() + first + dropped);
+        }
+    }
+
+    void writeJsonString(std::ostream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+Trace::Scope::Scope(const char* name) : name(name), startNs(nowNs()) {}
+
+Trace::Scope::~Scope() {
+    record(name, startNs, nowNs() - startNs);
+}
+
+void Trace::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = currentBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer.name = name;
+}
+
+bool Trace::writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "[Trace] Cannot write " << path << std::endl;
+        return false;
+    }
+
+    // Copy under the registry lock (threads keep recording; only registration waits), then
+    // format without it
+    std::vector<std::pair<int, std::string>> threads;
+    std::vector<std::vector<Recorded>> events;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads.reserve(buffers->size());
+        events.resize(buffers->size());
+        for (size_t t = 0; t < buffers->size(); ++t) {
+            threads.emplace_back((*buffers)[t]->id, (*buffers)[t]->name);
+            copyEvents(*(*buffers)[t], events[t]);
+        }
+    }
+
+    // Timestamps are microseconds; "X" events carry their own duration so scopes need no pairing
+    size_t eventCount = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed;
+    out.precision(3);
+    bool first = true;
+    for (size_t t = 0; t < threads.size(); ++t) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threads[t].first
+            << ",\"args\":{\"name\":";
+        writeJsonString(out, threads[t].second.c_str());
+        out << "}}";
+        first = false;
+        for (const Recorded& event : events[t]) {
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threads[t].first << ",\"ts\":" << event.startNs / 1000.0
+                << ",\"dur\":" << event.durationNs / 1000.0 << '}';
+        }
+        eventCount += events[t].size();
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cerr << "[Trace] Failed while writing " << path << std::endl;
+        return false;
+    }
+    std::cout << "[Trace] Wrote " << eventCount << " events from " << threads.size() << " threads to " << path
+              << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+    return true;
+}
+
+bool Trace::isEnabled() {
+    return true;
+}
+
+#else
+
+void Trace::setThreadName(const std::string&) {}
+
+bool Trace::writeChromeJson(const std::string& path) {
+    std::cerr << "[Trace] Not written to " << path << ": tracing is compiled out (configure with -DAIHH_ENABLE_TRACING=ON)" << std::endl;
+    return false;
+}
+
+bool Trace::isEnabled() {
+    return false;
+}
+
+#endif
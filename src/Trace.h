@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+// Scoped trace events for chrome://tracing and Perfetto. Build with AIHH_ENABLE_TRACING
+// (the CMake option of the same name) to record them; otherwise every macro below expands to
+// nothing and no call, clock read or buffer remains.
+//
+// Each thread records into its own fixed ring of TRACE_RING_EVENTS events, so recording never
+// locks or allocates after the thread's first event, and only the newest events are kept.
+// writeChromeJson() may run on any thread while the others keep recording; events overwritten
+// during the copy are dropped rather than written torn.
+//
+//     void Renderer::drawMaze() {
+//         TRACE_SCOPE("Renderer::drawMaze");
+//         ...
+//
+// Names must be string literals (or otherwise outlive the trace): only the pointer is stored.
+namespace Trace {
+    // Time one scope; use TRACE_SCOPE rather than naming one directly
+    class Scope {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const char* name;
+        long long startNs;
+    };
+
+    // Label the calling thread in the trace viewer
+    void setThreadName(const std::string& name);
+
+    // Write every buffered event as Chrome trace JSON ("X" events plus thread names).
+    // Returns false if the file cannot be written or tracing was compiled out.
+    bool writeChromeJson(const std::string& path);
+
+    // True if this build records events
+    bool isEnabled();
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef AIHH_ENABLE_TRACING
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif